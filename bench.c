@@ -0,0 +1,414 @@
+#include "bench.h"
+
+/**
+ * Microbenchmarks of the primitives of libs and libs_optimized over a sweep of sizes.
+ * The matrix kernels run on every backend of matrix_backend.h (reference, packed32, packed64
+ * and simd) on the same matrices, the polynomial kernels compare polynome with the packed
+ * ring and hybrid_polynome. Each kernel times its primitive only : the inputs are built once
+ * per size and the results are freed outside of the timing. The results are written in CSV,
+ * one line per kernel, backend and size, so that two runs can be compared line by line.
+ */
+
+// Backends timed by the matrix kernels, in the order of the CSV
+static const char *bench_backend_names[NB_BENCH_BACKENDS] = {"reference", "packed32", "packed64", "simd"};
+
+static uint64_t elapsed_since(uint64_t start)
+{
+    return monotonic_ns() - start;
+}
+
+/**
+ * Invertible dense matrix : the identity mixed by random row additions.
+ * Inverting a random matrix would stop early on the singular ones (about 70 % of them).
+ */
+static backend_matrix invertible_matrix(drbg *generator, const matrix_backend *backend, unsigned int size)
+{
+    backend_matrix matrix = create_backend_identity_matrix(backend, size);
+    for (unsigned int k = 0; k < 4 * size; k++)
+    {
+        unsigned int i = uniform_drbg(generator, size), j = uniform_drbg(generator, size);
+        if (i != j)
+            backend->add_row(matrix.rows[i], matrix.rows[j], size);
+    }
+    return matrix;
+}
+
+/**
+ * Build the inputs of every kernel at one size.
+ * The matrices are drawn once on packed64 and converted to each backend.
+ *
+ * @param size rows and columns of the matrices
+ * @param seed seed of the generator
+ * @return the inputs, to free with free_bench_input
+ */
+bench_input init_bench_input(unsigned int size, unsigned int seed)
+{
+    bench_input input;
+    input.size = size;
+    input.generator = init_drbg(seed, size);
+    const matrix_backend *packed64 = find_matrix_backend("packed64");
+    backend_matrix matrix1 = invertible_matrix(&input.generator, packed64, size);
+    backend_matrix matrix2 = init_backend_matrix(packed64, size, size);
+    randomize_backend_matrix(&input.generator, matrix2);
+    for (unsigned int b = 0; b < NB_BENCH_BACKENDS; b++)
+    {
+        const matrix_backend *backend = find_matrix_backend(bench_backend_names[b]);
+        input.matrices[b].backend = backend;
+        input.matrices[b].matrix1 = convert_backend_matrix(matrix1, backend);
+        input.matrices[b].matrix2 = convert_backend_matrix(matrix2, backend);
+        input.matrices[b].scratch = init_backend_matrix(backend, size, size);
+    }
+    input.columns = (int *)malloc(sizeof(int) * size);
+
+    bit **sparse = init_matrix(size, size);
+    unsigned int row_weight = size / BENCH_SPARSE_RATIO + 1;
+    target_weight_matrix(&input.generator, sparse, size, size, size * row_weight);
+    input.polynomial1 = init_polynomial_matrix(sparse, size, size);
+    input.hybrid1 = init_hybrid_polynomial_matrix(sparse, size, size);
+    target_weight_matrix(&input.generator, sparse, size, size, size * row_weight);
+    input.polynomial2 = init_polynomial_matrix(sparse, size, size);
+    input.hybrid2 = init_hybrid_polynomial_matrix(sparse, size, size);
+    free_matrix(sparse, size);
+
+    // Row 0 is the first row of matrix1, row 1 is overwritten by the kernels
+    input.lines = init_matrix(2, size);
+    input.ring = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(size));
+    input.ring_scratch = (uint64_t *)calloc(NB_WORDS(size), sizeof(uint64_t));
+    pack_backend_row(matrix1, 0, input.ring);
+    unpack_backend_row(bits_backend_matrix(input.lines, 2, size), 0, input.ring);
+    free_backend_matrix(matrix1);
+    free_backend_matrix(matrix2);
+    return input;
+}
+
+void free_bench_input(bench_input input)
+{
+    for (unsigned int b = 0; b < NB_BENCH_BACKENDS; b++)
+    {
+        free_backend_matrix(input.matrices[b].matrix1);
+        free_backend_matrix(input.matrices[b].matrix2);
+        free_backend_matrix(input.matrices[b].scratch);
+    }
+    free(input.columns);
+    free_matrix(input.lines, 2);
+    free_polynomial_matrix(input.polynomial1, input.size);
+    free_polynomial_matrix(input.polynomial2, input.size);
+    free_hybrid_polynomial_matrix(input.hybrid1, input.size);
+    free_hybrid_polynomial_matrix(input.hybrid2, input.size);
+    free(input.ring);
+    free(input.ring_scratch);
+}
+
+// Matrix kernels : each one times its primitive on the matrices of one backend and frees the result afterwards
+
+static uint64_t bench_init(bench_input *input, bench_matrices *matrices)
+{
+    uint64_t start = monotonic_ns();
+    backend_matrix matrix = init_backend_matrix(matrices->backend, input->size, input->size);
+    uint64_t duration = elapsed_since(start);
+    free_backend_matrix(matrix);
+    return duration;
+}
+
+static uint64_t bench_transpose(bench_input *input, bench_matrices *matrices)
+{
+    (void)input;
+    uint64_t start = monotonic_ns();
+    backend_matrix transposed = transpose_backend_matrix(matrices->matrix2);
+    uint64_t duration = elapsed_since(start);
+    free_backend_matrix(transposed);
+    return duration;
+}
+
+static uint64_t bench_multiply(bench_input *input, bench_matrices *matrices)
+{
+    (void)input;
+    uint64_t start = monotonic_ns();
+    backend_matrix product = multiply_backend_matrix(matrices->matrix1, matrices->matrix2);
+    uint64_t duration = elapsed_since(start);
+    free_backend_matrix(product);
+    return duration;
+}
+
+static uint64_t bench_invert(bench_input *input, bench_matrices *matrices)
+{
+    (void)input;
+    int is_invertible;
+    uint64_t start = monotonic_ns();
+    backend_matrix inverse = inversion_backend_matrix(matrices->matrix1, &is_invertible);
+    uint64_t duration = elapsed_since(start);
+    assert(is_invertible);
+    free_backend_matrix(inverse);
+    return duration;
+}
+
+static uint64_t bench_weight(bench_input *input, bench_matrices *matrices)
+{
+    (void)input;
+    uint64_t start = monotonic_ns();
+    volatile unsigned int weight = backend_hamming_weight(matrices->matrix2);
+    (void)weight;
+    return elapsed_since(start);
+}
+
+// Sample one error of weight size in the whole matrix, the clearing is part of the sampling
+
+static uint64_t bench_sample(bench_input *input, bench_matrices *matrices)
+{
+    uint64_t start = monotonic_ns();
+    target_weight_backend_matrix(&input->generator, matrices->scratch, input->size);
+    return elapsed_since(start);
+}
+
+static uint64_t bench_sample_columns(bench_input *input, bench_matrices *matrices)
+{
+    uint64_t start = monotonic_ns();
+    backend_matrix sample = sample_backend_columns(&input->generator, matrices->matrix2, input->size / 2, input->columns);
+    uint64_t duration = elapsed_since(start);
+    free_backend_matrix(sample);
+    return duration;
+}
+
+static uint64_t bench_rotate(bench_input *input, bench_matrices *matrices)
+{
+    (void)input;
+    uint64_t start = monotonic_ns();
+    backend_matrix rotated = rotation_backend_matrix(matrices->matrix2, 1, RIGHT);
+    uint64_t duration = elapsed_since(start);
+    free_backend_matrix(rotated);
+    return duration;
+}
+
+// Polynomial kernels, on their own representation
+
+// Cyclic shift of one row by size / 3, a product by a monomial on the packed ring
+
+static uint64_t bench_shift_line(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    uint64_t start = monotonic_ns();
+    shift_line(input->lines[1], input->lines[0], input->size, input->size / 3);
+    return elapsed_since(start);
+}
+
+static uint64_t bench_shift_ring(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    int monomial = input->size / 3;
+    polynome shift = {&monomial, 1};
+    uint64_t start = monotonic_ns();
+    multiply_sparse_ring(input->ring, shift, input->size, input->ring_scratch);
+    return elapsed_since(start);
+}
+
+static uint64_t bench_polynomial_add(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    uint64_t start = monotonic_ns();
+    polynome *sum = add_polymonial_matrix(input->polynomial1, input->polynomial2, input->size, input->size, 0);
+    uint64_t duration = elapsed_since(start);
+    free_polynomial_matrix(sum, input->size);
+    return duration;
+}
+
+static uint64_t bench_hybrid_add(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    uint64_t start = monotonic_ns();
+    hybrid_polynome *sum = add_hybrid_polynomial_matrix(input->hybrid1, input->hybrid2, input->size);
+    uint64_t duration = elapsed_since(start);
+    free_hybrid_polynomial_matrix(sum, input->size);
+    return duration;
+}
+
+static uint64_t bench_polynomial_multiply(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    uint64_t start = monotonic_ns();
+    polynome *product = multiplication_polynomial_matrix(input->polynomial1, input->polynomial2, input->size, input->size);
+    uint64_t duration = elapsed_since(start);
+    free_polynomial_matrix(product, input->size);
+    return duration;
+}
+
+static uint64_t bench_hybrid_multiply(bench_input *input, bench_matrices *matrices)
+{
+    (void)matrices;
+    uint64_t start = monotonic_ns();
+    hybrid_polynome *product = multiplication_hybrid_polynomial_matrix(input->hybrid1, input->hybrid2, input->size, input->size);
+    uint64_t duration = elapsed_since(start);
+    free_hybrid_polynomial_matrix(product, input->size);
+    return duration;
+}
+
+// Bits of one operand : the throughputs of two backends compare, not those of two kernels
+
+static uint64_t matrix_bits(unsigned int size)
+{
+    return (uint64_t)size * size;
+}
+
+static uint64_t line_bits(unsigned int size)
+{
+    return size;
+}
+
+// Matrix kernels first, run on every backend, then the polynomial kernels on their representation
+static const bench_kernel kernels[] = {
+    {"init", NULL, bench_init, matrix_bits},
+    {"transpose", NULL, bench_transpose, matrix_bits},
+    {"multiply", NULL, bench_multiply, matrix_bits},
+    {"invert", NULL, bench_invert, matrix_bits},
+    {"weight", NULL, bench_weight, matrix_bits},
+    {"sample", NULL, bench_sample, matrix_bits},
+    {"sample_columns", NULL, bench_sample_columns, matrix_bits},
+    {"rotate", NULL, bench_rotate, matrix_bits},
+    {"shift", "line", bench_shift_line, line_bits},
+    {"shift", "ring", bench_shift_ring, line_bits},
+    {"polynomial_add", "polynome", bench_polynomial_add, matrix_bits},
+    {"polynomial_add", "hybrid", bench_hybrid_add, matrix_bits},
+    {"polynomial_multiply", "polynome", bench_polynomial_multiply, matrix_bits},
+    {"polynomial_multiply", "hybrid", bench_hybrid_multiply, matrix_bits},
+};
+
+static int compare_durations(const void *a, const void *b)
+{
+    uint64_t duration1 = *(const uint64_t *)a, duration2 = *(const uint64_t *)b;
+    return (duration1 > duration2) - (duration1 < duration2);
+}
+
+/**
+ * Time a kernel : nb_warmups untimed runs, then nb_repetitions timed runs.
+ *
+ * @param kernel kernel to time
+ * @param input inputs at the size measured
+ * @param matrices matrices of the backend timed, ignored by the polynomial kernels
+ * @param parameters parameters of the run
+ * @return the median, 99th percentile and extremes of the durations
+ */
+bench_result run_kernel(bench_kernel kernel, bench_input *input, bench_matrices *matrices, bench_parameters parameters)
+{
+    for (unsigned int i = 0; i < parameters.nb_warmups; i++)
+        kernel.run(input, matrices);
+
+    uint64_t *durations = (uint64_t *)malloc(sizeof(uint64_t) * parameters.nb_repetitions);
+    for (unsigned int i = 0; i < parameters.nb_repetitions; i++)
+        durations[i] = kernel.run(input, matrices);
+    qsort(durations, parameters.nb_repetitions, sizeof(uint64_t), compare_durations);
+
+    bench_result result;
+    unsigned int last = parameters.nb_repetitions - 1;
+    unsigned int rank_p99 = (unsigned int)ceil(0.99 * parameters.nb_repetitions) - 1;
+    result.median = durations[last / 2];
+    result.p99 = durations[rank_p99 < last ? rank_p99 : last];
+    result.min = durations[0];
+    result.max = durations[last];
+    free(durations);
+    return result;
+}
+
+void write_bench_header(FILE *output)
+{
+    fprintf(output, "kernel,backend,size,repetitions,median_ns,p99_ns,min_ns,max_ns,bits,bits_per_second\n");
+}
+
+/**
+ * Write one CSV line, the throughput is computed from the median.
+ *
+ * @param output file to write in
+ * @param name name of the kernel timed
+ * @param backend matrix backend or polynomial representation timed
+ * @param size size of its inputs
+ * @param nb_bits bits processed by one run
+ * @param parameters parameters of the run
+ * @param result durations of the kernel
+ */
+void write_bench_result(FILE *output, const char *name, const char *backend, unsigned int size, uint64_t nb_bits, bench_parameters parameters, bench_result result)
+{
+    double bits_per_second = result.median > 0 ? nb_bits * 1e9 / result.median : 0;
+    fprintf(output, "%s,%s,%u,%u,%lu,%lu,%lu,%lu,%lu,%.4e\n", name, backend, size,
+            parameters.nb_repetitions, result.median, result.p99, result.min, result.max, nb_bits, bits_per_second);
+    fflush(output);
+}
+
+int main(int argc, char **argv)
+{
+    bench_parameters parameters;
+    parameters.min_size = 64;
+    parameters.max_size = 512;
+    parameters.nb_warmups = 2;
+    parameters.nb_repetitions = 11;
+    parameters.filter = NULL;
+    parameters.seed = 1;
+    const char *output_name = "bench.csv";
+
+    int option;
+    while ((option = getopt(argc, argv, "m:M:w:r:f:s:o:")) != -1)
+    {
+        switch (option)
+        {
+        case 'm':
+            parameters.min_size = atoi(optarg);
+            break;
+        case 'M':
+            parameters.max_size = atoi(optarg);
+            break;
+        case 'w':
+            parameters.nb_warmups = atoi(optarg);
+            break;
+        case 'r':
+            parameters.nb_repetitions = atoi(optarg);
+            break;
+        case 'f':
+            parameters.filter = optarg;
+            break;
+        case 's':
+            parameters.seed = atoi(optarg);
+            break;
+        case 'o':
+            output_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage : %s [-m min size] [-M max size] [-w warm-ups] [-r repetitions] [-f kernel filter] [-s seed] [-o output.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (parameters.min_size < 2 || parameters.nb_repetitions == 0)
+    {
+        fprintf(stderr, "The sizes must be at least 2 and there must be at least one repetition\n");
+        return 1;
+    }
+
+    FILE *output = strcmp(output_name, "-") == 0 ? stdout : fopen(output_name, "w");
+    if (output == NULL)
+    {
+        perror(output_name);
+        return 1;
+    }
+    write_bench_header(output);
+
+    for (unsigned int size = parameters.min_size; size <= parameters.max_size; size *= 2)
+    {
+        bench_input input = init_bench_input(size, parameters.seed);
+        for (unsigned int k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+        {
+            if (parameters.filter != NULL && strstr(kernels[k].name, parameters.filter) == NULL)
+                continue;
+            // A matrix kernel has one line per backend, a polynomial kernel one line
+            unsigned int nb_backends = kernels[k].representation == NULL ? NB_BENCH_BACKENDS : 1;
+            for (unsigned int b = 0; b < nb_backends; b++)
+            {
+                const char *backend = kernels[k].representation == NULL ? bench_backend_names[b] : kernels[k].representation;
+                bench_result result = run_kernel(kernels[k], &input, &input.matrices[b], parameters);
+                write_bench_result(output, kernels[k].name, backend, size, kernels[k].nb_bits(size), parameters, result);
+                fprintf(stderr, "%-20s %-9s %6u : median %.3f ms, p99 %.3f ms\n", kernels[k].name, backend, size,
+                        result.median / 1e6, result.p99 / 1e6);
+            }
+        }
+        free_bench_input(input);
+    }
+
+    if (output != stdout)
+        fclose(output);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "libs/polynome.h"
+#include "libs/profiler.h"
+#include "libs/matrix_view.h"
+#include "libs_optimized/hybrid_polynome.h"
+#include "libs_optimized/ring.h"
+
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+// Each row of the sparse matrices holds about size / BENCH_SPARSE_RATIO ones, BIKE keys are around 1 %
+#define BENCH_SPARSE_RATIO 64
+
+// Matrix backends compared by the benchmark, the names of find_matrix_backend
+#define NB_BENCH_BACKENDS 4
+
+/**
+ * Inputs of the matrix kernels on one backend, the same matrices on every backend.
+ */
+typedef struct
+{
+    const matrix_backend *backend; /** storage of the rows */
+    backend_matrix matrix1;        /** invertible dense matrix */
+    backend_matrix matrix2;        /** dense random matrix */
+    backend_matrix scratch;        /** overwritten by the kernels */
+} bench_matrices;
+
+/**
+ * Parameters of a benchmark run
+ */
+typedef struct
+{
+    unsigned int min_size;       /** first size of the sweep */
+    unsigned int max_size;       /** last size of the sweep, the size doubles between two runs */
+    unsigned int nb_warmups;     /** untimed runs before the measures */
+    unsigned int nb_repetitions; /** timed runs of each kernel at each size */
+    const char *filter;          /** only the kernels whose name contains it, NULL for all */
+    unsigned int seed;           /** seed of the generator of the inputs, the inputs do not depend on the kernels run */
+} bench_parameters;
+
+/**
+ * Inputs of the kernels at one size, built once and shared by every kernel.
+ * The kernels must leave them unchanged, except the scratch matrices.
+ */
+typedef struct
+{
+    unsigned int size;                          /** rows and columns of the square matrices */
+    bench_matrices matrices[NB_BENCH_BACKENDS]; /** inputs of the matrix kernels on each backend */
+    int *columns;                               /** columns drawn by the column sampling */
+    bit **lines;                                /** first row of matrix1 then a row overwritten by the kernels, as rows of matrix.c */
+    polynome *polynomial1;                      /** sparse random matrix */
+    polynome *polynomial2;                      /** sparse random matrix */
+    hybrid_polynome *hybrid1;                   /** same matrix as polynomial1 */
+    hybrid_polynome *hybrid2;                   /** same matrix as polynomial2 */
+    uint64_t *ring;                             /** first row of matrix1, packed */
+    uint64_t *ring_scratch;                     /** overwritten by the kernels */
+    drbg generator;                             /** generator of the inputs and of the samplers */
+} bench_input;
+
+/**
+ * A primitive timed on one storage.
+ * The matrix kernels run on every matrix backend, the polynomial kernels on their own representation.
+ */
+typedef struct
+{
+    const char *name;                                 /** name of the primitive, the same on every storage */
+    const char *representation;                       /** storage of a polynomial kernel, NULL for a matrix kernel */
+    uint64_t (*run)(bench_input *, bench_matrices *); /** runs the primitive once on the matrices of a backend, returns the time of the primitive only in ns */
+    uint64_t (*nb_bits)(unsigned int);                /** bits processed by one run at a size */
+} bench_kernel;
+
+/**
+ * Durations of the timed runs of a kernel, in ns.
+ */
+typedef struct
+{
+    uint64_t median; /** median duration */
+    uint64_t p99;    /** 99th percentile */
+    uint64_t min;    /** shortest duration */
+    uint64_t max;    /** longest duration */
+} bench_result;
+
+// Inputs
+
+bench_input init_bench_input(unsigned int size, unsigned int seed);
+void free_bench_input(bench_input input);
+
+// Measures
+
+bench_result run_kernel(bench_kernel kernel, bench_input *input, bench_matrices *matrices, bench_parameters parameters);
+void write_bench_header(FILE *output);
+void write_bench_result(FILE *output, const char *name, const char *backend, unsigned int size, uint64_t nb_bits, bench_parameters parameters, bench_result result);
+
+#endif
\ No newline at end of file
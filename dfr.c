@@ -0,0 +1,391 @@
+#include "dfr.h"
+
+/**
+ * Decoding failure rate (DFR) estimation.
+ * Many private keys are generated, and many errors are decoded with each key,
+ * the keys being shared between worker threads. Key k only uses the random stream k
+ * of the seed, so a run gives the same result whatever the number of threads.
+ *
+ * The public key is not needed : the syndrome of the cypher of (e0, e1) is H * (e0 | e1),
+ * so each trial only samples an error, loads its syndrome and decodes it.
+ */
+
+/**
+ * State shared by the worker threads
+ */
+typedef struct
+{
+    dfr_parameters parameters; /** parameters of the run */
+    unsigned long next_key;    /** next key to evaluate */
+    dfr_statistics total;      /** statistics of the finished keys */
+    phase_profiler *profiler;  /** phases of the finished keys, NULL if not profiled */
+    perf_counters *counters;   /** hardware counters of the finished keys, NULL if not measured */
+    pthread_mutex_t lock;      /** protects next_key, total, profiler and counters */
+} dfr_workers;
+
+dfr_statistics init_dfr_statistics()
+{
+    dfr_statistics statistics;
+    memset(&statistics, 0, sizeof(dfr_statistics));
+    return statistics;
+}
+
+/**
+ * Add the statistics of a thread to the total.
+ *
+ * @param total statistics to update
+ * @param part statistics to add
+ */
+void merge_dfr_statistics(dfr_statistics *total, dfr_statistics *part)
+{
+    total->nb_trials += part->nb_trials;
+    total->nb_failures += part->nb_failures;
+    for (int i = 0; i < DFR_HISTOGRAM_SIZE; i++)
+    {
+        total->success_iterations[i] += part->success_iterations[i];
+        total->failure_iterations[i] += part->failure_iterations[i];
+    }
+}
+
+/**
+ * Wilson score interval of a failure rate.
+ * Unlike the normal approximation, it stays meaningful when there are few or no failures.
+ *
+ * @param nb_failures number of failures
+ * @param nb_trials number of trials
+ * @param z quantile of the normal distribution (1.96 for 95%)
+ * @param low lower bound of the interval
+ * @param high upper bound of the interval
+ */
+void wilson_interval(unsigned long nb_failures, unsigned long nb_trials, double z, double *low, double *high)
+{
+    if (nb_trials == 0)
+    {
+        *low = 0;
+        *high = 1;
+        return;
+    }
+    double N = nb_trials;
+    double p = nb_failures / N;
+    double center = (p + z * z / (2 * N)) / (1 + z * z / N);
+    double radius = z / (1 + z * z / N) * sqrt(p * (1 - p) / N + z * z / (4 * N * N));
+    *low = center - radius > 0 ? center - radius : 0;
+    *high = center + radius < 1 ? center + radius : 1;
+}
+
+/**
+ * Decode nb_cyphers_per_key errors with one private key.
+ *
+ * @param parameters parameters of the run
+ * @param key index of the key, also the random stream used
+ * @param statistics statistics to update
+ * @param profiler profiler of the calling thread, NULL if not profiled
+ * @param counters hardware counters of the calling thread, NULL if not measured
+ */
+void dfr_key_trials(dfr_parameters parameters, unsigned long key, dfr_statistics *statistics, phase_profiler *profiler, perf_counters *counters)
+{
+    drbg generator = init_drbg(parameters.seed, key);
+    unsigned int n = parameters.n;
+
+    // Private key : first line of h0 and h1 and the shift between two lines
+    polynome h0_support, h1_support;
+    h0_support.size = parameters.w;
+    h1_support.size = parameters.w;
+    h0_support.liste_indice = (int *)malloc(sizeof(int) * parameters.w);
+    h1_support.liste_indice = (int *)malloc(sizeof(int) * parameters.w);
+    sample_support(&generator, h0_support.liste_indice, parameters.w, n);
+    sample_support(&generator, h1_support.liste_indice, parameters.w, n);
+    unsigned int shift = 1 + uniform_drbg(&generator, n - 1);
+    decoder_context context = init_decoder_context_from_support(h0_support, h1_support, n, shift, parameters.t);
+    context.profiler = profiler;
+    context.perf = counters;
+
+    // Error of weight t / 2 on each part, as in cypher
+    polynome e0, e1;
+    e0.size = parameters.t / 2;
+    e1.size = parameters.t / 2;
+    e0.liste_indice = (int *)malloc(sizeof(int) * e0.size);
+    e1.liste_indice = (int *)malloc(sizeof(int) * e1.size);
+
+    for (unsigned int c = 0; c < parameters.nb_cyphers_per_key; c++)
+    {
+        sample_support(&generator, e0.liste_indice, e0.size, n);
+        sample_support(&generator, e1.liste_indice, e1.size, n);
+        load_error(&context, e0, e1);
+        decode_syndrome(&context, parameters.decoder, parameters.threshold, parameters.t / 2);
+
+        unsigned int bin = context.nb_iterations < DFR_HISTOGRAM_SIZE ? context.nb_iterations : DFR_HISTOGRAM_SIZE - 1;
+        statistics->nb_trials++;
+        if (is_error_found(&context, e0, e1))
+        {
+            statistics->success_iterations[bin]++;
+        }
+        else
+        {
+            statistics->nb_failures++;
+            statistics->failure_iterations[bin]++;
+        }
+    }
+
+    free(e0.liste_indice);
+    free(e1.liste_indice);
+    free(h0_support.liste_indice);
+    free(h1_support.liste_indice);
+    free_decoder_context(context);
+}
+
+/**
+ * Worker thread : evaluate keys until every key is done.
+ *
+ * @param arg the shared dfr_workers
+ * @return NULL
+ */
+static void *dfr_worker(void *arg)
+{
+    dfr_workers *workers = (dfr_workers *)arg;
+    dfr_statistics statistics = init_dfr_statistics();
+    // Each worker profiles and counts its own thread, merged with the others at the end
+    phase_profiler *profiler = workers->profiler != NULL ? init_profiler() : NULL;
+    perf_counters *counters = workers->counters != NULL ? init_perf_counters() : NULL;
+    unsigned long nb_keys = workers->parameters.nb_keys;
+    unsigned long progress_step = nb_keys / 100 > 0 ? nb_keys / 100 : 1;
+
+    while (1)
+    {
+        pthread_mutex_lock(&workers->lock);
+        unsigned long key = workers->next_key;
+        workers->next_key++;
+        pthread_mutex_unlock(&workers->lock);
+        if (key >= nb_keys)
+            break;
+        if (key % progress_step == 0)
+            fprintf(stderr, "Key %lu / %lu\n", key, nb_keys);
+        dfr_key_trials(workers->parameters, key, &statistics, profiler, counters);
+    }
+
+    pthread_mutex_lock(&workers->lock);
+    merge_dfr_statistics(&workers->total, &statistics);
+    if (profiler != NULL)
+        merge_profiler(workers->profiler, profiler);
+    if (counters != NULL)
+        merge_perf_counters(workers->counters, counters);
+    pthread_mutex_unlock(&workers->lock);
+    if (profiler != NULL)
+        free_profiler(profiler);
+    if (counters != NULL)
+        free_perf_counters(counters);
+    return NULL;
+}
+
+/**
+ * Estimate the decoding failure rate with parameters.nb_threads threads.
+ *
+ * @param parameters parameters of the run
+ * @param profiler result, phases of every decoding, NULL if not profiled
+ * @param counters result, hardware counters of every decoding, NULL if not measured
+ * @return statistics of every decoding
+ */
+dfr_statistics dfr(dfr_parameters parameters, phase_profiler *profiler, perf_counters *counters)
+{
+    dfr_workers workers;
+    workers.parameters = parameters;
+    workers.next_key = 0;
+    workers.total = init_dfr_statistics();
+    workers.profiler = profiler;
+    workers.counters = counters;
+    pthread_mutex_init(&workers.lock, NULL);
+
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * parameters.nb_threads);
+    for (unsigned int i = 0; i < parameters.nb_threads; i++)
+        pthread_create(&threads[i], NULL, dfr_worker, &workers);
+    for (unsigned int i = 0; i < parameters.nb_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+    pthread_mutex_destroy(&workers.lock);
+    return workers.total;
+}
+
+/**
+ * Write an histogram as a JSON array, without its trailing zeros.
+ *
+ * @param output file to write in
+ * @param histogram histogram of DFR_HISTOGRAM_SIZE bins
+ */
+static void write_histogram(FILE *output, unsigned long *histogram)
+{
+    int size = DFR_HISTOGRAM_SIZE;
+    while (size > 0 && histogram[size - 1] == 0)
+        size--;
+    fprintf(output, "[");
+    for (int i = 0; i < size; i++)
+        fprintf(output, i == 0 ? "%lu" : ", %lu", histogram[i]);
+    fprintf(output, "]");
+}
+
+/**
+ * Write the result of a run as JSON.
+ *
+ * @param output file to write in
+ * @param parameters parameters of the run
+ * @param statistics merged statistics of the run
+ * @param seconds duration of the run
+ */
+void write_dfr_report(FILE *output, dfr_parameters parameters, dfr_statistics statistics, double seconds)
+{
+    double rate = statistics.nb_trials > 0 ? (double)statistics.nb_failures / statistics.nb_trials : 0;
+    double low, high;
+    wilson_interval(statistics.nb_failures, statistics.nb_trials, 1.96, &low, &high);
+
+    double total_iterations = 0;
+    for (int i = 0; i < DFR_HISTOGRAM_SIZE; i++)
+        total_iterations += (double)i * (statistics.success_iterations[i] + statistics.failure_iterations[i]);
+
+    fprintf(output, "{\n");
+    fprintf(output, "  \"parameters\": {\"n\": %u, \"w\": %u, \"t\": %u, \"threshold\": %d, \"decoder\": \"%s\", ",
+            parameters.n, parameters.w, parameters.t, parameters.threshold, decoder_name(parameters.decoder));
+    fprintf(output, "\"nb_keys\": %lu, \"nb_cyphers_per_key\": %u, \"nb_threads\": %u, \"seed\": %llu},\n",
+            parameters.nb_keys, parameters.nb_cyphers_per_key, parameters.nb_threads, (unsigned long long)parameters.seed);
+    fprintf(output, "  \"nb_trials\": %lu,\n", statistics.nb_trials);
+    fprintf(output, "  \"nb_failures\": %lu,\n", statistics.nb_failures);
+    fprintf(output, "  \"dfr\": %.6e,\n", rate);
+    if (statistics.nb_failures > 0)
+        fprintf(output, "  \"log2_dfr\": %.3f,\n", log2(rate));
+    else
+        fprintf(output, "  \"log2_dfr\": null,\n");
+    fprintf(output, "  \"confidence_interval\": {\"method\": \"wilson\", \"level\": 0.95, \"low\": %.6e, \"high\": %.6e},\n", low, high);
+    fprintf(output, "  \"average_iterations\": %.4f,\n", statistics.nb_trials > 0 ? total_iterations / statistics.nb_trials : 0);
+    fprintf(output, "  \"success_iterations\": ");
+    write_histogram(output, statistics.success_iterations);
+    fprintf(output, ",\n  \"failure_iterations\": ");
+    write_histogram(output, statistics.failure_iterations);
+    fprintf(output, ",\n  \"seconds\": %.3f,\n", seconds);
+    fprintf(output, "  \"trials_per_second\": %.1f\n", seconds > 0 ? statistics.nb_trials / seconds : 0);
+    fprintf(output, "}\n");
+}
+
+/**
+ * Usage : dfr [-n size] [-w weight] [-t error weight] [-T threshold] [-d decoder]
+ *             [-k keys] [-c cyphers per key] [-j threads] [-s seed] [-o output.json]
+ *             [-p profile.json] [-P hardware_counters.json]
+ */
+int main(int argc, char **argv)
+{
+    dfr_parameters parameters;
+    parameters.n = 4813;
+    parameters.w = 39;
+    parameters.t = 78;
+    parameters.threshold = 26;
+    parameters.decoder = DECODER_BGF;
+    parameters.nb_keys = 100;
+    parameters.nb_cyphers_per_key = 1000;
+    parameters.nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    parameters.seed = time(NULL);
+    const char *output_name = "dfr.json";
+    const char *profile_name = NULL;
+    const char *perf_name = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:w:t:T:d:k:c:j:s:o:p:P:")) != -1)
+    {
+        switch (option)
+        {
+        case 'n':
+            parameters.n = atoi(optarg);
+            break;
+        case 'w':
+            parameters.w = atoi(optarg);
+            break;
+        case 't':
+            parameters.t = atoi(optarg);
+            break;
+        case 'T':
+            parameters.threshold = atoi(optarg);
+            break;
+        case 'd':
+            parameters.decoder = parse_decoder(optarg);
+            break;
+        case 'k':
+            parameters.nb_keys = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            parameters.nb_cyphers_per_key = atoi(optarg);
+            break;
+        case 'j':
+            parameters.nb_threads = atoi(optarg);
+            break;
+        case 's':
+            parameters.seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            output_name = optarg;
+            break;
+        case 'p':
+            profile_name = optarg;
+            break;
+        case 'P':
+            perf_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage : %s [-n size] [-w weight] [-t error weight] [-T threshold] [-d decoder] [-k keys] [-c cyphers per key] [-j threads] [-s seed] [-o output.json] [-p profile.json] [-P hardware_counters.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (parameters.nb_threads == 0)
+        parameters.nb_threads = 1;
+
+    printf("Launch of DFR estimation for w = %u, n = %u, t = %u, decoder = %s, %lu x %u trials on %u threads\n",
+           parameters.w, parameters.n, parameters.t, decoder_name(parameters.decoder),
+           parameters.nb_keys, parameters.nb_cyphers_per_key, parameters.nb_threads);
+
+    phase_profiler *profiler = profile_name != NULL ? init_profiler() : NULL;
+    perf_counters *counters = perf_name != NULL ? init_perf_counters() : NULL;
+    if (counters != NULL && nb_perf_events_available(counters) == 0)
+        fprintf(stderr, "Hardware counters not available (perf_event_open refused)\n");
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    dfr_statistics statistics = dfr(parameters, profiler, counters);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    FILE *output = strcmp(output_name, "-") == 0 ? stdout : fopen(output_name, "w");
+    if (output == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", output_name);
+        return 1;
+    }
+    write_dfr_report(output, parameters, statistics, seconds);
+    if (output != stdout)
+    {
+        fclose(output);
+        printf("Report written in %s\n", output_name);
+    }
+
+    if (profile_name != NULL)
+    {
+        FILE *profile = fopen(profile_name, "w");
+        if (profile == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", profile_name);
+            return 1;
+        }
+        write_profiler_report(profiler, profile);
+        fclose(profile);
+        printf("Profile written in %s\n", profile_name);
+        free_profiler(profiler);
+    }
+    if (perf_name != NULL)
+    {
+        FILE *report = fopen(perf_name, "w");
+        if (report == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", perf_name);
+            return 1;
+        }
+        write_perf_report(counters, report);
+        fclose(report);
+        printf("Hardware counters written in %s\n", perf_name);
+        free_perf_counters(counters);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef DFR_H
+#define DFR_H
+
+#include "libs/decoder.h"
+#include "libs/drbg.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// Iteration counts above are put in the last bin
+#define DFR_HISTOGRAM_SIZE (BITFLIP_MAX_ITERATIONS + 1)
+
+/**
+ * Parameters of a decoding failure rate estimation
+ */
+typedef struct
+{
+    unsigned int n;                  /** size of each block of the private key */
+    unsigned int w;                  /** weight of each line of h0 and h1 */
+    unsigned int t;                  /** weight of the whole error */
+    int threshold;                   /** threshold of the fixed threshold decoders */
+    decoder_type decoder;            /** decoder to evaluate */
+    unsigned long nb_keys;           /** number of private keys */
+    unsigned int nb_cyphers_per_key; /** number of errors decoded with each key */
+    unsigned int nb_threads;         /** number of worker threads */
+    uint64_t seed;                   /** seed of the run, key k uses the stream k */
+} dfr_parameters;
+
+/**
+ * Results of the decodings, merged between the threads
+ */
+typedef struct
+{
+    unsigned long nb_trials;                              /** number of decodings */
+    unsigned long nb_failures;                            /** decodings which did not find the error */
+    unsigned long success_iterations[DFR_HISTOGRAM_SIZE]; /** iterations of the successful decodings */
+    unsigned long failure_iterations[DFR_HISTOGRAM_SIZE]; /** iterations of the failed decodings */
+} dfr_statistics;
+
+// Statistics
+
+dfr_statistics init_dfr_statistics();
+void merge_dfr_statistics(dfr_statistics *total, dfr_statistics *part);
+void wilson_interval(unsigned long nb_failures, unsigned long nb_trials, double z, double *low, double *high);
+
+// Estimation
+
+void dfr_key_trials(dfr_parameters parameters, unsigned long key, dfr_statistics *statistics, phase_profiler *profiler, perf_counters *counters);
+dfr_statistics dfr(dfr_parameters parameters, phase_profiler *profiler, perf_counters *counters);
+void write_dfr_report(FILE *output, dfr_parameters parameters, dfr_statistics statistics, double seconds);
+
+#endif
\ No newline at end of file
@@ -1,123 +1,83 @@
-#include "libs/matrix.h"
-#include "libs_optimized/matrix_optimized.h"
 #include "isd.h"
 
 /**
- * Select a random sample of columns from a binary matrix.
- * Tailored for the Prage algorithm.
+ * Information set decoding of a random instance with the Prange algorithm of libisdmdpc.
+ * Only the public API of isdmdpc.h is used, as by any program linked with the library.
+ * Usage : isd [profile.json] [hardware_counters.json] [reference|packed32|packed64|simd]
+ */
+
+/**
+ * Write a report of the context in a file.
  *
- * @param matrix The matrix to select columns from
- * @param matrix_copy The matrix n-k x n-k
- * @param n
- * @param k
+ * @param context context profiled
+ * @param name name of the file
+ * @param report isdmdpc_write_profiler_report or isdmdpc_write_perf_report
+ * @return 1, 0 if the file can not be opened
  */
-void sample_random(bit **matrix, bit **matrix_copy, int n, int k)
+static int write_report(const isdmdpc_context *context, const char *name, int (*report)(const isdmdpc_context *, FILE *))
 {
-    int *not_already_picked_index = (int *)malloc(sizeof(int) * n);
-    for (int i = 0; i < n; i++)
-        not_already_picked_index[i] = i;
-
-    unsigned int count = 0;
-    unsigned int indice;
-    while (count != n - k)
+    FILE *output = fopen(name, "w");
+    if (output == NULL)
     {
-        indice = rand() % n;
-        if (not_already_picked_index[indice] == -1)
-            continue;
-        else
-        {
-            not_already_picked_index[indice] = -1;
-            for (int i = 0; i < n - k; i++)
-                matrix_copy[i][count].value = matrix[i][indice].value;
-            count++;
-        }
+        fprintf(stderr, "Cannot open %s\n", name);
+        return 0;
     }
-    free(not_already_picked_index);
+    report(context, output);
+    fclose(output);
+    return 1;
 }
 
-// Prange algorithm on a random binary matrix
-void isd_matrix(int n, int k, int t)
+int main(int argc, char **argv)
 {
+    int n = 400;
+    int k = 200;
+    int t = 20;
+    // Phases and hardware counters written in JSON if files are given
+    const char *profile_name = argc > 1 ? argv[1] : NULL;
+    const char *perf_name = argc > 2 ? argv[2] : NULL;
+    const char *backend = argc > 3 ? argv[3] : NULL;
+    // The ISD only uses the generator and the profiling of the context, no key is generated
+    isdmdpc_parameters parameters = {n, 1, t, ISDMDPC_DECODER_BGF, 0};
+    isdmdpc_context *context = isdmdpc_init_context(parameters, time(NULL), 0);
+    if (profile_name != NULL)
+        isdmdpc_enable_profiler(context);
+    int has_counters = perf_name != NULL && isdmdpc_enable_perf_counters(context);
+    if (perf_name != NULL && !has_counters)
+        fprintf(stderr, "Hardware counters not available (perf_event_open refused)\n");
 
-    bit **H = init_matrix(n - k, n);
-    randomize_matrix(H, n - k, n);
-    // e de taille n
-    bit **e = init_matrix(n, 1);
-    target_weight_matrix(e, n, 1, t);
-
-    bit **s = multiply_matrix(H, e, n - k, n, n, 1);
-
-    bit **H_prime = init_matrix(n - k, n - k);
-    bit **e_prime;
-    bit **inversion_H_prime;
-    int hamming_weight_matrix = -1;
-    do
+    // Random instance : H of size (n - k) x n, e of weight t and s = H * e
+    isdmdpc_matrix *H = isdmdpc_init_matrix(n - k, n, backend);
+    if (H == NULL)
     {
-        sample_random(H, H_prime, n, k);
-
-        inversion_H_prime = inversion_matrix(H_prime, n - k, n - k);
-        if (inversion_H_prime != NULL)
-        {
-            e_prime = multiply_matrix(inversion_H_prime, s, n - k, n - k, n - k, 1);
-            hamming_weight_matrix = hamming_weight(e_prime, n - k, 1);
-            if (hamming_weight_matrix < 80)
-                printf("Weight of e_prime : %d \n", hamming_weight_matrix);
-        }
-        else
-        {
-            printf("Cannot invert \n");
-        }
-        free_matrix(inversion_H_prime, n - k);
-        free_matrix(e_prime, n - k);
-
-    } while (hamming_weight_matrix != t);
-    printf(" Result : %d \n", hamming_weight_matrix);
-}
-
-// Prange algorithm on a random unsigned int matrix with bit to bit manipulation
-void optimized_isd(int n, int k, int t)
-{
-    binary_matrix H = init_optimized_matrix(n - k, n);
-    randomize_optimized_matrix(H);
-    // e de taille n
-    binary_matrix e = init_optimized_matrix(n, 1);
-    target_weight_optimized_matrix(e, t);
-
-    // transpose H to get correct dimensions
-    binary_matrix s = multiply_optimized_matrix(transpose_optimized_matrix(H), e);
+        printf("Unknown matrix backend %s, using the default one\n", backend);
+        H = isdmdpc_init_matrix(n - k, n, NULL);
+    }
+    printf("Launch of ISD for n = %d, k = %d, t = %d on the %s backend\n", n, k, t, isdmdpc_matrix_backend(H));
+    isdmdpc_randomize_matrix(context, H);
+    isdmdpc_matrix *e = isdmdpc_init_matrix(n, 1, isdmdpc_matrix_backend(H));
+    isdmdpc_random_weight_matrix(context, e, t);
+    isdmdpc_matrix *s = isdmdpc_multiply_matrix(H, e);
 
-    binary_matrix H_prime = init_optimized_matrix(n - k, n - k);
-    binary_matrix inversion_H_prime;
-    binary_matrix e_prime;
-    int hamming_weight_matrix = -1;
-    int *inversion = malloc(sizeof(int));
-    int boucle = 0;
-    do
+    isdmdpc_matrix *e_found = isdmdpc_init_matrix(n, 1, isdmdpc_matrix_backend(H));
+    if (isdmdpc_isd_solve(context, H, s, t, 0, e_found))
     {
-        H_prime = optimized_sample_random(H, n - k);
-        inversion_H_prime = inversion_optimized_matrix(H_prime, inversion);
-        if (*(inversion))
-        {
-            e_prime = multiply_optimized_matrix(inversion_H_prime, s);
-            hamming_weight_matrix = optimized_hamming_weight(e_prime);
-            if (hamming_weight_matrix < 75)
-                printf("Weight of e_prime : %d \n", hamming_weight_matrix);
-            free_optimized_matrix(e_prime);
-        }
-
-        free_optimized_matrix(H_prime);
-        free_optimized_matrix(inversion_H_prime);
+        // s + H * e_found is null if e_found has the syndrome s
+        isdmdpc_matrix *difference = isdmdpc_multiply_matrix(H, e_found);
+        isdmdpc_add_matrix(difference, s);
+        int is_syndrome = isdmdpc_matrix_weight(difference) == 0;
+        printf(" Result : %u, H * e = s : %s\n", isdmdpc_matrix_weight(e_found), is_syndrome ? "yes" : "no");
+        isdmdpc_free_matrix(difference);
+    }
+    isdmdpc_free_matrix(H);
+    isdmdpc_free_matrix(e);
+    isdmdpc_free_matrix(s);
+    isdmdpc_free_matrix(e_found);
 
-    } while (hamming_weight_matrix != t);
-    printf(" Result : %d \n", hamming_weight_matrix);
+    int is_written = 1;
+    if (profile_name != NULL && (is_written = write_report(context, profile_name, isdmdpc_write_profiler_report)))
+        printf("Profile written in %s\n", profile_name);
+    if (is_written && has_counters && (is_written = write_report(context, perf_name, isdmdpc_write_perf_report)))
+        printf("Hardware counters written in %s\n", perf_name);
+    isdmdpc_free_context(context);
+    return is_written ? 0 : 1;
 }
-
-int main()
-{
-    srand(time(NULL));
-    int n = 400;
-    int k = 200;
-    int t = 20;
-    // isd_matrix(n, k, t);
-    optimized_isd(n, k, t);
-}
\ No newline at end of file
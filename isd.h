@@ -1,10 +1,8 @@
 #ifndef ISD_H
 #define ISD_H
 
-#include <time.h>
-
-void isd(int n, int k, int t);
+#include "libs/isdmdpc.h"
 
-void sample_random(bit **matrix, bit **matrix_copy, int n, int k);
+#include <time.h>
 
 #endif
\ No newline at end of file
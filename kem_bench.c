@@ -0,0 +1,497 @@
+#include "kem_bench.h"
+
+/**
+ * End to end benchmark of the KEM : key generation, expansion of the keys, encapsulation
+ * and decapsulation, timed one by one on worker threads which can be pinned to CPUs.
+ * Key k only uses the random stream k of the seed, so the keys and errors of a run do not
+ * depend on the number of threads. With several rounds, each key is used again every nb_keys
+ * visits and the workers can keep the expanded keys in a key_cache between two rounds.
+ * With a key pool, the key pairs are generated in advance by producer threads instead, in
+ * the streams of the pool, and the keygen operation only times isdmdpc_pop_key_pair.
+ * The report is CSV with fixed columns, one line per parameter set and operation, so that
+ * two releases can be compared line by line.
+ */
+
+/**
+ * State shared by the worker threads
+ */
+typedef struct
+{
+    kem_bench_parameters parameters; /** parameters of the run */
+    unsigned long next_visit;        /** next visit of a key to evaluate */
+    unsigned int next_worker;        /** index of the next worker, for its CPU */
+    kem_bench_statistics *total;     /** statistics of the finished keys */
+    pthread_mutex_t lock;            /** protects next_visit, next_worker and total */
+} kem_bench_workers;
+
+// Names of the operations, in the order of kem_operation
+static const char *operation_names[] = {"keygen", "expand", "encapsulate", "decapsulate"};
+
+/**
+ * Parse a list of CPUs such as "0,2,4-7".
+ *
+ * @param list list to parse
+ * @param cpus result, the CPUs in the order of the list
+ * @param max_cpus size of the array cpus
+ * @return number of CPUs, -1 if the list is invalid
+ */
+int parse_cpu_list(const char *list, int *cpus, unsigned int max_cpus)
+{
+    unsigned int nb_cpus = 0;
+    const char *position = list;
+    while (*position != '\0')
+    {
+        char *end;
+        long first = strtol(position, &end, 10);
+        long last = first;
+        if (end == position || first < 0)
+            return -1;
+        if (*end == '-')
+        {
+            position = end + 1;
+            last = strtol(position, &end, 10);
+            if (end == position || last < first)
+                return -1;
+        }
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (nb_cpus == max_cpus)
+                return -1;
+            cpus[nb_cpus] = cpu;
+            nb_cpus++;
+        }
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return -1;
+        position = end;
+    }
+    return (int)nb_cpus;
+}
+
+/**
+ * Pin the calling thread to one CPU.
+ *
+ * @param cpu CPU to run on
+ * @return 0 on success, -1 else
+ */
+static int pin_thread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // 0 is the calling thread, not the whole process
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+static void merge_kem_bench_statistics(kem_bench_statistics *total, kem_bench_statistics *part)
+{
+    for (int o = 0; o < NB_OPERATIONS; o++)
+        merge_phase_statistics(&total->latencies[o], &part->latencies[o]);
+    for (int i = 0; i < KEM_HISTOGRAM_SIZE; i++)
+        total->iterations[i] += part->iterations[i];
+    total->nb_failures += part->nb_failures;
+    total->cache.hits += part->cache.hits;
+    total->cache.misses += part->cache.misses;
+    total->cache.evictions += part->cache.evictions;
+}
+
+/**
+ * Generate and expand one key pair, then encapsulate and decapsulate nb_messages_per_key errors.
+ * Visit v uses the key v % nb_keys in the round v / nb_keys : the first round draws its errors
+ * after the key in the stream of the key, the next rounds in the stream v. A key found in the
+ * cache is neither generated nor expanded again.
+ *
+ * @param parameters parameters of the run
+ * @param visit index of the visit
+ * @param cache expanded keys of the worker, NULL if not cached
+ * @param statistics statistics to update
+ */
+void kem_bench_key(kem_bench_parameters parameters, unsigned long visit, key_cache *cache, kem_bench_statistics *statistics)
+{
+    unsigned long key = visit % parameters.nb_keys;
+    drbg generator = init_drbg(parameters.seed, key);
+    unsigned int n = parameters.set.n;
+    unsigned int t = parameters.set.t;
+    uint64_t start;
+
+    expanded_key *expanded = cache != NULL ? key_cache_find(cache, key) : NULL;
+    expanded_key uncached;
+    if (expanded == NULL)
+    {
+        key_pair keys = init_key_pair(n, parameters.set.w);
+        start = monotonic_ns();
+        if (parameters.pool != NULL)
+            isdmdpc_pop_key_pair(parameters.pool, keys.private_key, keys.public_key);
+        else
+            generate_key_pair(&generator, keys);
+        record_duration(&statistics->latencies[OPERATION_KEYGEN], monotonic_ns() - start);
+
+        start = monotonic_ns();
+        private_key_view private_key;
+        packed_polynomial_view public_key;
+        int is_valid = read_private_key(keys.private_key, PRIVATE_KEY_BYTES(keys.w), &private_key);
+        is_valid &= read_packed_polynomial(keys.public_key, PACKED_POLYNOMIAL_BYTES(n), &public_key);
+        assert(is_valid);
+        if (cache != NULL)
+            expanded = key_cache_insert(cache, key, private_key, public_key, t, parameters.decoder);
+        else
+        {
+            uncached = expand_key(private_key, public_key, t, parameters.decoder);
+            expanded = &uncached;
+        }
+        record_duration(&statistics->latencies[OPERATION_EXPAND], monotonic_ns() - start);
+        free_key_pair(keys);
+    }
+    if (visit >= parameters.nb_keys)
+        generator = init_drbg(parameters.seed, visit);
+
+    polynome e0, e1;
+    e0.size = t / 2;
+    e1.size = t / 2;
+    e0.liste_indice = (int *)malloc(sizeof(int) * e0.size);
+    e1.liste_indice = (int *)malloc(sizeof(int) * e1.size);
+    uint64_t *c = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    uint64_t *error = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(2 * n));
+    decoder_context *context = &expanded->context;
+
+    for (unsigned int m = 0; m < parameters.nb_messages_per_key; m++)
+    {
+        start = monotonic_ns();
+        sample_support(&generator, e0.liste_indice, e0.size, n);
+        sample_support(&generator, e1.liste_indice, e1.size, n);
+        encapsulate(expanded->public_key, e0, e1, c);
+        record_duration(&statistics->latencies[OPERATION_ENCAPSULATE], monotonic_ns() - start);
+
+        start = monotonic_ns();
+        load_packed_cypher(context, c);
+        int threshold = parameters.threshold > 0 ? parameters.threshold : bgf_threshold(context->bgf, context->syndrome_weight);
+        decode_syndrome(context, parameters.decoder, threshold, t / 2);
+        store_packed_error(context, error);
+        record_duration(&statistics->latencies[OPERATION_DECAPSULATE], monotonic_ns() - start);
+
+        unsigned int bin = context->nb_iterations < KEM_HISTOGRAM_SIZE ? context->nb_iterations : KEM_HISTOGRAM_SIZE - 1;
+        statistics->iterations[bin]++;
+        if (!is_error_found(context, e0, e1))
+            statistics->nb_failures++;
+    }
+
+    free(e0.liste_indice);
+    free(e1.liste_indice);
+    free(c);
+    free(error);
+    if (cache == NULL)
+        free_expanded_key(uncached);
+}
+
+/**
+ * Worker thread : pin itself if CPUs are given, then evaluate keys until every visit is done.
+ * The cache of a worker is its own, as the decoder of an expanded key is not shared.
+ *
+ * @param arg the shared kem_bench_workers
+ * @return NULL
+ */
+static void *kem_bench_worker(void *arg)
+{
+    kem_bench_workers *workers = (kem_bench_workers *)arg;
+    kem_bench_parameters parameters = workers->parameters;
+    // Too big for the stack of a thread with its phase_statistics
+    kem_bench_statistics *statistics = (kem_bench_statistics *)calloc(1, sizeof(kem_bench_statistics));
+    key_cache cache;
+    if (parameters.cache_capacity > 0)
+        cache = init_key_cache(parameters.cache_capacity, parameters.cache_bytes);
+
+    pthread_mutex_lock(&workers->lock);
+    unsigned int worker = workers->next_worker;
+    workers->next_worker++;
+    pthread_mutex_unlock(&workers->lock);
+    if (parameters.cpus != NULL && pin_thread(parameters.cpus[worker % parameters.nb_cpus]) != 0)
+        fprintf(stderr, "Worker %u can not run on CPU %d, left to the scheduler\n", worker, parameters.cpus[worker % parameters.nb_cpus]);
+
+    while (1)
+    {
+        pthread_mutex_lock(&workers->lock);
+        unsigned long visit = workers->next_visit;
+        workers->next_visit++;
+        pthread_mutex_unlock(&workers->lock);
+        if (visit >= parameters.nb_keys * parameters.nb_rounds)
+            break;
+        kem_bench_key(parameters, visit, parameters.cache_capacity > 0 ? &cache : NULL, statistics);
+    }
+    if (parameters.cache_capacity > 0)
+    {
+        statistics->cache = cache.statistics;
+        free_key_cache(cache);
+    }
+
+    pthread_mutex_lock(&workers->lock);
+    merge_kem_bench_statistics(workers->total, statistics);
+    pthread_mutex_unlock(&workers->lock);
+    free(statistics);
+    return NULL;
+}
+
+/**
+ * Run the benchmark of one parameter set with parameters.nb_threads threads.
+ *
+ * @param parameters parameters of the run
+ * @return statistics of every operation, to free
+ */
+kem_bench_statistics *kem_bench(kem_bench_parameters parameters)
+{
+    kem_bench_workers workers;
+    workers.parameters = parameters;
+    workers.next_visit = 0;
+    workers.next_worker = 0;
+    workers.total = (kem_bench_statistics *)calloc(1, sizeof(kem_bench_statistics));
+    pthread_mutex_init(&workers.lock, NULL);
+
+    if (parameters.nb_producers > 0)
+    {
+        // The context only gives the sizes of the keys to the pool
+        isdmdpc_parameters sizes = {parameters.set.n, parameters.set.w, parameters.set.t, ISDMDPC_DECODER_BGF, 0};
+        isdmdpc_context *context = isdmdpc_init_context(sizes, parameters.seed, 0);
+        workers.parameters.pool = isdmdpc_init_key_pool(context, KEM_BENCH_POOL_DEPTH, KEM_BENCH_POOL_DEPTH / 2, parameters.nb_producers, parameters.seed);
+        isdmdpc_free_context(context);
+    }
+
+    uint64_t start = monotonic_ns();
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * parameters.nb_threads);
+    for (unsigned int i = 0; i < parameters.nb_threads; i++)
+        pthread_create(&threads[i], NULL, kem_bench_worker, &workers);
+    for (unsigned int i = 0; i < parameters.nb_threads; i++)
+        pthread_join(threads[i], NULL);
+    workers.total->seconds = (monotonic_ns() - start) / 1e9;
+    if (workers.parameters.pool != NULL)
+    {
+        workers.total->pool = isdmdpc_get_key_pool_statistics(workers.parameters.pool);
+        isdmdpc_free_key_pool(workers.parameters.pool);
+    }
+
+    free(threads);
+    pthread_mutex_destroy(&workers.lock);
+    return workers.total;
+}
+
+const char *operation_name(kem_operation operation)
+{
+    return operation_names[operation];
+}
+
+/**
+ * Percentile of an histogram of iterations.
+ *
+ * @param histogram histogram of KEM_HISTOGRAM_SIZE bins
+ * @param count sum of the bins
+ * @param percentile between 0 and 100
+ * @return the smallest bin holding the percentile
+ */
+static unsigned int iteration_percentile(const unsigned long *histogram, unsigned long count, double percentile)
+{
+    unsigned long rank = (unsigned long)(percentile / 100 * count);
+    if (rank >= count)
+        rank = count > 0 ? count - 1 : 0;
+    unsigned long seen = 0;
+    for (unsigned int i = 0; i < KEM_HISTOGRAM_SIZE; i++)
+    {
+        seen += histogram[i];
+        if (seen > rank)
+            return i;
+    }
+    return KEM_HISTOGRAM_SIZE - 1;
+}
+
+/**
+ * Write the header of the report. The columns are only ever added at the end.
+ *
+ * @param output file to write in
+ */
+void write_kem_bench_header(FILE *output)
+{
+    fprintf(output, "parameter_set,n,w,t,decoder,threads,cpus,operation,count,ops_per_second,"
+                    "mean_ns,p50_ns,p99_ns,p999_ns,max_ns,iterations_mean,iterations_p50,iterations_p99,iterations_max,failures,"
+                    "cache_hits,cache_misses,cache_evictions,pool_hits,pool_misses\n");
+}
+
+/**
+ * Write one line per operation.
+ * The throughput of an operation is its count over the share of the wall time spent in it,
+ * so it accounts for the threads slowing down each other. The iteration columns are only
+ * filled for the decapsulation, the cache columns for the expansion when the keys are cached
+ * and the pool columns for the key generation when the keys come from a pool.
+ *
+ * @param output file to write in
+ * @param parameters parameters of the run
+ * @param statistics merged statistics of the run
+ */
+void write_kem_bench_report(FILE *output, kem_bench_parameters parameters, kem_bench_statistics *statistics)
+{
+    char cpus[64] = "none";
+    if (parameters.cpus != NULL)
+    {
+        int length = 0;
+        for (unsigned int i = 0; i < parameters.nb_cpus && length < (int)sizeof(cpus) - 12; i++)
+            length += snprintf(cpus + length, sizeof(cpus) - length, i == 0 ? "%d" : ";%d", parameters.cpus[i]);
+    }
+
+    double busy_ns = 0;
+    for (int o = 0; o < NB_OPERATIONS; o++)
+        busy_ns += statistics->latencies[o].total;
+
+    for (int o = 0; o < NB_OPERATIONS; o++)
+    {
+        phase_statistics *latencies = &statistics->latencies[o];
+        double share = busy_ns > 0 ? latencies->total / busy_ns : 0;
+        double ops_per_second = share > 0 && statistics->seconds > 0 ? latencies->count / (statistics->seconds * share) : 0;
+        fprintf(output, "%s,%u,%u,%u,%s,%u,%s,%s,%lu,%.1f,%.0f,%lu,%lu,%lu,%lu,", parameters.set.name, parameters.set.n,
+                parameters.set.w, parameters.set.t, decoder_name(parameters.decoder), parameters.nb_threads, cpus,
+                operation_names[o], latencies->count, ops_per_second,
+                latencies->count ? (double)latencies->total / latencies->count : 0.0, phase_percentile(*latencies, 50),
+                phase_percentile(*latencies, 99), phase_percentile(*latencies, 99.9), latencies->max);
+
+        if (o == OPERATION_DECAPSULATE && latencies->count > 0)
+        {
+            double total_iterations = 0;
+            unsigned int max_iterations = 0;
+            for (int i = 0; i < KEM_HISTOGRAM_SIZE; i++)
+            {
+                total_iterations += (double)i * statistics->iterations[i];
+                if (statistics->iterations[i] > 0)
+                    max_iterations = i;
+            }
+            fprintf(output, "%.3f,%u,%u,%u,%lu,", total_iterations / latencies->count,
+                    iteration_percentile(statistics->iterations, latencies->count, 50),
+                    iteration_percentile(statistics->iterations, latencies->count, 99), max_iterations, statistics->nb_failures);
+        }
+        else
+            fprintf(output, ",,,,,");
+
+        if (o == OPERATION_EXPAND && parameters.cache_capacity > 0)
+            fprintf(output, "%lu,%lu,%lu,", statistics->cache.hits, statistics->cache.misses, statistics->cache.evictions);
+        else
+            fprintf(output, ",,,");
+
+        if (o == OPERATION_KEYGEN && parameters.nb_producers > 0)
+            fprintf(output, "%lu,%lu\n", statistics->pool.hits, statistics->pool.misses);
+        else
+            fprintf(output, ",\n");
+    }
+    fflush(output);
+}
+
+/**
+ * Usage : kem_bench [-P parameter sets] [-d decoder] [-T threshold] [-k keys] [-c messages per key]
+ *                   [-R rounds] [-K cached keys] [-B cache MiB] [-p producers] [-j threads] [-C cpu list] [-s seed] [-o output.csv]
+ */
+int main(int argc, char **argv)
+{
+    kem_bench_parameters parameters;
+    parameters.decoder = DECODER_BGF;
+    parameters.threshold = 0;
+    parameters.nb_keys = 8;
+    parameters.nb_messages_per_key = 100;
+    parameters.nb_rounds = 1;
+    parameters.cache_capacity = 0;
+    parameters.cache_bytes = 0;
+    parameters.nb_producers = 0;
+    parameters.pool = NULL;
+    parameters.nb_threads = 1;
+    parameters.cpus = NULL;
+    parameters.nb_cpus = 0;
+    parameters.seed = 1;
+    const char *set_names = "test";
+    const char *output_name = "kem_bench.csv";
+    static int cpus[KEM_BENCH_MAX_CPUS];
+
+    int option;
+    while ((option = getopt(argc, argv, "P:d:T:k:c:R:K:B:p:j:C:s:o:")) != -1)
+    {
+        int nb_cpus;
+        switch (option)
+        {
+        case 'P':
+            set_names = optarg;
+            break;
+        case 'd':
+            parameters.decoder = parse_decoder(optarg);
+            break;
+        case 'T':
+            parameters.threshold = atoi(optarg);
+            break;
+        case 'k':
+            parameters.nb_keys = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            parameters.nb_messages_per_key = atoi(optarg);
+            break;
+        case 'R':
+            parameters.nb_rounds = atoi(optarg);
+            break;
+        case 'K':
+            parameters.cache_capacity = atoi(optarg);
+            break;
+        case 'B':
+            parameters.cache_bytes = strtoull(optarg, NULL, 10) << 20;
+            break;
+        case 'p':
+            parameters.nb_producers = atoi(optarg);
+            break;
+        case 'j':
+            parameters.nb_threads = atoi(optarg);
+            break;
+        case 'C':
+            nb_cpus = parse_cpu_list(optarg, cpus, KEM_BENCH_MAX_CPUS);
+            if (nb_cpus <= 0)
+            {
+                fprintf(stderr, "Invalid CPU list %s, expected for example 0,2,4-7\n", optarg);
+                return 1;
+            }
+            parameters.cpus = cpus;
+            parameters.nb_cpus = nb_cpus;
+            break;
+        case 's':
+            parameters.seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            output_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage : %s [-P test,bike-l1,bike-l3,bike-l5] [-d decoder] [-T threshold] [-k keys] [-c messages per key] [-R rounds] [-K cached keys] [-B cache MiB] [-p producers] [-j threads] [-C cpu list] [-s seed] [-o output.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (parameters.nb_threads == 0)
+        parameters.nb_threads = 1;
+    if (parameters.nb_rounds == 0)
+        parameters.nb_rounds = 1;
+
+    FILE *output = strcmp(output_name, "-") == 0 ? stdout : fopen(output_name, "w");
+    if (output == NULL)
+    {
+        perror(output_name);
+        return 1;
+    }
+    write_kem_bench_header(output);
+
+    char *names = strdup(set_names);
+    for (char *name = strtok(names, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        const parameter_set *set = find_parameter_set(name);
+        if (set == NULL)
+        {
+            fprintf(stderr, "Unknown parameter set %s\n", name);
+            continue;
+        }
+        parameters.set = *set;
+        fprintf(stderr, "Parameter set %s (n = %u, w = %u, t = %u) : %lu keys x %u rounds x %u messages on %u threads\n",
+                set->name, set->n, set->w, set->t, parameters.nb_keys, parameters.nb_rounds, parameters.nb_messages_per_key, parameters.nb_threads);
+        kem_bench_statistics *statistics = kem_bench(parameters);
+        write_kem_bench_report(output, parameters, statistics);
+        free(statistics);
+    }
+    free(names);
+
+    if (output != stdout)
+        fclose(output);
+    return 0;
+}
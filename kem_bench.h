@@ -0,0 +1,81 @@
+#ifndef KEM_BENCH_H
+#define KEM_BENCH_H
+
+// sched_setaffinity and the CPU_* macros
+#define _GNU_SOURCE
+
+#include "libs/key_cache.h"
+#include "libs/isdmdpc.h"
+#include "libs/drbg.h"
+#include "libs/parameter_sets.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// Iteration counts above are put in the last bin
+#define KEM_HISTOGRAM_SIZE (BITFLIP_MAX_ITERATIONS + 1)
+// Most CPUs accepted by -C
+#define KEM_BENCH_MAX_CPUS 1024
+// Key pairs kept ready by the pool of -p, the producers start again at half of them
+#define KEM_BENCH_POOL_DEPTH 16
+
+/**
+ * Operations timed, each one on its own
+ */
+typedef enum
+{
+    OPERATION_KEYGEN,      /** generate_key_pair : serialized private and public keys */
+    OPERATION_EXPAND,      /** parse of the key pair, decoder of the private key and packed public key */
+    OPERATION_ENCAPSULATE, /** sampling of the error and cypher */
+    OPERATION_DECAPSULATE, /** syndrome, decoding and packed error */
+    NB_OPERATIONS
+} kem_operation;
+
+/**
+ * Parameters of a run on one parameter set
+ */
+typedef struct
+{
+    parameter_set set;                /** sizes of the keys */
+    decoder_type decoder;             /** decoder of the decapsulation */
+    int threshold;                    /** threshold of the fixed threshold decoders, 0 for the first threshold of Black-Gray-Flip */
+    unsigned long nb_keys;            /** number of key pairs */
+    unsigned int nb_messages_per_key; /** encapsulations and decapsulations with each key */
+    unsigned int nb_rounds;           /** times each key is used, key k comes back every nb_keys visits */
+    unsigned int cache_capacity;      /** keys kept expanded by each worker between two rounds, 0 for no cache */
+    size_t cache_bytes;               /** memory budget of the cache of each worker, 0 for no limit */
+    unsigned int nb_producers;        /** producer threads of a key pool, 0 to generate the keys in the workers */
+    isdmdpc_key_pool *pool;           /** pool of the run, NULL if nb_producers is 0 */
+    unsigned int nb_threads;          /** number of worker threads */
+    const int *cpus;                  /** worker i runs on cpus[i % nb_cpus], NULL to leave the scheduler choose */
+    unsigned int nb_cpus;             /** size of the array cpus */
+    uint64_t seed;                    /** seed of the run, key k uses the stream k */
+} kem_bench_parameters;
+
+/**
+ * Results of the workers, merged between the threads
+ */
+typedef struct
+{
+    phase_statistics latencies[NB_OPERATIONS];    /** durations of each operation in ns */
+    unsigned long iterations[KEM_HISTOGRAM_SIZE]; /** iterations of each decapsulation */
+    unsigned long nb_failures;                    /** decapsulations which did not find the error */
+    key_cache_statistics cache;                   /** counters of the caches of the workers, summed */
+    isdmdpc_key_pool_statistics pool;             /** counters of the key pool */
+    double seconds;                               /** wall time of the whole run */
+} kem_bench_statistics;
+
+// Command line
+
+int parse_cpu_list(const char *list, int *cpus, unsigned int max_cpus);
+
+// Measures
+
+void kem_bench_key(kem_bench_parameters parameters, unsigned long visit, key_cache *cache, kem_bench_statistics *statistics);
+kem_bench_statistics *kem_bench(kem_bench_parameters parameters);
+const char *operation_name(kem_operation operation);
+void write_kem_bench_header(FILE *output);
+void write_kem_bench_report(FILE *output, kem_bench_parameters parameters, kem_bench_statistics *statistics);
+
+#endif
\ No newline at end of file
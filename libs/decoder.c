@@ -0,0 +1,1059 @@
+#include "decoder.h"
+#include "../libs_optimized/bitslice_decoder.h"
+#include "../libs_optimized/ring.h"
+
+/**
+ * Find the shift of a quasi-cyclic parity check matrix : in each half, row i is row 0
+ * shifted by -i * shift (see init_decoder_context_from_support).
+ *
+ * @param context decoder whose rows are set
+ * @return the shift, -1 if H is not quasi-cyclic
+ */
+static int find_quasi_cyclic_shift(decoder_context *context)
+{
+    unsigned int n = context->nb_rows;
+    polynome first_row = context->rows[0];
+    if (n < 2 || first_row.size == 0 || first_row.liste_indice[0] >= (int)n)
+        return -1;
+
+    unsigned char *is_in_row = (unsigned char *)calloc(2 * n, sizeof(unsigned char));
+    int result = -1;
+    // Row 1 holds first_row[0] - shift, so each index of h0 in row 1 gives a candidate
+    for (int c = 0; c < context->rows[1].size && context->rows[1].liste_indice[c] < (int)n && result < 0; c++)
+    {
+        unsigned int shift = (first_row.liste_indice[0] + n - context->rows[1].liste_indice[c]) % n;
+        int is_shift = 1;
+        for (unsigned int i = 1; i < n && is_shift; i++)
+        {
+            polynome row = context->rows[i];
+            unsigned int offset = n - (unsigned int)(((unsigned long)i * shift) % n);
+            for (int k = 0; k < row.size; k++)
+                is_in_row[row.liste_indice[k]] = 1;
+            is_shift = row.size == first_row.size;
+            for (int k = 0; k < first_row.size && is_shift; k++)
+            {
+                unsigned int half = first_row.liste_indice[k] >= (int)n ? n : 0;
+                is_shift = is_in_row[half + (first_row.liste_indice[k] - half + offset) % n];
+            }
+            for (int k = 0; k < row.size; k++)
+                is_in_row[row.liste_indice[k]] = 0;
+        }
+        if (is_shift)
+            result = shift;
+    }
+    free(is_in_row);
+    return result;
+}
+
+/**
+ * Build the columns of the parity check matrix and allocate the buffers of the decoder.
+ * The rows must already be set.
+ *
+ * @param context decoder whose rows are set
+ * @param t weight of the whole error, used for the thresholds
+ */
+static void init_decoder_buffers(decoder_context *context, unsigned int t)
+{
+    unsigned int n = context->nb_rows;
+
+    // Columns of H, filled row by row so that they are sorted
+    int *column_sizes = (int *)calloc(2 * n, sizeof(int));
+    for (unsigned int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < context->rows[i].size; k++)
+            column_sizes[context->rows[i].liste_indice[k]]++;
+    }
+    context->columns = (polynome *)malloc(sizeof(polynome) * 2 * n);
+    for (unsigned int j = 0; j < 2 * n; j++)
+    {
+        context->columns[j].liste_indice = (int *)malloc(sizeof(int) * column_sizes[j]);
+        context->columns[j].size = 0;
+    }
+    for (unsigned int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < context->rows[i].size; k++)
+        {
+            polynome *column = &context->columns[context->rows[i].liste_indice[k]];
+            column->liste_indice[column->size] = i;
+            column->size++;
+        }
+    }
+    free(column_sizes);
+
+    // Support of row 0 in each half, for CONVOLUTION_COUNTERS
+    context->shift = find_quasi_cyclic_shift(context);
+    int h0_weight = 0;
+    while (h0_weight < context->rows[0].size && context->rows[0].liste_indice[h0_weight] < (int)n)
+        h0_weight++;
+    for (int half = 0; half < 2; half++)
+    {
+        context->first_rows[half].size = half == 0 ? h0_weight : context->rows[0].size - h0_weight;
+        context->first_rows[half].liste_indice = (int *)malloc(sizeof(int) * context->first_rows[half].size);
+        for (int k = 0; k < context->first_rows[half].size; k++)
+            context->first_rows[half].liste_indice[k] = context->rows[0].liste_indice[half * h0_weight + k] - half * n;
+    }
+
+    context->bgf = init_bgf_parameters(n, context->columns[0].size, t);
+    context->backflip = init_backflip_parameters(n, context->columns[0].size, t);
+
+    int max_weight = 0;
+    for (unsigned int j = 0; j < 2 * n; j++)
+        max_weight = context->columns[j].size > max_weight ? context->columns[j].size : max_weight;
+
+    context->syndrome = (uint64_t *)calloc(NB_WORDS(n), sizeof(uint64_t));
+    context->error = (uint64_t *)calloc(NB_WORDS(2 * n), sizeof(uint64_t));
+    context->counters = (int *)calloc(2 * n, sizeof(int));
+    context->touched = (unsigned int *)malloc(sizeof(unsigned int) * 2 * n);
+    context->is_touched = (unsigned char *)calloc(2 * n, sizeof(unsigned char));
+    context->flipped = (unsigned int *)malloc(sizeof(unsigned int) * 2 * n);
+    context->gray = (unsigned int *)malloc(sizeof(unsigned int) * 2 * n);
+    context->death_time = (int *)calloc(2 * n, sizeof(int));
+    context->sliced = init_bitsliced_counters(2 * NB_WORDS(n) * WORD_SIZE, max_weight);
+    context->sliced_buffer = (uint64_t *)calloc(2 * NB_WORDS(n), sizeof(uint64_t));
+    context->doubled_syndrome = (uint64_t *)calloc(DOUBLED_WORDS(n), sizeof(uint64_t));
+    context->flip_mask = (uint64_t *)calloc(2 * NB_WORDS(n), sizeof(uint64_t));
+    context->permuted_syndrome = (int *)calloc(n, sizeof(int));
+    context->lanes = NULL;
+    context->profiler = NULL;
+    context->perf = NULL;
+    context->syndrome_weight = 0;
+    context->error_weights[0] = 0;
+    context->error_weights[1] = 0;
+    context->nb_touched = 0;
+    context->nb_iterations = 0;
+}
+
+/**
+ * Initialize the decoder of a private key.
+ * Every buffer used by the decoders is allocated here, so decoding does not allocate.
+ *
+ * @param h0 first part of the private key (n x n)
+ * @param h1 second part of the private key (n x n)
+ * @param n size of the private key
+ * @param t weight of the whole error, used for the thresholds
+ * @return the decoder, syndrome and error set to zero
+ */
+decoder_context init_decoder_context(bit **h0, bit **h1, unsigned int n, unsigned int t)
+{
+    // Rows of H = [h0 | h1], the indices of h1 are shifted by n
+    polynome *rows = (polynome *)malloc(sizeof(polynome) * n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        int size = 0;
+        for (unsigned int j = 0; j < n; j++)
+            size += get_matrix_bit(h0, i, j) + get_matrix_bit(h1, i, j);
+        rows[i].liste_indice = (int *)malloc(sizeof(int) * size);
+        rows[i].size = 0;
+        for (unsigned int j = 0; j < 2 * n; j++)
+        {
+            if (j < n ? get_matrix_bit(h0, i, j) : get_matrix_bit(h1, i, j - n))
+            {
+                rows[i].liste_indice[rows[i].size] = j;
+                rows[i].size++;
+            }
+        }
+    }
+    return init_decoder_context_from_rows(rows, n, t);
+}
+
+/**
+ * Initialize the decoder of a private key given by the rows of H = [h0 | h1].
+ *
+ * @param rows sorted support of each of the n rows, the indices of h1 shifted by n,
+ * kept by the decoder and freed by free_decoder_context
+ * @param n size of the private key
+ * @param t weight of the whole error, used for the thresholds
+ * @return the decoder, syndrome and error set to zero
+ */
+decoder_context init_decoder_context_from_rows(polynome *rows, unsigned int n, unsigned int t)
+{
+    decoder_context context;
+    context.nb_rows = n;
+    context.nb_columns = 2 * n;
+    context.rows = rows;
+    init_decoder_buffers(&context, t);
+    return context;
+}
+
+/**
+ * Initialize the decoder of a private key given by the support of the first line of h0 and h1.
+ * Line i of the key is the first line shifted by i * shift (see privkey_generation),
+ * so the n x n matrices are never built.
+ *
+ * @param h0_support support of the first line of h0
+ * @param h1_support support of the first line of h1
+ * @param n size of the private key
+ * @param shift shift between two lines of the key
+ * @param t weight of the whole error, used for the thresholds
+ * @return the decoder, syndrome and error set to zero
+ */
+decoder_context init_decoder_context_from_support(polynome h0_support, polynome h1_support, unsigned int n, unsigned int shift, unsigned int t)
+{
+    // line_i[j] = line_0[(j + i * shift) % n] so j = index - i * shift
+    polynome *rows = (polynome *)malloc(sizeof(polynome) * n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int offset = n - (unsigned int)(((unsigned long)i * shift) % n);
+        rows[i].size = h0_support.size + h1_support.size;
+        rows[i].liste_indice = (int *)malloc(sizeof(int) * rows[i].size);
+        for (int k = 0; k < h0_support.size; k++)
+            rows[i].liste_indice[k] = (h0_support.liste_indice[k] + offset) % n;
+        for (int k = 0; k < h1_support.size; k++)
+            rows[i].liste_indice[h0_support.size + k] = n + (h1_support.liste_indice[k] + offset) % n;
+        // Sorted as the rows built from the matrices
+        qsort(rows[i].liste_indice, rows[i].size, sizeof(int), compare_int);
+    }
+    return init_decoder_context_from_rows(rows, n, t);
+}
+
+void free_decoder_context(decoder_context context)
+{
+    free_polynomial_matrix(context.columns, context.nb_columns);
+    free_polynomial_matrix(context.rows, context.nb_rows);
+    free(context.syndrome);
+    free(context.error);
+    free(context.counters);
+    free(context.touched);
+    free(context.is_touched);
+    free(context.flipped);
+    free(context.gray);
+    free(context.death_time);
+    free_bitsliced_counters(context.sliced);
+    free(context.sliced_buffer);
+    free(context.doubled_syndrome);
+    free(context.flip_mask);
+    free(context.first_rows[0].liste_indice);
+    free(context.first_rows[1].liste_indice);
+    free(context.permuted_syndrome);
+    if (context.lanes != NULL)
+    {
+        free_lanes_decoder(*context.lanes);
+        free(context.lanes);
+    }
+}
+
+/**
+ * Memory used by a decoder.
+ *
+ * @param context decoder
+ * @return number of bytes allocated by init_decoder_context
+ */
+size_t decoder_context_bytes(decoder_context context)
+{
+    size_t bytes = sizeof(polynome) * (context.nb_rows + context.nb_columns);
+    for (unsigned int i = 0; i < context.nb_rows; i++)
+        bytes += sizeof(int) * context.rows[i].size;
+    for (unsigned int j = 0; j < context.nb_columns; j++)
+        bytes += sizeof(int) * context.columns[j].size;
+    // first_rows and permuted_syndrome
+    bytes += sizeof(int) * (context.rows[0].size + context.nb_rows);
+    // syndrome, error, doubled_syndrome, then sliced_buffer, flip_mask and the slices of the counters
+    bytes += sizeof(uint64_t) * (NB_WORDS(context.nb_rows) + NB_WORDS(context.nb_columns) + DOUBLED_WORDS(context.nb_rows));
+    bytes += sizeof(uint64_t) * (2 + context.sliced.nb_slices) * 2 * NB_WORDS(context.nb_rows);
+    // counters, touched, is_touched, flipped, gray, death_time
+    bytes += (size_t)context.nb_columns * (sizeof(int) * 2 + sizeof(unsigned int) * 3 + sizeof(unsigned char));
+    if (context.lanes != NULL)
+        bytes += sizeof(lanes_decoder) + lanes_decoder_bytes(*context.lanes);
+    return bytes;
+}
+
+/**
+ * Clear the error and compute every counter from the loaded syndrome.
+ *
+ * @param context decoder
+ */
+static void start_decoding(decoder_context *context)
+{
+    for (unsigned int i = 0; i < NB_WORDS(context->nb_columns); i++)
+        context->error[i] = 0;
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+        context->death_time[j] = 0;
+    context->error_weights[0] = 0;
+    context->error_weights[1] = 0;
+    context->nb_iterations = 0;
+    compute_counters(context);
+}
+
+/**
+ * Start a new decoding from a syndrome.
+ *
+ * @param context decoder
+ * @param syndrome syndrome to decode (nb_rows x 1)
+ */
+void load_syndrome(decoder_context *context, bit **syndrome)
+{
+    pack_column(syndrome, context->nb_rows, context->syndrome);
+    context->syndrome_weight = hamming_weight(syndrome, context->nb_rows, 1);
+    start_decoding(context);
+}
+
+/**
+ * Start a new decoding from a cypher, the syndrome is h0 * c.
+ * Only the supports of the rows of h0 are read.
+ *
+ * @param context decoder
+ * @param c cypher (nb_rows x 1)
+ */
+void load_cypher(decoder_context *context, bit **c)
+{
+    context->syndrome_weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(context->nb_rows); i++)
+        context->syndrome[i] = 0;
+    for (unsigned int i = 0; i < context->nb_rows; i++)
+    {
+        unsigned int value = 0;
+        for (int k = 0; k < context->rows[i].size && context->rows[i].liste_indice[k] < (int)context->nb_rows; k++)
+            value ^= get_matrix_bit(c, context->rows[i].liste_indice[k], 0);
+        context->syndrome[i / WORD_SIZE] |= (uint64_t)value << (i % WORD_SIZE);
+        context->syndrome_weight += value;
+    }
+    start_decoding(context);
+}
+
+/**
+ * Same as load_cypher with a packed cypher.
+ *
+ * @param context decoder
+ * @param c packed cypher, NB_WORDS(nb_rows) words
+ */
+void load_packed_cypher(decoder_context *context, uint64_t *c)
+{
+    context->syndrome_weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(context->nb_rows); i++)
+        context->syndrome[i] = 0;
+    for (unsigned int i = 0; i < context->nb_rows; i++)
+    {
+        uint64_t value = 0;
+        for (int k = 0; k < context->rows[i].size && context->rows[i].liste_indice[k] < (int)context->nb_rows; k++)
+        {
+            int index = context->rows[i].liste_indice[k];
+            value ^= c[index / WORD_SIZE] >> (index % WORD_SIZE);
+        }
+        value &= 1;
+        context->syndrome[i / WORD_SIZE] |= value << (i % WORD_SIZE);
+        context->syndrome_weight += value;
+    }
+    start_decoding(context);
+}
+
+/**
+ * Start a new decoding from an error given by its support, the syndrome is H * (e0 | e1).
+ * It is the syndrome of the cypher of this error, without building the public key.
+ *
+ * @param context decoder
+ * @param e0 support of the first part of the error
+ * @param e1 support of the second part of the error
+ */
+void load_error(decoder_context *context, polynome e0, polynome e1)
+{
+    for (unsigned int i = 0; i < NB_WORDS(context->nb_rows); i++)
+        context->syndrome[i] = 0;
+    for (int k = 0; k < e0.size + e1.size; k++)
+    {
+        int position = k < e0.size ? e0.liste_indice[k] : (int)context->nb_rows + e1.liste_indice[k - e0.size];
+        polynome column = context->columns[position];
+        for (int l = 0; l < column.size; l++)
+            context->syndrome[column.liste_indice[l] / WORD_SIZE] ^= (uint64_t)1 << (column.liste_indice[l] % WORD_SIZE);
+    }
+    context->syndrome_weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(context->nb_rows); i++)
+        context->syndrome_weight += __builtin_popcountll(context->syndrome[i]);
+    start_decoding(context);
+}
+
+/**
+ * Compute every counter from the syndrome.
+ * Every position becomes a candidate for the next selection.
+ *
+ * @param context decoder
+ */
+void compute_counters(decoder_context *context)
+{
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+    {
+        int count = 0;
+        for (int k = 0; k < context->columns[j].size; k++)
+        {
+            int index = context->columns[j].liste_indice[k];
+            count += (context->syndrome[index / WORD_SIZE] >> (index % WORD_SIZE)) & 1;
+        }
+        context->counters[j] = count;
+        context->touched[j] = j;
+        context->is_touched[j] = 1;
+    }
+    context->nb_touched = context->nb_columns;
+}
+
+/**
+ * Compute every counter from the syndrome as a convolution, same result as compute_counters.
+ * Parity check i holds the positions index - i * shift for index in row 0, so once the bit i of
+ * the syndrome is moved to -i * shift, the counters of each half are the product of the support
+ * of its row 0 by this permuted syndrome in Z[X] / (X^n - 1).
+ * Falls back to compute_counters if H is not quasi-cyclic.
+ *
+ * @param context decoder
+ */
+void compute_convolution_counters(decoder_context *context)
+{
+    if (context->shift < 0)
+    {
+        compute_counters(context);
+        return;
+    }
+    unsigned int n = context->nb_rows;
+    for (unsigned int m = 0; m < n; m++)
+        context->permuted_syndrome[m] = 0;
+    for (unsigned int w = 0; w < NB_WORDS(n); w++)
+    {
+        for (uint64_t word = context->syndrome[w]; word != 0; word &= word - 1)
+        {
+            unsigned int i = w * WORD_SIZE + __builtin_ctzll(word);
+            context->permuted_syndrome[(n - (unsigned int)(((unsigned long)i * context->shift) % n)) % n]++;
+        }
+    }
+
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+    {
+        context->counters[j] = 0;
+        context->touched[j] = j;
+        context->is_touched[j] = 1;
+    }
+    context->nb_touched = context->nb_columns;
+    convolution_counters(context->first_rows[0], context->permuted_syndrome, n, context->counters);
+    convolution_counters(context->first_rows[1], context->permuted_syndrome, n, context->counters + n);
+}
+
+/**
+ * Flip one bit of the error.
+ * Only the parity checks of its column are changed in the syndrome,
+ * and only the positions sharing one of those parity checks get their counter updated.
+ *
+ * @param context decoder
+ * @param position index of the bit to flip
+ */
+void flip_position(decoder_context *context, unsigned int position)
+{
+    uint64_t mask = (uint64_t)1 << (position % WORD_SIZE);
+    context->error[position / WORD_SIZE] ^= mask;
+    if (context->error[position / WORD_SIZE] & mask)
+        context->error_weights[position >= context->nb_rows]++;
+    else
+        context->error_weights[position >= context->nb_rows]--;
+
+    polynome column = context->columns[position];
+    for (int k = 0; k < column.size; k++)
+    {
+        int index = column.liste_indice[k];
+        context->syndrome[index / WORD_SIZE] ^= (uint64_t)1 << (index % WORD_SIZE);
+        // +1 if the parity check is now unsatisfied, -1 else
+        int delta = ((context->syndrome[index / WORD_SIZE] >> (index % WORD_SIZE)) & 1) ? 1 : -1;
+        context->syndrome_weight += delta;
+
+        polynome row = context->rows[index];
+        for (int l = 0; l < row.size; l++)
+        {
+            int j = row.liste_indice[l];
+            context->counters[j] += delta;
+            if (!context->is_touched[j])
+            {
+                context->is_touched[j] = 1;
+                context->touched[context->nb_touched] = j;
+                context->nb_touched++;
+            }
+        }
+    }
+}
+
+/**
+ * Select the positions to flip, stored in context->flipped.
+ * A position whose counter did not change since the last selection was below the threshold,
+ * so only the touched positions are compared.
+ *
+ * @param context decoder
+ * @param threshold minimal number of unsatisfied parity checks to flip a position
+ * @return the number of positions selected
+ */
+unsigned int select_flipped_positions(decoder_context *context, int threshold)
+{
+    unsigned int nb_flipped = 0;
+    for (unsigned int k = 0; k < context->nb_touched; k++)
+    {
+        unsigned int j = context->touched[k];
+        context->is_touched[j] = 0;
+        if (context->counters[j] >= threshold)
+        {
+            context->flipped[nb_flipped] = j;
+            nb_flipped++;
+        }
+    }
+    context->nb_touched = 0;
+    return nb_flipped;
+}
+
+/**
+ * Empty the list of touched positions.
+ * Used by the decoders comparing every position, the next selection starts from scratch.
+ *
+ * @param context decoder
+ */
+static void clear_touched(decoder_context *context)
+{
+    for (unsigned int k = 0; k < context->nb_touched; k++)
+        context->is_touched[context->touched[k]] = 0;
+    context->nb_touched = 0;
+}
+
+unsigned int get_error_bit(decoder_context *context, unsigned int position)
+{
+    return (context->error[position / WORD_SIZE] >> (position % WORD_SIZE)) & 1;
+}
+
+/**
+ * Check that the decoder found exactly a given error.
+ * A null syndrome is not enough : the decoder can also converge to another error.
+ *
+ * @param context decoder
+ * @param e0 support of the first part of the error
+ * @param e1 support of the second part of the error
+ * @return 1 if the error of the decoder is (e0 | e1), 0 else
+ */
+int is_error_found(decoder_context *context, polynome e0, polynome e1)
+{
+    if (context->error_weights[0] != (unsigned int)e0.size || context->error_weights[1] != (unsigned int)e1.size)
+        return 0;
+    for (int k = 0; k < e0.size; k++)
+    {
+        if (!get_error_bit(context, e0.liste_indice[k]))
+            return 0;
+    }
+    for (int k = 0; k < e1.size; k++)
+    {
+        if (!get_error_bit(context, context->nb_rows + e1.liste_indice[k]))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Copy the error found by the decoder in two column matrix.
+ *
+ * @param context decoder
+ * @param e0_output first part of the error (nb_rows x 1)
+ * @param e1_output second part of the error (nb_rows x 1)
+ */
+void store_error(decoder_context *context, bit **e0_output, bit **e1_output)
+{
+    for (unsigned int i = 0; i < context->nb_rows; i++)
+    {
+        set_matrix_bit(e0_output, i, 0, get_error_bit(context, i));
+        set_matrix_bit(e1_output, i, 0, get_error_bit(context, context->nb_rows + i));
+    }
+}
+
+/**
+ * Copy the error found by the decoder, packed.
+ *
+ * @param context decoder
+ * @param error result, NB_WORDS(nb_columns) words
+ */
+void store_packed_error(decoder_context *context, uint64_t *error)
+{
+    memcpy(error, context->error, sizeof(uint64_t) * NB_WORDS(context->nb_columns));
+}
+
+/**
+ * Check that the rows of a quasi-cyclic H are all distinct : i -> i * shift is a permutation
+ * of Z / nZ if gcd(shift, n) == 1, a null shift gives the same row everywhere.
+ *
+ * @param shift shift between two consecutive rows
+ * @param n size of the key
+ * @return 1 if gcd(shift, n) == 1, 0 else
+ */
+int is_coprime_shift(unsigned int shift, unsigned int n)
+{
+    unsigned int a = n;
+    unsigned int b = shift;
+    while (b != 0)
+    {
+        unsigned int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a == 1;
+}
+
+/**
+ * Check that the syndrome can be permuted for the bit-sliced counters : H is quasi-cyclic and
+ * i -> -i * shift is a permutation of Z / nZ, so no two parity checks share a bit.
+ *
+ * @param context decoder
+ * @return 1 if select_bitsliced_positions can be used, 0 else
+ */
+static int is_bitsliced_shift(decoder_context *context)
+{
+    return context->shift >= 0 && is_coprime_shift(context->shift, context->nb_rows);
+}
+
+/**
+ * Select the positions to flip with bit-sliced counters, when is_bitsliced_shift holds.
+ * Bit i of the syndrome is moved to -i * shift as in compute_convolution_counters, with one
+ * pass over every bit, then the counters are the sums of rotations of this permuted syndrome.
+ *
+ * @param context decoder
+ * @param threshold minimal number of unsatisfied parity checks to flip a position
+ * @return number of positions reaching the threshold, stored in flipped
+ */
+static unsigned int select_bitsliced_positions(decoder_context *context, int threshold)
+{
+    unsigned int n = context->nb_rows;
+    uint64_t *permuted = context->sliced_buffer;
+    memset(permuted, 0, sizeof(uint64_t) * NB_WORDS(n));
+    unsigned int position = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        permuted[position / WORD_SIZE] |= ((context->syndrome[i / WORD_SIZE] >> (i % WORD_SIZE)) & 1) << (position % WORD_SIZE);
+        // Position of the bit i + 1 : -(i + 1) * shift modulo n
+        position += n - context->shift;
+        position -= position >= n ? n : 0;
+    }
+    init_doubled_ring(permuted, n, context->doubled_syndrome);
+    compute_bitsliced_counters(context->sliced, context->doubled_syndrome, context->first_rows, n, context->sliced_buffer);
+    threshold_bitsliced_counters(context->sliced, threshold, context->flip_mask);
+
+    unsigned int nb_flipped = 0;
+    for (unsigned int half = 0; half < 2; half++)
+    {
+        uint64_t *mask = context->flip_mask + half * NB_WORDS(n);
+        // The counters after n in each half are padding
+        if (n % WORD_SIZE)
+            mask[NB_WORDS(n) - 1] &= ((uint64_t)1 << (n % WORD_SIZE)) - 1;
+        for (unsigned int i = 0; i < NB_WORDS(n); i++)
+        {
+            for (uint64_t word = mask[i]; word != 0; word &= word - 1)
+            {
+                context->flipped[nb_flipped] = half * n + i * WORD_SIZE + __builtin_ctzll(word);
+                nb_flipped++;
+            }
+        }
+    }
+    return nb_flipped;
+}
+
+/**
+ * Bit flipping algorithm with a fixed threshold.
+ * https://eprint.iacr.org/2019/1423.pdf
+ * Stops when the syndrome is null, when both parts of the error have the expected weight,
+ * when no position reaches the threshold or after BITFLIP_MAX_ITERATIONS iterations.
+ *
+ * @param context decoder with a loaded syndrome
+ * @param threshold minimal number of unsatisfied parity checks to flip a position
+ * @param weight weight of each part of the error
+ * @param engine how the counters are computed at each iteration
+ * @return 1 if the error has been decoded, 0 else
+ */
+int fixed_threshold_bitflip(decoder_context *context, int threshold, unsigned int weight, counter_engine engine)
+{
+    while ((context->error_weights[0] != weight || context->error_weights[1] != weight) && context->syndrome_weight != 0 && context->nb_iterations < BITFLIP_MAX_ITERATIONS)
+    {
+        profiler_timer iteration = start_timer(context->profiler, PHASE_DECODER_ITERATION);
+        perf_measure measure = start_perf_measure(context->perf, SITE_BITFLIP_COUNTERS);
+        unsigned int nb_flipped = 0;
+        if (engine == BITSLICED_COUNTERS && is_bitsliced_shift(context))
+        {
+            nb_flipped = select_bitsliced_positions(context, threshold);
+            clear_touched(context);
+        }
+        else
+        {
+            if (engine == DENSE_COUNTERS || engine == BITSLICED_COUNTERS)
+                compute_counters(context);
+            else if (engine == CONVOLUTION_COUNTERS)
+                compute_convolution_counters(context);
+            nb_flipped = select_flipped_positions(context, threshold);
+        }
+        // One counter for each position
+        stop_perf_measure(measure, context->nb_columns);
+
+        // No counter reaches the threshold, the next iterations would be the same
+        if (nb_flipped == 0)
+        {
+            stop_timer(iteration);
+            break;
+        }
+        for (unsigned int k = 0; k < nb_flipped; k++)
+            flip_position(context, context->flipped[k]);
+        context->nb_iterations++;
+        stop_timer(iteration);
+    }
+    // The syndrome is s + H * e so the result is correct if it is null
+    return context->syndrome_weight == 0;
+}
+
+/**
+ * Run a decoder on the loaded syndrome.
+ *
+ * @param context decoder with a loaded syndrome
+ * @param decoder decoder to use
+ * @param threshold threshold of the fixed threshold decoders
+ * @param weight weight of each part of the error, for the fixed threshold decoders
+ * @return 1 if the error has been decoded, 0 else
+ */
+int decode_syndrome(decoder_context *context, decoder_type decoder, int threshold, unsigned int weight)
+{
+    profiler_timer decoding = start_timer(context->profiler, PHASE_DECODE);
+    int decoded;
+    switch (decoder)
+    {
+    case DECODER_BITSLICED:
+        decoded = fixed_threshold_bitflip(context, threshold, weight, BITSLICED_COUNTERS);
+        break;
+    case DECODER_INCREMENTAL:
+        decoded = fixed_threshold_bitflip(context, threshold, weight, INCREMENTAL_COUNTERS);
+        break;
+    case DECODER_BGF:
+        decoded = black_gray_flip(context, context->bgf);
+        break;
+    case DECODER_BACKFLIP:
+        decoded = backflip(context, context->backflip);
+        break;
+    case DECODER_CONVOLUTION:
+        decoded = fixed_threshold_bitflip(context, threshold, weight, CONVOLUTION_COUNTERS);
+        break;
+    default:
+        decoded = fixed_threshold_bitflip(context, threshold, weight, DENSE_COUNTERS);
+    }
+    stop_timer(decoding);
+    return decoded;
+}
+
+/**
+ * Decode a cypher : load its syndrome, run the decoder and store the error found.
+ *
+ * @param context decoder of the private key
+ * @param decoder decoder to use
+ * @param c cypher (nb_rows x 1)
+ * @param threshold threshold of the fixed threshold decoders
+ * @param weight weight of each part of the error
+ * @param e0_output first part of the error found (nb_rows x 1), allocated by the caller
+ * @param e1_output second part of the error found (nb_rows x 1), allocated by the caller
+ * @return 1 if the error has been decoded, 0 else
+ */
+int decode_cypher(decoder_context *context, decoder_type decoder, bit **c, int threshold, unsigned int weight, bit **e0_output, bit **e1_output)
+{
+    load_cypher(context, c);
+    int decoded = decode_syndrome(context, decoder, threshold, weight);
+    if (decoded)
+        store_error(context, e0_output, e1_output);
+    return decoded;
+}
+
+// Names of the decoders, in the order of decoder_type
+static const char *decoder_names[] = {"bitflip", "bitsliced", "incremental", "bgf", "backflip", "convolution"};
+
+/**
+ * Get a decoder from its name.
+ *
+ * @param name bitflip, bitsliced, incremental, bgf, backflip or convolution
+ * @return the decoder, DECODER_BITFLIP if the name is unknown
+ */
+decoder_type parse_decoder(const char *name)
+{
+    for (int i = 0; i < (int)(sizeof(decoder_names) / sizeof(decoder_names[0])); i++)
+    {
+        if (strcmp(name, decoder_names[i]) == 0)
+            return (decoder_type)i;
+    }
+    printf("Unknown decoder %s, using bitflip\n", name);
+    return DECODER_BITFLIP;
+}
+
+const char *decoder_name(decoder_type decoder)
+{
+    return decoder_names[decoder];
+}
+
+/**
+ * Threshold of the bit flipping algorithm as a function of the syndrome weight.
+ * Formula of the BIKE specification, the affine thresholds are fitted on it.
+ *
+ * @param n size of each block (r in BIKE)
+ * @param w weight of each column (d in BIKE)
+ * @param t weight of the whole error
+ * @param syndrome_weight weight of the current syndrome
+ * @return the threshold (not rounded), NAN if the syndrome weight is not reachable
+ */
+double exact_threshold(unsigned int n, unsigned int w, unsigned int t, unsigned int syndrome_weight)
+{
+    double length = 2.0 * n;
+    double row_weight = 2.0 * w;
+    double S = syndrome_weight;
+
+    // rho_l : probability that a parity check contains l errors, only odd l give an unsatisfied check
+    double sum_odd = 0, sum_odd_weighted = 0;
+    double log_total = lgamma(length + 1) - lgamma(t + 1) - lgamma(length - t + 1);
+    for (unsigned int l = 1; l <= t && l <= row_weight; l += 2)
+    {
+        double log_rho = lgamma(row_weight + 1) - lgamma(l + 1) - lgamma(row_weight - l + 1) + lgamma(length - row_weight + 1) - lgamma(t - l + 1) - lgamma(length - row_weight - t + l + 1) - log_total;
+        sum_odd += exp(log_rho);
+        sum_odd_weighted += (l - 1) * exp(log_rho);
+    }
+    double X = S * sum_odd_weighted / sum_odd;
+    double pi1 = (S + X) / (t * w);
+    double pi0 = ((row_weight - 1) * S - X) / ((length - t) * w);
+
+    if (pi0 <= 0 || pi1 <= 0 || pi0 >= 1 || pi1 >= 1 || pi1 <= pi0)
+        return NAN;
+    return (log((length - t) / t) + w * log((1 - pi0) / (1 - pi1))) / (log(pi1 / pi0) + log((1 - pi0) / (1 - pi1)));
+}
+
+/**
+ * Parameters of the Black-Gray-Flip decoder.
+ * BIKE sizes use the constants of the specification, other sizes get an affine function
+ * fitted (least squares) on the exact threshold.
+ *
+ * @param n size of each block
+ * @param w weight of each column
+ * @param t weight of the whole error
+ * @return the parameters
+ */
+bgf_parameters init_bgf_parameters(unsigned int n, unsigned int w, unsigned int t)
+{
+    bgf_parameters parameters;
+    parameters.threshold_min = (w + 1) / 2;
+    parameters.masked_threshold = (w + 1) / 2 + 1;
+    parameters.gray_gap = 3;
+    parameters.nb_iterations = 5;
+
+    if (n == 12323 && w == 71)
+    {
+        parameters.threshold_slope = 0.0069722;
+        parameters.threshold_intercept = 13.530;
+        return parameters;
+    }
+    if (n == 24659 && w == 103)
+    {
+        parameters.threshold_slope = 0.005265;
+        parameters.threshold_intercept = 15.2588;
+        return parameters;
+    }
+    if (n == 40973 && w == 137)
+    {
+        parameters.threshold_slope = 0.00402312;
+        parameters.threshold_intercept = 17.8785;
+        return parameters;
+    }
+
+    // Least squares on the syndrome weights an iteration can meet
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    int nb_points = 0;
+    for (unsigned int k = 1; k <= 64; k++)
+    {
+        unsigned int syndrome_weight = k * t * w / 64;
+        double threshold = exact_threshold(n, w, t, syndrome_weight);
+        if (isnan(threshold))
+            continue;
+        threshold = ceil(threshold);
+        sum_x += syndrome_weight;
+        sum_y += threshold;
+        sum_xx += (double)syndrome_weight * syndrome_weight;
+        sum_xy += syndrome_weight * threshold;
+        nb_points++;
+    }
+    double denominator = nb_points * sum_xx - sum_x * sum_x;
+    if (nb_points < 2 || denominator == 0)
+    {
+        parameters.threshold_slope = 0;
+        parameters.threshold_intercept = parameters.threshold_min;
+        return parameters;
+    }
+    parameters.threshold_slope = (nb_points * sum_xy - sum_x * sum_y) / denominator;
+    // + 0.5 so that the floor in bgf_threshold rounds to the closest integer
+    parameters.threshold_intercept = (sum_y - parameters.threshold_slope * sum_x) / nb_points + 0.5;
+    return parameters;
+}
+
+/**
+ * Affine threshold of the Black-Gray-Flip decoder.
+ *
+ * @param parameters parameters of the decoder
+ * @param syndrome_weight weight of the current syndrome
+ * @return the threshold
+ */
+int bgf_threshold(bgf_parameters parameters, unsigned int syndrome_weight)
+{
+    int threshold = (int)floor(parameters.threshold_slope * syndrome_weight + parameters.threshold_intercept);
+    return threshold > parameters.threshold_min ? threshold : parameters.threshold_min;
+}
+
+/**
+ * Flip every position of the list whose counter reaches the threshold.
+ * The positions are selected first then flipped, as all counters are read before any flip.
+ *
+ * @param context decoder
+ * @param positions positions to check (overwritten)
+ * @param nb_positions number of positions
+ * @param threshold minimal counter to flip
+ */
+static void masked_flip(decoder_context *context, unsigned int *positions, unsigned int nb_positions, int threshold)
+{
+    unsigned int nb_selected = 0;
+    for (unsigned int k = 0; k < nb_positions; k++)
+    {
+        if (context->counters[positions[k]] >= threshold)
+        {
+            positions[nb_selected] = positions[k];
+            nb_selected++;
+        }
+    }
+    for (unsigned int k = 0; k < nb_selected; k++)
+        flip_position(context, positions[k]);
+}
+
+/**
+ * Black-Gray-Flip decoder.
+ * https://eprint.iacr.org/2019/1423.pdf
+ * Each iteration uses a threshold computed from the syndrome weight.
+ * The flipped positions are black, the positions close to the threshold are gray ;
+ * after the first iteration both are checked again with a lower threshold.
+ *
+ * @param context decoder with a loaded syndrome
+ * @param parameters parameters of the decoder
+ * @return 1 if the error has been decoded, 0 else
+ */
+int black_gray_flip(decoder_context *context, bgf_parameters parameters)
+{
+    for (int i = 0; i < parameters.nb_iterations && context->syndrome_weight != 0; i++)
+    {
+        profiler_timer iteration = start_timer(context->profiler, PHASE_DECODER_ITERATION);
+        int threshold = bgf_threshold(parameters, context->syndrome_weight);
+        unsigned int nb_black = 0;
+        unsigned int nb_gray = 0;
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+        {
+            if (context->counters[j] >= threshold)
+            {
+                context->flipped[nb_black] = j;
+                nb_black++;
+            }
+            else if (context->counters[j] >= threshold - parameters.gray_gap)
+            {
+                context->gray[nb_gray] = j;
+                nb_gray++;
+            }
+        }
+        for (unsigned int k = 0; k < nb_black; k++)
+            flip_position(context, context->flipped[k]);
+
+        if (i == 0)
+        {
+            masked_flip(context, context->flipped, nb_black, parameters.masked_threshold);
+            masked_flip(context, context->gray, nb_gray, parameters.masked_threshold);
+        }
+        context->nb_iterations++;
+        stop_timer(iteration);
+    }
+
+    clear_touched(context);
+    return context->syndrome_weight == 0;
+}
+
+/**
+ * Parameters of the Backflip decoder.
+ * Time to live of https://eprint.iacr.org/2019/1434.pdf, thresholds of Black-Gray-Flip.
+ *
+ * @param n size of each block
+ * @param w weight of each column
+ * @param t weight of the whole error
+ * @return the parameters
+ */
+backflip_parameters init_backflip_parameters(unsigned int n, unsigned int w, unsigned int t)
+{
+    backflip_parameters parameters;
+    parameters.threshold = init_bgf_parameters(n, w, t);
+    parameters.ttl_slope = 0.45;
+    parameters.ttl_intercept = 1.1;
+    parameters.ttl_max = 5;
+    parameters.nb_iterations = 10;
+    return parameters;
+}
+
+/**
+ * Number of iterations before a flipped position is flipped back.
+ * The further the counter was above the threshold, the longer the flip lives.
+ *
+ * @param parameters parameters of the decoder
+ * @param delta counter minus threshold when the position was flipped
+ * @return the time to live
+ */
+int time_to_live(backflip_parameters parameters, int delta)
+{
+    int ttl = (int)floor(parameters.ttl_slope * delta + parameters.ttl_intercept);
+    if (ttl > parameters.ttl_max)
+        ttl = parameters.ttl_max;
+    return ttl < 1 ? 1 : ttl;
+}
+
+/**
+ * Backflip decoder.
+ * https://eprint.iacr.org/2019/1434.pdf
+ * Each position flipped to 1 gets a time to live, when it expires (at the end of an iteration)
+ * the position is flipped back so that wrong early decisions are undone.
+ *
+ * @param context decoder with a loaded syndrome
+ * @param parameters parameters of the decoder
+ * @return 1 if the error has been decoded, 0 else
+ */
+int backflip(decoder_context *context, backflip_parameters parameters)
+{
+    for (int i = 1; i <= parameters.nb_iterations && context->syndrome_weight != 0; i++)
+    {
+        profiler_timer iteration = start_timer(context->profiler, PHASE_DECODER_ITERATION);
+        // Lowered to the biggest counter when nothing reaches it, so that every iteration makes progress
+        int threshold = bgf_threshold(parameters.threshold, context->syndrome_weight);
+        int max_counter = 0;
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+            max_counter = context->counters[j] > max_counter ? context->counters[j] : max_counter;
+        if (max_counter < threshold && max_counter >= parameters.threshold.threshold_min)
+            threshold = max_counter;
+
+        unsigned int nb_flipped = 0;
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+        {
+            if (context->counters[j] >= threshold)
+            {
+                context->flipped[nb_flipped] = j;
+                nb_flipped++;
+            }
+        }
+        for (unsigned int k = 0; k < nb_flipped; k++)
+        {
+            unsigned int j = context->flipped[k];
+            // A new position lives for a while, an undone position is forgotten
+            if (get_error_bit(context, j))
+                context->death_time[j] = 0;
+            else
+                context->death_time[j] = i + time_to_live(parameters, context->counters[j] - threshold);
+            flip_position(context, j);
+        }
+        context->nb_iterations++;
+        if (context->syndrome_weight == 0)
+        {
+            stop_timer(iteration);
+            break;
+        }
+
+        // Flip back the positions whose time to live expired
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+        {
+            if (context->death_time[j] == i)
+            {
+                context->death_time[j] = 0;
+                flip_position(context, j);
+            }
+        }
+        stop_timer(iteration);
+    }
+
+    clear_touched(context);
+    return context->syndrome_weight == 0;
+}
\ No newline at end of file
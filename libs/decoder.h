@@ -0,0 +1,151 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "polynome.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "../libs_optimized/bitslice.h"
+
+#define BITFLIP_MAX_ITERATIONS 100
+
+/**
+ * How the fixed threshold bit flipping algorithm counts the unsatisfied parity checks
+ */
+typedef enum
+{
+    DENSE_COUNTERS,       /** every counter recomputed at each iteration */
+    BITSLICED_COUNTERS,   /** bit-sliced vertical counters (dense counters if H is not quasi-cyclic with a shift prime to n) */
+    INCREMENTAL_COUNTERS, /** counters updated when a bit is flipped */
+    CONVOLUTION_COUNTERS  /** every counter recomputed as a convolution of the syndrome (quasi-cyclic keys) */
+} counter_engine;
+
+/**
+ * Decoders available at runtime
+ */
+typedef enum
+{
+    DECODER_BITFLIP,     /** fixed threshold, DENSE_COUNTERS */
+    DECODER_BITSLICED,   /** fixed threshold, BITSLICED_COUNTERS */
+    DECODER_INCREMENTAL, /** fixed threshold, INCREMENTAL_COUNTERS */
+    DECODER_BGF,         /** Black-Gray-Flip */
+    DECODER_BACKFLIP,    /** Backflip */
+    DECODER_CONVOLUTION  /** fixed threshold, CONVOLUTION_COUNTERS */
+} decoder_type;
+
+/**
+ * Parameters of the Black-Gray-Flip decoder.
+ * The threshold is max(floor(threshold_slope * |s| + threshold_intercept), threshold_min).
+ */
+typedef struct
+{
+    double threshold_slope;     /**< slope of the affine threshold */
+    double threshold_intercept; /**< intercept of the affine threshold */
+    int threshold_min;          /**< smallest threshold, (w + 1) / 2 */
+    int masked_threshold;       /**< threshold of the black and gray iterations, (w + 1) / 2 + 1 */
+    int gray_gap;               /**< a position is gray if its counter is at least threshold - gray_gap */
+    int nb_iterations;          /**< fixed number of iterations */
+} bgf_parameters;
+
+/**
+ * Parameters of the Backflip decoder.
+ * A position flipped with a counter T + delta is flipped back after
+ * max(1, min(ttl_max, floor(ttl_slope * delta + ttl_intercept))) iterations.
+ */
+typedef struct
+{
+    bgf_parameters threshold; /**< threshold of each iteration, same as Black-Gray-Flip */
+    double ttl_slope;         /**< slope of the time to live */
+    double ttl_intercept;     /**< intercept of the time to live */
+    int ttl_max;              /**< biggest time to live */
+    int nb_iterations;        /**< maximal number of iterations */
+} backflip_parameters;
+
+/**
+ * Decoder of one private key.
+ * Everything is allocated once by init_decoder_context and reused by every decoding :
+ * the parity check matrix H = [h0 | h1] is only kept as the supports of its rows and columns,
+ * the syndrome and the counters are updated each time a bit is flipped.
+ */
+typedef struct
+{
+    // Built once per key
+    polynome *columns;               /**< support of each column of the parity check matrix */
+    polynome *rows;                  /**< support of each row of the parity check matrix */
+    unsigned int nb_rows;            /**< number of parity checks */
+    unsigned int nb_columns;         /**< size of the error */
+    bgf_parameters bgf;              /**< parameters of Black-Gray-Flip */
+    backflip_parameters backflip;    /**< parameters of Backflip */
+    int shift;                       /**< row i is row 0 shifted by -i * shift, -1 if H is not quasi-cyclic */
+    polynome first_rows[2];          /**< support of row 0 in h0 and in h1 (indices < nb_rows) */
+    // Reused by every decoding
+    uint64_t *syndrome;              /**< current syndrome (packed) */
+    unsigned int syndrome_weight;    /**< hamming weight of the current syndrome */
+    uint64_t *error;                 /**< current error (packed) */
+    unsigned int error_weights[2];   /**< hamming weight of each half of the error */
+    int *counters;                   /**< unsatisfied parity checks of each position */
+    unsigned int *touched;           /**< positions whose counter changed since the last selection */
+    unsigned char *is_touched;       /**< 1 if the position is already in touched */
+    unsigned int nb_touched;         /**< size of the array touched */
+    unsigned int *flipped;           /**< positions selected by the last selection */
+    unsigned int *gray;              /**< positions close to the threshold (Black-Gray-Flip) */
+    int *death_time;                 /**< iteration where a flipped position is flipped back, 0 if none (Backflip) */
+    bitsliced_counters sliced;       /**< counters of BITSLICED_COUNTERS, each half starts on a word */
+    uint64_t *sliced_buffer;         /**< rotations of the syndrome added to the counters of BITSLICED_COUNTERS */
+    uint64_t *doubled_syndrome;      /**< doubled copy of the packed permuted syndrome for BITSLICED_COUNTERS */
+    uint64_t *flip_mask;             /**< positions reaching the threshold with BITSLICED_COUNTERS */
+    int *permuted_syndrome;          /**< syndrome reordered by the shift for CONVOLUTION_COUNTERS */
+    struct lanes_decoder *lanes;     /**< decoder of NB_LANES cyphers at once, NULL until build_lanes_decoder */
+    phase_profiler *profiler;        /**< phases of the decodings, NULL if not profiled (owned by the caller) */
+    perf_counters *perf;             /**< hardware counters of the decodings, NULL if not measured (owned by the caller) */
+    unsigned int nb_iterations;      /**< iterations done by the last decoding */
+} decoder_context;
+
+// Creation and Destruction of the decoder
+
+decoder_context init_decoder_context(bit **h0, bit **h1, unsigned int n, unsigned int t);
+decoder_context init_decoder_context_from_rows(polynome *rows, unsigned int n, unsigned int t);
+decoder_context init_decoder_context_from_support(polynome h0_support, polynome h1_support, unsigned int n, unsigned int shift, unsigned int t);
+int is_coprime_shift(unsigned int shift, unsigned int n);
+void free_decoder_context(decoder_context context);
+size_t decoder_context_bytes(decoder_context context);
+
+// Operations on the decoder
+
+void load_syndrome(decoder_context *context, bit **syndrome);
+void load_cypher(decoder_context *context, bit **c);
+void load_packed_cypher(decoder_context *context, uint64_t *c);
+void load_error(decoder_context *context, polynome e0, polynome e1);
+void compute_counters(decoder_context *context);
+void compute_convolution_counters(decoder_context *context);
+void flip_position(decoder_context *context, unsigned int position);
+unsigned int select_flipped_positions(decoder_context *context, int threshold);
+unsigned int get_error_bit(decoder_context *context, unsigned int position);
+int is_error_found(decoder_context *context, polynome e0, polynome e1);
+void store_error(decoder_context *context, bit **e0_output, bit **e1_output);
+void store_packed_error(decoder_context *context, uint64_t *error);
+
+// Decoders
+
+int fixed_threshold_bitflip(decoder_context *context, int threshold, unsigned int weight, counter_engine engine);
+int decode_syndrome(decoder_context *context, decoder_type decoder, int threshold, unsigned int weight);
+int decode_cypher(decoder_context *context, decoder_type decoder, bit **c, int threshold, unsigned int weight, bit **e0_output, bit **e1_output);
+decoder_type parse_decoder(const char *name);
+const char *decoder_name(decoder_type decoder);
+
+// Black-Gray-Flip
+
+double exact_threshold(unsigned int n, unsigned int w, unsigned int t, unsigned int syndrome_weight);
+bgf_parameters init_bgf_parameters(unsigned int n, unsigned int w, unsigned int t);
+int bgf_threshold(bgf_parameters parameters, unsigned int syndrome_weight);
+int black_gray_flip(decoder_context *context, bgf_parameters parameters);
+
+// Backflip
+
+backflip_parameters init_backflip_parameters(unsigned int n, unsigned int w, unsigned int t);
+int time_to_live(backflip_parameters parameters, int delta);
+int backflip(decoder_context *context, backflip_parameters parameters);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "drbg.h"
+
+/**
+ * Step of splitmix64, used to spread the seed over the state of the generator.
+ *
+ * @param x state of splitmix64, updated
+ * @return next value
+ */
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotate_left(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Initialize a generator.
+ * Two generators with the same seed and different streams give independent sequences,
+ * so a run can be replayed from its seed whatever the number of threads.
+ *
+ * @param seed seed of the whole run
+ * @param stream index of the stream (thread, key...)
+ * @return the generator
+ */
+drbg init_drbg(uint64_t seed, uint64_t stream)
+{
+    drbg generator;
+    uint64_t x = seed ^ splitmix64(&stream);
+    for (int i = 0; i < 4; i++)
+        generator.state[i] = splitmix64(&x);
+    return generator;
+}
+
+/**
+ * Next 64 random bits.
+ *
+ * @param generator generator to update
+ * @return random word
+ */
+uint64_t random_drbg(drbg *generator)
+{
+    uint64_t *s = generator->state;
+    uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotate_left(s[3], 45);
+    return result;
+}
+
+/**
+ * Uniform integer in [0, bound[, without the bias of a modulo (Lemire's method).
+ *
+ * @param generator generator to update
+ * @param bound exclusive upper bound, not null
+ * @return random integer
+ */
+uint32_t uniform_drbg(drbg *generator, uint32_t bound)
+{
+    uint64_t product = (random_drbg(generator) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound)
+    {
+        uint32_t rejection = -bound % bound;
+        while (low < rejection)
+        {
+            product = (random_drbg(generator) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
+}
+
+/**
+ * Integer in [0, bound[ without rejection, so in constant time.
+ * The bias is at most bound / 2^64.
+ *
+ * @param generator generator to update
+ * @param bound exclusive upper bound, not null
+ * @return random integer
+ */
+static uint32_t uniform_constant_time(drbg *generator, uint32_t bound)
+{
+    return (uint32_t)(((unsigned __int128)random_drbg(generator) * bound) >> 64);
+}
+
+/**
+ * Exchange two indices if they are not in increasing order, without branch.
+ */
+static void compare_exchange(int *a, int *b)
+{
+    uint32_t x = *a, y = *b;
+    // All ones if y < x (the indices are < 2^31)
+    uint32_t swap = -(((y - x) >> 31) & 1);
+    uint32_t difference = (x ^ y) & swap;
+    *a = x ^ difference;
+    *b = y ^ difference;
+}
+
+/**
+ * Uniform support of a given weight : weight distinct indices in [0, n[, sorted.
+ * Constant time : the random draws, the memory accesses and the branches do not depend
+ * on the indices drawn, and there is no pass over the n positions.
+ *
+ * The indices are drawn as in the sampler of BIKE (Sendrier) : for i from weight - 1 to 0,
+ * an index l is drawn in [i, n[ and replaced by i if it was already drawn, which gives
+ * every support of the given weight with the same probability. They are then sorted
+ * with an odd-even transposition network.
+ *
+ * @param generator generator to update
+ * @param support result, array of weight indices
+ * @param weight number of indices, at most n
+ * @param n size of the vector, < 2^31
+ */
+void sample_support(drbg *generator, int *support, unsigned int weight, unsigned int n)
+{
+    for (int i = weight - 1; i >= 0; i--)
+    {
+        uint32_t index = i + uniform_constant_time(generator, n - i);
+        uint32_t is_drawn = 0;
+        for (unsigned int k = i + 1; k < weight; k++)
+            is_drawn |= (uint32_t)((((uint64_t)(index ^ (uint32_t)support[k])) - 1) >> 63);
+        support[i] = index ^ ((index ^ (uint32_t)i) & -is_drawn);
+    }
+
+    for (unsigned int round = 0; round < weight; round++)
+    {
+        for (unsigned int k = round % 2; k + 1 < weight; k += 2)
+            compare_exchange(&support[k], &support[k + 1]);
+    }
+}
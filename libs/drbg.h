@@ -0,0 +1,25 @@
+#ifndef DRBG_H
+#define DRBG_H
+
+#include <stdint.h>
+
+/**
+ * Deterministic random bit generator (xoshiro256**).
+ * Each thread owns its generator, so no state is shared between threads as with rand().
+ */
+typedef struct
+{
+    uint64_t state[4]; /** internal state, never all zero */
+} drbg;
+
+// Creation of a generator
+
+drbg init_drbg(uint64_t seed, uint64_t stream);
+
+// Random values, sample_support is in constant time
+
+uint64_t random_drbg(drbg *generator);
+uint32_t uniform_drbg(drbg *generator, uint32_t bound);
+void sample_support(drbg *generator, int *support, unsigned int weight, unsigned int n);
+
+#endif
\ No newline at end of file
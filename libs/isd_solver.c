@@ -0,0 +1,89 @@
+#include "isd_solver.h"
+#include "matrix_view.h"
+
+/**
+ * Information set decoding with the Prange algorithm.
+ * Each iteration draws n - k columns of H : if the square matrix H' they form is invertible,
+ * e' = H'^-1 * s is the only error on these columns with the syndrome s, and the search stops
+ * when e' has the weight t. The columns are drawn with a drbg owned by the caller,
+ * so that the solver keeps no state between two calls and can run in parallel.
+ * The matrix operations are those of matrix_backend.h, on the backend of H.
+ * H is transposed once : the columns drawn are then rows of H^T, taken by pointer, and the
+ * inversion of H'^T gives (H'^-1)^T, so that e' is the product of its transposed view and s.
+ */
+
+/**
+ * Prange algorithm, with the phases and the hardware counters of each step.
+ *
+ * @param generator random generator
+ * @param H parity check matrix, (n - k) x n
+ * @param s syndrome, (n - k) x 1, in the backend of H
+ * @param t weight of the error
+ * @param max_iterations number of columns draws before giving up, 0 for no limit
+ * @param e result, error n x 1 (allocated by the caller, any backend)
+ * @param profiler phases of each iteration, NULL if not profiled
+ * @param counters hardware counters of each iteration, NULL if not measured
+ * @return 1 if an error of weight t has been found, 0 else
+ */
+int isd_solve(drbg *generator, backend_matrix H, backend_matrix s, unsigned int t, unsigned long max_iterations, backend_matrix e, phase_profiler *profiler, perf_counters *counters)
+{
+    unsigned int nb_rows = H.nb_rows;
+    int *columns = (int *)malloc(sizeof(int) * nb_rows);
+    // Bits processed : the (n - k) x (n - k) matrices
+    uint64_t nb_bits = (uint64_t)nb_rows * nb_rows;
+    int is_found = 0;
+    backend_matrix H_transposed = transpose_backend_matrix(H);
+    // H'^T points to the rows of H^T, it is never freed row by row
+    backend_matrix H_prime_transposed = {H.backend, (void **)malloc(sizeof(void *) * nb_rows), nb_rows, nb_rows};
+    // Scratch of the products by the transposed inverse, which has the shape of H'^T, shared by the iterations
+    matrix_view inverse_shape = whole_view(H_prime_transposed);
+    backend_workspace workspace = init_view_workspace(transposed_view(&inverse_shape), H.backend, s.nb_columns);
+
+    for (unsigned long iteration = 0; !is_found && (max_iterations == 0 || iteration < max_iterations); iteration++)
+    {
+        profiler_timer timer = start_timer(profiler, PHASE_ISD_SAMPLE);
+        perf_measure measure = start_perf_measure(counters, SITE_ISD_SAMPLE);
+        sample_support(generator, columns, nb_rows, H.nb_columns);
+        for (unsigned int i = 0; i < nb_rows; i++)
+            H_prime_transposed.rows[i] = H_transposed.rows[columns[i]];
+        stop_perf_measure(measure, nb_bits);
+        stop_timer(timer);
+
+        int is_invertible;
+        timer = start_timer(profiler, PHASE_ISD_INVERT);
+        measure = start_perf_measure(counters, SITE_ISD_INVERSION);
+        // (H'^T)^-1 = (H'^-1)^T
+        backend_matrix inversion_H_prime_transposed = inversion_backend_matrix(H_prime_transposed, &is_invertible);
+        stop_perf_measure(measure, nb_bits);
+        stop_timer(timer);
+        if (is_invertible)
+        {
+            // H'^-1, read through a view instead of a transposed copy
+            matrix_view inverse = whole_view(inversion_H_prime_transposed);
+            matrix_view inverse_transposed = transposed_view(&inverse);
+            // Only the weight of e' is needed until it is the right one
+            timer = start_timer(profiler, PHASE_ISD_CHECK);
+            measure = start_perf_measure(counters, SITE_ISD_MULTIPLICATION);
+            is_found = syndrome_weight_view_matrix(inverse_transposed, s, workspace) == t;
+            stop_perf_measure(measure, nb_bits);
+            stop_timer(timer);
+            if (is_found)
+            {
+                backend_matrix e_prime = init_backend_matrix(H.backend, nb_rows, 1);
+                multiply_add_view_matrix(e_prime, inverse_transposed, s, workspace);
+                for (unsigned int j = 0; j < e.nb_rows; j++)
+                    set_backend_bit(e, j, 0, 0);
+                for (unsigned int i = 0; i < nb_rows; i++)
+                    set_backend_bit(e, columns[i], 0, get_backend_bit(e_prime, i, 0));
+                free_backend_matrix(e_prime);
+            }
+        }
+        free_backend_matrix(inversion_H_prime_transposed);
+    }
+
+    free(columns);
+    free(H_prime_transposed.rows);
+    free_backend_matrix(H_transposed);
+    free_backend_workspace(workspace);
+    return is_found;
+}
@@ -0,0 +1,13 @@
+#ifndef ISD_SOLVER_H
+#define ISD_SOLVER_H
+
+#include "matrix_backend.h"
+#include "drbg.h"
+#include "profiler.h"
+#include "perf_counters.h"
+
+// Prange algorithm : find e of weight t with H * e = s, H being (n - k) x n
+
+int isd_solve(drbg *generator, backend_matrix H, backend_matrix s, unsigned int t, unsigned long max_iterations, backend_matrix e, phase_profiler *profiler, perf_counters *counters);
+
+#endif
\ No newline at end of file
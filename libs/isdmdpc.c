@@ -0,0 +1,514 @@
+#include "isdmdpc.h"
+#include "decoder.h"
+#include "isd_solver.h"
+#include "kem.h"
+#include "key_pool.h"
+#include "serialization.h"
+
+/**
+ * Public API of the library over kem.c, key_pool.c, serialization.c and isd_solver.c.
+ * The structures of the handles are only known here, so they can change without breaking
+ * the programs linked with the library.
+ */
+
+// Decoders of the library, in the order of isdmdpc_decoder
+static const decoder_type decoders[] = {DECODER_BITFLIP, DECODER_BITSLICED, DECODER_INCREMENTAL, DECODER_BGF, DECODER_BACKFLIP, DECODER_CONVOLUTION};
+
+struct isdmdpc_context
+{
+    isdmdpc_parameters parameters; /** sizes of the keys */
+    drbg generator;                /** random generator of the keys, errors and ISD */
+    phase_profiler *profiler;      /** phases of the decodings and ISD, NULL if not profiled */
+    perf_counters *counters;       /** hardware counters of the decodings and ISD, NULL if not measured */
+};
+
+struct isdmdpc_public_key
+{
+    expanded_public_key key; /** packed first column of the public key */
+};
+
+struct isdmdpc_private_key
+{
+    decoder_context context; /** decoder of the private key, holds the buffers of the decoding */
+};
+
+struct isdmdpc_matrix
+{
+    backend_matrix matrix; /** rows in the storage of the chosen backend */
+};
+
+struct isdmdpc_key_pool
+{
+    key_pool *pool; /** queue and producers of the key pairs */
+};
+
+int isdmdpc_api_version(void)
+{
+    return ISDMDPC_API_VERSION;
+}
+
+/**
+ * Create a context.
+ *
+ * @param parameters sizes of the keys and decoder
+ * @param seed seed of the random generator
+ * @param stream stream of the random generator, to give each context its own sequence
+ * @return the context, NULL if the parameters are invalid
+ */
+isdmdpc_context *isdmdpc_init_context(isdmdpc_parameters parameters, uint64_t seed, uint64_t stream)
+{
+    if (parameters.n < 2 || parameters.w == 0 || parameters.w > parameters.n || parameters.t / 2 > parameters.n)
+        return NULL;
+    if ((unsigned int)parameters.decoder >= sizeof(decoders) / sizeof(decoders[0]))
+        return NULL;
+    isdmdpc_context *context = (isdmdpc_context *)malloc(sizeof(isdmdpc_context));
+    context->parameters = parameters;
+    context->generator = init_drbg(seed, stream);
+    context->profiler = NULL;
+    context->counters = NULL;
+    return context;
+}
+
+void isdmdpc_free_context(isdmdpc_context *context)
+{
+    if (context->profiler != NULL)
+        free_profiler(context->profiler);
+    if (context->counters != NULL)
+        free_perf_counters(context->counters);
+    free(context);
+}
+
+isdmdpc_parameters isdmdpc_get_parameters(const isdmdpc_context *context)
+{
+    return context->parameters;
+}
+
+size_t isdmdpc_private_key_bytes(const isdmdpc_context *context)
+{
+    return PRIVATE_KEY_BYTES(context->parameters.w);
+}
+
+size_t isdmdpc_public_key_bytes(const isdmdpc_context *context)
+{
+    return PACKED_POLYNOMIAL_BYTES(context->parameters.n);
+}
+
+size_t isdmdpc_cypher_bytes(const isdmdpc_context *context)
+{
+    return PACKED_POLYNOMIAL_BYTES(context->parameters.n);
+}
+
+// The error (e0 | e1) is a packed polynomial of 2 n coefficients
+size_t isdmdpc_error_bytes(const isdmdpc_context *context)
+{
+    return PACKED_POLYNOMIAL_BYTES(2 * context->parameters.n);
+}
+
+/**
+ * Time the phases of the decodings and ISD done with a context.
+ *
+ * @param context context to profile
+ * @return 1
+ */
+int isdmdpc_enable_profiler(isdmdpc_context *context)
+{
+    if (context->profiler == NULL)
+        context->profiler = init_profiler();
+    return 1;
+}
+
+/**
+ * Count the hardware events of the decodings and ISD done with a context.
+ * The counters measure the calling thread, which must be the one using the context.
+ *
+ * @param context context to measure
+ * @return 1, 0 if no hardware counter is available
+ */
+int isdmdpc_enable_perf_counters(isdmdpc_context *context)
+{
+    if (context->counters == NULL)
+        context->counters = init_perf_counters();
+    if (nb_perf_events_available(context->counters) > 0)
+        return 1;
+    free_perf_counters(context->counters);
+    context->counters = NULL;
+    return 0;
+}
+
+/**
+ * Write the phases timed with a context in JSON (see write_profiler_report).
+ *
+ * @param context context profiled
+ * @param output file to write in
+ * @return 1, 0 if the profiler is not enabled
+ */
+int isdmdpc_write_profiler_report(const isdmdpc_context *context, FILE *output)
+{
+    if (context->profiler == NULL)
+        return 0;
+    write_profiler_report(context->profiler, output);
+    return 1;
+}
+
+/**
+ * Write the hardware events counted with a context in JSON (see write_perf_report).
+ *
+ * @param context context measured
+ * @param output file to write in
+ * @return 1, 0 if the hardware counters are not enabled
+ */
+int isdmdpc_write_perf_report(const isdmdpc_context *context, FILE *output)
+{
+    if (context->counters == NULL)
+        return 0;
+    write_perf_report(context->counters, output);
+    return 1;
+}
+
+/**
+ * Generate a key pair.
+ *
+ * @param context context of the keys
+ * @param private_key result, isdmdpc_private_key_bytes bytes
+ * @param public_key result, isdmdpc_public_key_bytes bytes
+ * @return 1
+ */
+int isdmdpc_keygen(isdmdpc_context *context, uint8_t *private_key, uint8_t *public_key)
+{
+    key_pair keys;
+    keys.n = context->parameters.n;
+    keys.w = context->parameters.w;
+    keys.private_key = private_key;
+    keys.public_key = public_key;
+    generate_key_pair(&context->generator, keys);
+    return 1;
+}
+
+/**
+ * Read and expand a public key.
+ *
+ * @param context context of the key
+ * @param buffer public key written by isdmdpc_keygen
+ * @param size size of the buffer
+ * @return the expanded key, NULL if the buffer is not a public key of the context
+ */
+isdmdpc_public_key *isdmdpc_load_public_key(const isdmdpc_context *context, const uint8_t *buffer, size_t size)
+{
+    packed_polynomial_view view;
+    if (!read_packed_polynomial(buffer, size, &view) || view.n != context->parameters.n)
+        return NULL;
+
+    uint64_t *first_line = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(view.n));
+    unpack_polynomial(view, first_line);
+    isdmdpc_public_key *key = (isdmdpc_public_key *)malloc(sizeof(isdmdpc_public_key));
+    key->key = expand_circulant_public_key(first_line, view.n);
+    free(first_line);
+    return key;
+}
+
+void isdmdpc_free_public_key(isdmdpc_public_key *key)
+{
+    if (key == NULL)
+        return;
+    free_expanded_public_key(key->key);
+    free(key);
+}
+
+/**
+ * Read a private key and build its decoder.
+ *
+ * @param context context of the key
+ * @param buffer private key written by isdmdpc_keygen
+ * @param size size of the buffer
+ * @return the decoder, NULL if the buffer is not a private key of the context
+ */
+isdmdpc_private_key *isdmdpc_load_private_key(const isdmdpc_context *context, const uint8_t *buffer, size_t size)
+{
+    private_key_view view;
+    if (!read_private_key(buffer, size, &view) || view.n != context->parameters.n || view.w != context->parameters.w)
+        return NULL;
+
+    isdmdpc_private_key *key = (isdmdpc_private_key *)malloc(sizeof(isdmdpc_private_key));
+    key->context = init_decoder_context_from_private_key(view, context->parameters.t);
+    return key;
+}
+
+void isdmdpc_free_private_key(isdmdpc_private_key *key)
+{
+    if (key == NULL)
+        return;
+    free_decoder_context(key->context);
+    free(key);
+}
+
+/**
+ * Start a pool of key pairs, see init_key_pool.
+ * The context only gives the sizes of the keys and can be freed before the pool.
+ *
+ * @param context context of the keys
+ * @param depth maximal number of ready key pairs
+ * @param watermark the producers start again at this number of ready key pairs, < depth
+ * @param nb_producers number of producer threads
+ * @param seed seed of the key pairs, key pair k of the producers uses the stream k
+ * @return the pool
+ */
+isdmdpc_key_pool *isdmdpc_init_key_pool(const isdmdpc_context *context, unsigned int depth, unsigned int watermark, unsigned int nb_producers, uint64_t seed)
+{
+    isdmdpc_key_pool *pool = (isdmdpc_key_pool *)malloc(sizeof(isdmdpc_key_pool));
+    pool->pool = init_key_pool(context->parameters.n, context->parameters.w, depth, watermark, nb_producers, seed);
+    return pool;
+}
+
+void isdmdpc_free_key_pool(isdmdpc_key_pool *pool)
+{
+    if (pool == NULL)
+        return;
+    free_key_pool(pool->pool);
+    free(pool);
+}
+
+/**
+ * Take a key pair of the pool, generated inline if none is ready.
+ * Can be called by several threads at once.
+ *
+ * @param pool pool
+ * @param private_key result, isdmdpc_private_key_bytes bytes
+ * @param public_key result, isdmdpc_public_key_bytes bytes
+ * @return 1
+ */
+int isdmdpc_pop_key_pair(isdmdpc_key_pool *pool, uint8_t *private_key, uint8_t *public_key)
+{
+    key_pair keys = key_pool_pop(pool->pool);
+    memcpy(private_key, keys.private_key, PRIVATE_KEY_BYTES(keys.w));
+    memcpy(public_key, keys.public_key, PACKED_POLYNOMIAL_BYTES(keys.n));
+    free_key_pair(keys);
+    return 1;
+}
+
+isdmdpc_key_pool_statistics isdmdpc_get_key_pool_statistics(isdmdpc_key_pool *pool)
+{
+    isdmdpc_key_pool_statistics statistics;
+    statistics.hits = atomic_load(&pool->pool->statistics.hits);
+    statistics.misses = atomic_load(&pool->pool->statistics.misses);
+    statistics.produced = atomic_load(&pool->pool->statistics.produced);
+    statistics.nb_ready = key_pool_size(pool->pool);
+    return statistics;
+}
+
+/**
+ * Draw an error of weight t / 2 on each part and cypher it.
+ *
+ * @param context context of the key, its generator draws the error
+ * @param key public key loaded by isdmdpc_load_public_key
+ * @param cypher result, isdmdpc_cypher_bytes bytes
+ * @param error result, the error (e0 | e1) in isdmdpc_error_bytes bytes
+ * @return 1
+ */
+int isdmdpc_encapsulate(isdmdpc_context *context, const isdmdpc_public_key *key, uint8_t *cypher, uint8_t *error)
+{
+    unsigned int n = context->parameters.n;
+    polynome e0, e1;
+    e0.size = context->parameters.t / 2;
+    e1.size = context->parameters.t / 2;
+    e0.liste_indice = (int *)malloc(sizeof(int) * e0.size);
+    e1.liste_indice = (int *)malloc(sizeof(int) * e1.size);
+    sample_support(&context->generator, e0.liste_indice, e0.size, n);
+    sample_support(&context->generator, e1.liste_indice, e1.size, n);
+
+    uint64_t *c = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    encapsulate(key->key, e0, e1, c);
+    write_packed_polynomial(c, n, cypher);
+
+    uint64_t *packed_error = (uint64_t *)calloc(NB_WORDS(2 * n), sizeof(uint64_t));
+    for (int k = 0; k < e0.size + e1.size; k++)
+    {
+        unsigned int position = k < e0.size ? (unsigned int)e0.liste_indice[k] : n + (unsigned int)e1.liste_indice[k - e0.size];
+        packed_error[position / WORD_SIZE] |= (uint64_t)1 << (position % WORD_SIZE);
+    }
+    write_packed_polynomial(packed_error, 2 * n, error);
+
+    free(e0.liste_indice);
+    free(e1.liste_indice);
+    free(c);
+    free(packed_error);
+    return 1;
+}
+
+/**
+ * Decode a cypher.
+ *
+ * @param context context of the key, gives the decoder and its threshold
+ * @param key private key loaded by isdmdpc_load_private_key
+ * @param cypher cypher written by isdmdpc_encapsulate
+ * @param size size of the cypher
+ * @param error result, the error found in isdmdpc_error_bytes bytes
+ * @return 1 if the error has been decoded, 0 if the decoding failed or the cypher is invalid
+ */
+int isdmdpc_decapsulate(const isdmdpc_context *context, isdmdpc_private_key *key, const uint8_t *cypher, size_t size, uint8_t *error)
+{
+    unsigned int n = context->parameters.n;
+    packed_polynomial_view view;
+    if (!read_packed_polynomial(cypher, size, &view) || view.n != n)
+        return 0;
+
+    uint64_t *c = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    uint64_t *packed_error = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(2 * n));
+    unpack_polynomial(view, c);
+    decoder_context *decoder = &key->context;
+    decoder->profiler = context->profiler;
+    decoder->perf = context->counters;
+    load_packed_cypher(decoder, c);
+    int threshold = context->parameters.threshold > 0 ? context->parameters.threshold : bgf_threshold(decoder->bgf, decoder->syndrome_weight);
+    int decoded = decode_syndrome(decoder, decoders[context->parameters.decoder], threshold, context->parameters.t / 2);
+    store_packed_error(decoder, packed_error);
+    write_packed_polynomial(packed_error, 2 * n, error);
+
+    free(c);
+    free(packed_error);
+    return decoded;
+}
+
+/**
+ * Create a null matrix.
+ *
+ * @param nb_rows number of rows
+ * @param nb_columns number of columns
+ * @param backend name of the storage (see matrix_backend.h), NULL for the default one
+ * @return the matrix, NULL if the backend is unknown
+ */
+isdmdpc_matrix *isdmdpc_init_matrix(unsigned int nb_rows, unsigned int nb_columns, const char *backend)
+{
+    const matrix_backend *storage = backend != NULL ? find_matrix_backend(backend) : default_matrix_backend();
+    if (storage == NULL || nb_rows == 0 || nb_columns == 0)
+        return NULL;
+    isdmdpc_matrix *matrix = (isdmdpc_matrix *)malloc(sizeof(isdmdpc_matrix));
+    matrix->matrix = init_backend_matrix(storage, nb_rows, nb_columns);
+    return matrix;
+}
+
+void isdmdpc_free_matrix(isdmdpc_matrix *matrix)
+{
+    free_backend_matrix(matrix->matrix);
+    free(matrix);
+}
+
+unsigned int isdmdpc_get_bit(const isdmdpc_matrix *matrix, unsigned int i, unsigned int j)
+{
+    return get_backend_bit(matrix->matrix, i, j);
+}
+
+void isdmdpc_set_bit(isdmdpc_matrix *matrix, unsigned int i, unsigned int j, unsigned int value)
+{
+    set_backend_bit(matrix->matrix, i, j, value & 1);
+}
+
+const char *isdmdpc_matrix_backend(const isdmdpc_matrix *matrix)
+{
+    return matrix->matrix.backend->name;
+}
+
+/**
+ * Draw every bit of a matrix uniformly.
+ *
+ * @param context context whose generator draws the bits
+ * @param matrix matrix to fill
+ */
+void isdmdpc_randomize_matrix(isdmdpc_context *context, isdmdpc_matrix *matrix)
+{
+    randomize_backend_matrix(&context->generator, matrix->matrix);
+}
+
+/**
+ * Set a matrix to a random one of a given weight.
+ *
+ * @param context context whose generator draws the support
+ * @param matrix matrix to fill
+ * @param weight hamming weight
+ * @return 1, 0 if the weight is bigger than the matrix
+ */
+int isdmdpc_random_weight_matrix(isdmdpc_context *context, isdmdpc_matrix *matrix, unsigned int weight)
+{
+    if ((uint64_t)weight > (uint64_t)matrix->matrix.nb_rows * matrix->matrix.nb_columns)
+        return 0;
+    target_weight_backend_matrix(&context->generator, matrix->matrix, weight);
+    return 1;
+}
+
+unsigned int isdmdpc_matrix_weight(const isdmdpc_matrix *matrix)
+{
+    return backend_hamming_weight(matrix->matrix);
+}
+
+/**
+ * Add a matrix to another one with the same sizes, A += B.
+ *
+ * @param A result
+ * @param B added matrix, any backend
+ * @return 1, 0 if the sizes do not match
+ */
+int isdmdpc_add_matrix(isdmdpc_matrix *A, const isdmdpc_matrix *B)
+{
+    if (A->matrix.nb_rows != B->matrix.nb_rows || A->matrix.nb_columns != B->matrix.nb_columns)
+        return 0;
+    backend_matrix added = convert_backend_matrix(B->matrix, A->matrix.backend);
+    add_backend_matrix(A->matrix, added);
+    free_backend_matrix(added);
+    return 1;
+}
+
+/**
+ * Product of two matrices, in the backend of A.
+ *
+ * @param A left matrix
+ * @param B right matrix, any backend
+ * @return the product, NULL if the sizes do not match
+ */
+isdmdpc_matrix *isdmdpc_multiply_matrix(const isdmdpc_matrix *A, const isdmdpc_matrix *B)
+{
+    if (A->matrix.nb_columns != B->matrix.nb_rows)
+        return NULL;
+    backend_matrix right = convert_backend_matrix(B->matrix, A->matrix.backend);
+    isdmdpc_matrix *product = (isdmdpc_matrix *)malloc(sizeof(isdmdpc_matrix));
+    product->matrix = multiply_backend_matrix(A->matrix, right);
+    free_backend_matrix(right);
+    return product;
+}
+
+/**
+ * Inverse of a square matrix, in its backend.
+ *
+ * @param A matrix to invert
+ * @return the inverse, NULL if A is not square or not invertible
+ */
+isdmdpc_matrix *isdmdpc_invert_matrix(const isdmdpc_matrix *A)
+{
+    if (A->matrix.nb_rows != A->matrix.nb_columns)
+        return NULL;
+    int is_invertible;
+    backend_matrix inverse = inversion_backend_matrix(A->matrix, &is_invertible);
+    if (!is_invertible)
+    {
+        free_backend_matrix(inverse);
+        return NULL;
+    }
+    isdmdpc_matrix *result = (isdmdpc_matrix *)malloc(sizeof(isdmdpc_matrix));
+    result->matrix = inverse;
+    return result;
+}
+
+/**
+ * Prange algorithm, the columns are drawn by the generator of the context.
+ * See isd_solve for the parameters.
+ *
+ * @return 1 if an error of weight t has been found, 0 else or if the sizes do not match
+ */
+int isdmdpc_isd_solve(isdmdpc_context *context, const isdmdpc_matrix *H, const isdmdpc_matrix *s, unsigned int t, unsigned long max_iterations, isdmdpc_matrix *e)
+{
+    if (s->matrix.nb_rows != H->matrix.nb_rows || s->matrix.nb_columns != 1 || e->matrix.nb_rows != H->matrix.nb_columns || e->matrix.nb_columns != 1)
+        return 0;
+    // s is converted to the backend of H, as isd_solve expects
+    backend_matrix syndrome = convert_backend_matrix(s->matrix, H->matrix.backend);
+    int is_found = isd_solve(&context->generator, H->matrix, syndrome, t, max_iterations, e->matrix, context->profiler, context->counters);
+    free_backend_matrix(syndrome);
+    return is_found;
+}
@@ -0,0 +1,121 @@
+#ifndef ISDMDPC_H
+#define ISDMDPC_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Public API of libisdmdpc.
+ * The library keeps no state of its own : everything lives in the handles below, created and
+ * freed by the caller. A handle is used by one thread at a time, several handles can be used
+ * in parallel. The functions return 1 on success and 0 on failure, as the rest of the library.
+ * The keys, cyphers and errors are exchanged in the formats of serialization.h.
+ * Only the functions of this file are exported by libisdmdpc.so, built with -fvisibility=hidden.
+ */
+
+// Incremented on every incompatible change of this file
+#define ISDMDPC_API_VERSION 3
+
+#define ISDMDPC_EXPORT __attribute__((visibility("default")))
+
+/**
+ * Decoders of the decapsulation
+ */
+typedef enum
+{
+    ISDMDPC_DECODER_BITFLIP,     /** fixed threshold bit flipping */
+    ISDMDPC_DECODER_BITSLICED,   /** fixed threshold, bit-sliced counters */
+    ISDMDPC_DECODER_INCREMENTAL, /** fixed threshold, counters updated when a bit is flipped */
+    ISDMDPC_DECODER_BGF,         /** Black-Gray-Flip */
+    ISDMDPC_DECODER_BACKFLIP,    /** Backflip */
+    ISDMDPC_DECODER_CONVOLUTION  /** fixed threshold, counters computed as a convolution */
+} isdmdpc_decoder;
+
+/**
+ * Sizes of the keys and choice of the decoder
+ */
+typedef struct
+{
+    unsigned int n;          /** size of each block of the private key */
+    unsigned int w;          /** weight of each line of h0 and h1 */
+    unsigned int t;          /** weight of the whole error, t / 2 on each part */
+    isdmdpc_decoder decoder; /** decoder of the decapsulation */
+    int threshold;           /** threshold of the fixed threshold decoders, 0 for the first threshold of Black-Gray-Flip */
+} isdmdpc_parameters;
+
+// Opaque handles
+typedef struct isdmdpc_context isdmdpc_context;
+typedef struct isdmdpc_public_key isdmdpc_public_key;
+typedef struct isdmdpc_private_key isdmdpc_private_key;
+typedef struct isdmdpc_matrix isdmdpc_matrix;
+typedef struct isdmdpc_key_pool isdmdpc_key_pool;
+
+/**
+ * Counters of a key pool
+ */
+typedef struct
+{
+    unsigned long hits;     /** isdmdpc_pop_key_pair calls served by a key pair generated in advance */
+    unsigned long misses;   /** isdmdpc_pop_key_pair calls which generated their key pair inline */
+    unsigned long produced; /** key pairs generated by the producers */
+    unsigned int nb_ready;  /** key pairs ready to be popped */
+} isdmdpc_key_pool_statistics;
+
+// Contexts : parameters and random generator
+
+ISDMDPC_EXPORT int isdmdpc_api_version(void);
+ISDMDPC_EXPORT isdmdpc_context *isdmdpc_init_context(isdmdpc_parameters parameters, uint64_t seed, uint64_t stream);
+ISDMDPC_EXPORT void isdmdpc_free_context(isdmdpc_context *context);
+ISDMDPC_EXPORT isdmdpc_parameters isdmdpc_get_parameters(const isdmdpc_context *context);
+ISDMDPC_EXPORT size_t isdmdpc_private_key_bytes(const isdmdpc_context *context);
+ISDMDPC_EXPORT size_t isdmdpc_public_key_bytes(const isdmdpc_context *context);
+ISDMDPC_EXPORT size_t isdmdpc_cypher_bytes(const isdmdpc_context *context);
+ISDMDPC_EXPORT size_t isdmdpc_error_bytes(const isdmdpc_context *context);
+
+// Profiling, kept in the context and disabled by default
+
+ISDMDPC_EXPORT int isdmdpc_enable_profiler(isdmdpc_context *context);
+ISDMDPC_EXPORT int isdmdpc_enable_perf_counters(isdmdpc_context *context);
+ISDMDPC_EXPORT int isdmdpc_write_profiler_report(const isdmdpc_context *context, FILE *output);
+ISDMDPC_EXPORT int isdmdpc_write_perf_report(const isdmdpc_context *context, FILE *output);
+
+// Keys, expanded once and reused by every encapsulation or decapsulation
+
+ISDMDPC_EXPORT int isdmdpc_keygen(isdmdpc_context *context, uint8_t *private_key, uint8_t *public_key);
+ISDMDPC_EXPORT isdmdpc_public_key *isdmdpc_load_public_key(const isdmdpc_context *context, const uint8_t *buffer, size_t size);
+ISDMDPC_EXPORT void isdmdpc_free_public_key(isdmdpc_public_key *key);
+ISDMDPC_EXPORT isdmdpc_private_key *isdmdpc_load_private_key(const isdmdpc_context *context, const uint8_t *buffer, size_t size);
+ISDMDPC_EXPORT void isdmdpc_free_private_key(isdmdpc_private_key *key);
+
+// Pools of key pairs generated in advance by producer threads, the only handles shared between threads
+
+ISDMDPC_EXPORT isdmdpc_key_pool *isdmdpc_init_key_pool(const isdmdpc_context *context, unsigned int depth, unsigned int watermark, unsigned int nb_producers, uint64_t seed);
+ISDMDPC_EXPORT void isdmdpc_free_key_pool(isdmdpc_key_pool *pool);
+ISDMDPC_EXPORT int isdmdpc_pop_key_pair(isdmdpc_key_pool *pool, uint8_t *private_key, uint8_t *public_key);
+ISDMDPC_EXPORT isdmdpc_key_pool_statistics isdmdpc_get_key_pool_statistics(isdmdpc_key_pool *pool);
+
+// KEM
+
+ISDMDPC_EXPORT int isdmdpc_encapsulate(isdmdpc_context *context, const isdmdpc_public_key *key, uint8_t *cypher, uint8_t *error);
+ISDMDPC_EXPORT int isdmdpc_decapsulate(const isdmdpc_context *context, isdmdpc_private_key *key, const uint8_t *cypher, size_t size, uint8_t *error);
+
+// Binary matrices of the ISD, stored by one of the backends reference, packed32, packed64 or simd
+
+ISDMDPC_EXPORT isdmdpc_matrix *isdmdpc_init_matrix(unsigned int nb_rows, unsigned int nb_columns, const char *backend);
+ISDMDPC_EXPORT void isdmdpc_free_matrix(isdmdpc_matrix *matrix);
+ISDMDPC_EXPORT unsigned int isdmdpc_get_bit(const isdmdpc_matrix *matrix, unsigned int i, unsigned int j);
+ISDMDPC_EXPORT void isdmdpc_set_bit(isdmdpc_matrix *matrix, unsigned int i, unsigned int j, unsigned int value);
+ISDMDPC_EXPORT const char *isdmdpc_matrix_backend(const isdmdpc_matrix *matrix);
+ISDMDPC_EXPORT void isdmdpc_randomize_matrix(isdmdpc_context *context, isdmdpc_matrix *matrix);
+ISDMDPC_EXPORT int isdmdpc_random_weight_matrix(isdmdpc_context *context, isdmdpc_matrix *matrix, unsigned int weight);
+ISDMDPC_EXPORT unsigned int isdmdpc_matrix_weight(const isdmdpc_matrix *matrix);
+ISDMDPC_EXPORT int isdmdpc_add_matrix(isdmdpc_matrix *A, const isdmdpc_matrix *B);
+ISDMDPC_EXPORT isdmdpc_matrix *isdmdpc_multiply_matrix(const isdmdpc_matrix *A, const isdmdpc_matrix *B);
+ISDMDPC_EXPORT isdmdpc_matrix *isdmdpc_invert_matrix(const isdmdpc_matrix *A);
+
+// Information set decoding
+
+ISDMDPC_EXPORT int isdmdpc_isd_solve(isdmdpc_context *context, const isdmdpc_matrix *H, const isdmdpc_matrix *s, unsigned int t, unsigned long max_iterations, isdmdpc_matrix *e);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "kem.h"
+
+/**
+ * Batched encapsulation and decapsulation.
+ * The structures derived from a key (packed columns of the public key, decoder of the
+ * private key) are built once and shared by every message of the batch, so the cost
+ * of a message is only its own cypher or decoding.
+ */
+
+key_pair init_key_pair(unsigned int n, unsigned int w)
+{
+    key_pair keys;
+    keys.n = n;
+    keys.w = w;
+    keys.private_key = (uint8_t *)malloc(PRIVATE_KEY_BYTES(w));
+    keys.public_key = (uint8_t *)malloc(PACKED_POLYNOMIAL_BYTES(n));
+    return keys;
+}
+
+void free_key_pair(key_pair keys)
+{
+    free(keys.private_key);
+    free(keys.public_key);
+}
+
+/**
+ * Generate a key pair directly in its serialized form.
+ * The first lines a0 and a1 of h0 and h1 are drawn with the generator, and the public key
+ * h0^-1 * h1 is circulant with first line a0^-1 * a1 modulo X^n - 1, so it is computed
+ * in the ring instead of inverting the n x n matrix h0. a0 is drawn again until it is invertible.
+ *
+ * @param generator random generator
+ * @param keys key pair to fill, allocated by init_key_pair
+ */
+void generate_key_pair(drbg *generator, key_pair keys)
+{
+    unsigned int n = keys.n;
+    unsigned int w = keys.w;
+    polynome supports[2];
+    for (int part = 0; part < 2; part++)
+    {
+        supports[part].size = w;
+        supports[part].liste_indice = (int *)malloc(sizeof(int) * w);
+    }
+    uint64_t *a0 = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    uint64_t *inverse = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    uint64_t *public_line = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+
+    do
+    {
+        sample_support(generator, supports[0].liste_indice, w, n);
+        for (unsigned int i = 0; i < NB_WORDS(n); i++)
+            a0[i] = 0;
+        for (unsigned int k = 0; k < w; k++)
+            a0[supports[0].liste_indice[k] / WORD_SIZE] |= (uint64_t)1 << (supports[0].liste_indice[k] % WORD_SIZE);
+    } while (!inverse_ring(a0, n, inverse));
+    sample_support(generator, supports[1].liste_indice, w, n);
+    // Only a shift coprime with n gives distinct rows, it is accepted at the first draw when n is prime
+    unsigned int shift;
+    do
+    {
+        shift = 1 + uniform_drbg(generator, n - 1);
+    } while (!is_coprime_shift(shift, n));
+    multiply_sparse_ring(inverse, supports[1], n, public_line);
+
+    write_private_key_from_support(supports[0], supports[1], n, shift, keys.private_key);
+    write_packed_polynomial(public_line, n, keys.public_key);
+
+    free(supports[0].liste_indice);
+    free(supports[1].liste_indice);
+    free(a0);
+    free(inverse);
+    free(public_line);
+}
+
+/**
+ * Expand a public key for encapsulation.
+ * The public keys of pubkey_generation are circulant (h0 and h1 are quasi-cyclic with the
+ * same shift), so only the first column is read, from the first index of each row.
+ *
+ * @param pubkey public key, sorted support of each of its n rows
+ * @param n size of the public key
+ * @return the packed first column of the public key
+ */
+expanded_public_key expand_public_key(polynome *pubkey, unsigned int n)
+{
+    expanded_public_key key;
+    key.n = n;
+    key.nb_words = NB_WORDS(n);
+    key.first_column = (uint64_t *)calloc(key.nb_words, sizeof(uint64_t));
+    // The supports are sorted, so row i has a bit in column 0 if its first index is 0
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (pubkey[i].size > 0 && pubkey[i].liste_indice[0] == 0)
+            key.first_column[i / WORD_SIZE] |= (uint64_t)1 << (i % WORD_SIZE);
+    }
+    return key;
+}
+
+/**
+ * Expand a circulant public key given by its first line (see write_public_key).
+ * Line i is the first line shifted by i, so column j is column 0 shifted by j.
+ *
+ * @param first_line first line of the public key, packed in NB_WORDS(n) words
+ * @param n size of the public key
+ * @return the packed first column of the public key
+ */
+expanded_public_key expand_circulant_public_key(const uint64_t *first_line, unsigned int n)
+{
+    expanded_public_key key;
+    key.n = n;
+    key.nb_words = NB_WORDS(n);
+    key.first_column = (uint64_t *)calloc(key.nb_words, sizeof(uint64_t));
+
+    // pubkey[i][j] = first_line[(j - i) % n], so column 0 holds first_line[-i]
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int index = (n - i) % n;
+        key.first_column[i / WORD_SIZE] |= ((first_line[index / WORD_SIZE] >> (index % WORD_SIZE)) & 1) << (i % WORD_SIZE);
+    }
+    return key;
+}
+
+void free_expanded_public_key(expanded_public_key key)
+{
+    free(key.first_column);
+}
+
+size_t expanded_public_key_bytes(expanded_public_key key)
+{
+    return sizeof(uint64_t) * key.nb_words;
+}
+
+/**
+ * Cypher of one error : c = e0 + pubkey * e1.
+ * Column j of the public key is the first column times X^j, so pubkey * e1 is the product
+ * of the first column by e1 in the ring : t / 2 rotations of NB_WORDS(n) words.
+ *
+ * @param key expanded public key
+ * @param e0 support of the first part of the error
+ * @param e1 support of the second part of the error
+ * @param c packed cypher, key.nb_words words
+ */
+void encapsulate(expanded_public_key key, polynome e0, polynome e1, uint64_t *c)
+{
+    multiply_sparse_ring(key.first_column, e1, key.n, c);
+    for (int k = 0; k < e0.size; k++)
+        c[e0.liste_indice[k] / WORD_SIZE] ^= (uint64_t)1 << (e0.liste_indice[k] % WORD_SIZE);
+}
+
+/**
+ * Cypher of a batch of errors with the same public key.
+ *
+ * @param key expanded public key
+ * @param e0 support of the first part of each error
+ * @param e1 support of the second part of each error
+ * @param nb_messages number of errors
+ * @param cyphers packed cyphers, key.nb_words words for each message
+ */
+void encapsulate_batch(expanded_public_key key, polynome *e0, polynome *e1, unsigned int nb_messages, uint64_t *cyphers)
+{
+    for (unsigned int m = 0; m < nb_messages; m++)
+        encapsulate(key, e0[m], e1[m], cyphers + (size_t)m * key.nb_words);
+}
+
+/**
+ * Build the lanes decoder of a decoder, if it has none yet.
+ * It is kept in the decoder and counted by decoder_context_bytes from then on.
+ *
+ * @param context decoder of the private key
+ */
+void build_lanes_decoder(decoder_context *context)
+{
+    if (context->lanes == NULL)
+    {
+        context->lanes = (lanes_decoder *)malloc(sizeof(lanes_decoder));
+        *context->lanes = init_lanes_decoder(context);
+    }
+    // The decoder may have been copied since its lanes decoder was built
+    context->lanes->context = context;
+}
+
+/**
+ * Decode a batch of cyphers with the fixed threshold bit flipping, NB_LANES cyphers at once.
+ * Gives the same errors as fixed_threshold_bitflip on each cypher.
+ * The lanes decoder is built by the first call (build_lanes_decoder) and kept in the decoder of the key.
+ *
+ * @param context decoder of the private key
+ * @param cyphers packed cyphers, NB_WORDS(nb_rows) words for each cypher
+ * @param nb_cyphers number of cyphers
+ * @param threshold minimal number of unsatisfied parity checks to flip a position
+ * @param weight weight of each part of the error
+ * @param errors packed errors found, NB_WORDS(nb_columns) words for each cypher
+ * @param decoded 1 for each cypher whose error has been decoded, 0 else
+ * @return number of cyphers decoded
+ */
+unsigned int decapsulate_batch_lanes(decoder_context *context, uint64_t *cyphers, unsigned int nb_cyphers, int threshold, unsigned int weight, uint64_t *errors, int *decoded)
+{
+    build_lanes_decoder(context);
+    unsigned int nb_decoded = 0;
+    for (unsigned int m = 0; m < nb_cyphers; m += NB_LANES)
+    {
+        unsigned int nb_lanes = nb_cyphers - m < NB_LANES ? nb_cyphers - m : NB_LANES;
+        load_lanes_cyphers(context->lanes, cyphers + (size_t)m * NB_WORDS(context->nb_rows), nb_lanes);
+        uint64_t decoded_lanes = bitflip_lanes(context->lanes, threshold, weight);
+        store_lanes_errors(context->lanes, errors + (size_t)m * NB_WORDS(context->nb_columns));
+        for (unsigned int l = 0; l < nb_lanes; l++)
+        {
+            decoded[m + l] = (decoded_lanes >> l) & 1;
+            nb_decoded += decoded[m + l];
+        }
+    }
+    return nb_decoded;
+}
+
+/**
+ * Decode a batch of cyphers with the same private key.
+ * The decoder is reused for every cypher, nothing is allocated.
+ * With DECODER_BITSLICED, the cyphers are decoded NB_LANES at once (decapsulate_batch_lanes).
+ *
+ * @param context decoder of the private key
+ * @param decoder decoder to use
+ * @param cyphers packed cyphers, NB_WORDS(nb_rows) words for each cypher
+ * @param nb_cyphers number of cyphers
+ * @param threshold threshold of the fixed threshold decoders
+ * @param weight weight of each part of the error
+ * @param errors packed errors found, NB_WORDS(nb_columns) words for each cypher
+ * @param decoded 1 for each cypher whose error has been decoded, 0 else
+ * @return number of cyphers decoded
+ */
+unsigned int decapsulate_batch(decoder_context *context, decoder_type decoder, uint64_t *cyphers, unsigned int nb_cyphers, int threshold, unsigned int weight, uint64_t *errors, int *decoded)
+{
+    if (decoder == DECODER_BITSLICED)
+        return decapsulate_batch_lanes(context, cyphers, nb_cyphers, threshold, weight, errors, decoded);
+
+    unsigned int nb_decoded = 0;
+    for (unsigned int m = 0; m < nb_cyphers; m++)
+    {
+        load_packed_cypher(context, cyphers + (size_t)m * NB_WORDS(context->nb_rows));
+        decoded[m] = decode_syndrome(context, decoder, threshold, weight);
+        store_packed_error(context, errors + (size_t)m * NB_WORDS(context->nb_columns));
+        nb_decoded += decoded[m];
+    }
+    return nb_decoded;
+}
@@ -0,0 +1,54 @@
+#ifndef KEM_H
+#define KEM_H
+
+#include "decoder.h"
+#include "drbg.h"
+#include "serialization.h"
+#include "../libs_optimized/bitslice_decoder.h"
+#include "../libs_optimized/ring.h"
+
+/**
+ * Public key expanded once for many encapsulations.
+ * The public key is circulant : column j is column 0 rotated by j, so only column 0 is kept
+ * and the cypher of an error is e0 plus the product of column 0 by e1 in the ring.
+ */
+typedef struct
+{
+    uint64_t *first_column; /** column 0 of the public key, packed */
+    unsigned int n;         /** size of the public key */
+    unsigned int nb_words;  /** words of a packed column, NB_WORDS(n) */
+} expanded_public_key;
+
+/**
+ * Serialized key pair (see serialization.h)
+ */
+typedef struct
+{
+    unsigned int n;       /** size of the keys */
+    unsigned int w;       /** weight of each line of h0 and h1 */
+    uint8_t *private_key; /** PRIVATE_KEY_BYTES(w) bytes */
+    uint8_t *public_key;  /** PACKED_POLYNOMIAL_BYTES(n) bytes */
+} key_pair;
+
+// Key generation
+
+key_pair init_key_pair(unsigned int n, unsigned int w);
+void free_key_pair(key_pair keys);
+void generate_key_pair(drbg *generator, key_pair keys);
+
+// Creation and Destruction of an expanded public key
+
+expanded_public_key expand_public_key(polynome *pubkey, unsigned int n);
+expanded_public_key expand_circulant_public_key(const uint64_t *first_line, unsigned int n);
+void free_expanded_public_key(expanded_public_key key);
+size_t expanded_public_key_bytes(expanded_public_key key);
+
+// Batches
+
+void encapsulate(expanded_public_key key, polynome e0, polynome e1, uint64_t *c);
+void encapsulate_batch(expanded_public_key key, polynome *e0, polynome *e1, unsigned int nb_messages, uint64_t *cyphers);
+void build_lanes_decoder(decoder_context *context);
+unsigned int decapsulate_batch_lanes(decoder_context *context, uint64_t *cyphers, unsigned int nb_cyphers, int threshold, unsigned int weight, uint64_t *errors, int *decoded);
+unsigned int decapsulate_batch(decoder_context *context, decoder_type decoder, uint64_t *cyphers, unsigned int nb_cyphers, int threshold, unsigned int weight, uint64_t *errors, int *decoded);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "key_cache.h"
+
+/**
+ * Expand a key pair : build the decoder of the private key and the packed first column
+ * of the public key. The lanes decoder of DECODER_BITSLICED is built here too, so that
+ * expanded_key_bytes counts everything the decapsulations will use.
+ *
+ * @param private_key serialized private key
+ * @param public_key serialized public key
+ * @param t weight of the whole error, used for the thresholds
+ * @param decoder decoder of the decapsulations
+ * @return the expanded key
+ */
+expanded_key expand_key(private_key_view private_key, packed_polynomial_view public_key, unsigned int t, decoder_type decoder)
+{
+    expanded_key key;
+    key.context = init_decoder_context_from_private_key(private_key, t);
+    if (decoder == DECODER_BITSLICED)
+        build_lanes_decoder(&key.context);
+    uint64_t *first_line = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(public_key.n));
+    unpack_polynomial(public_key, first_line);
+    key.public_key = expand_circulant_public_key(first_line, public_key.n);
+    free(first_line);
+    return key;
+}
+
+void free_expanded_key(expanded_key key)
+{
+    free_decoder_context(key.context);
+    free_expanded_public_key(key.public_key);
+}
+
+size_t expanded_key_bytes(expanded_key key)
+{
+    return decoder_context_bytes(key.context) + expanded_public_key_bytes(key.public_key);
+}
+
+/**
+ * Initialize an empty cache.
+ *
+ * @param capacity maximal number of keys, at least 1
+ * @param max_bytes maximal memory of the expanded keys (see expanded_key_bytes), 0 for no limit
+ * @return the cache
+ */
+key_cache init_key_cache(unsigned int capacity, size_t max_bytes)
+{
+    key_cache cache;
+    cache.capacity = capacity > 0 ? capacity : 1;
+    cache.max_bytes = max_bytes;
+    cache.nb_buckets = 2 * cache.capacity;
+    cache.buckets = (key_cache_entry **)calloc(cache.nb_buckets, sizeof(key_cache_entry *));
+    cache.most_recent = NULL;
+    cache.least_recent = NULL;
+    memset(&cache.statistics, 0, sizeof(key_cache_statistics));
+    return cache;
+}
+
+void free_key_cache(key_cache cache)
+{
+    key_cache_entry *entry = cache.most_recent;
+    while (entry != NULL)
+    {
+        key_cache_entry *next = entry->next;
+        free_expanded_key(entry->key);
+        free(entry);
+        entry = next;
+    }
+    free(cache.buckets);
+}
+
+static unsigned int bucket_of(key_cache *cache, uint64_t key_id)
+{
+    // Fibonacci hashing, the identifiers can be consecutive
+    return (unsigned int)((key_id * 0x9E3779B97F4A7C15ULL) >> 32) % cache->nb_buckets;
+}
+
+static void unlink_entry(key_cache *cache, key_cache_entry *entry)
+{
+    if (entry->previous != NULL)
+        entry->previous->next = entry->next;
+    else
+        cache->most_recent = entry->next;
+    if (entry->next != NULL)
+        entry->next->previous = entry->previous;
+    else
+        cache->least_recent = entry->previous;
+}
+
+static void push_front(key_cache *cache, key_cache_entry *entry)
+{
+    entry->previous = NULL;
+    entry->next = cache->most_recent;
+    if (cache->most_recent != NULL)
+        cache->most_recent->previous = entry;
+    cache->most_recent = entry;
+    if (cache->least_recent == NULL)
+        cache->least_recent = entry;
+}
+
+/**
+ * Remove the least recently used key.
+ *
+ * @param cache cache, not empty
+ */
+static void evict_least_recent(key_cache *cache)
+{
+    key_cache_entry *entry = cache->least_recent;
+    unlink_entry(cache, entry);
+    key_cache_entry **link = &cache->buckets[bucket_of(cache, entry->key_id)];
+    while (*link != entry)
+        link = &(*link)->next_in_bucket;
+    *link = entry->next_in_bucket;
+
+    cache->statistics.nb_entries--;
+    cache->statistics.bytes -= entry->bytes;
+    cache->statistics.evictions++;
+    free_expanded_key(entry->key);
+    free(entry);
+}
+
+/**
+ * Find an expanded key, which becomes the most recently used.
+ *
+ * @param cache cache
+ * @param key_id identifier of the key
+ * @return the expanded key, valid until the next insertion, NULL if the key is not in the cache
+ */
+expanded_key *key_cache_find(key_cache *cache, uint64_t key_id)
+{
+    key_cache_entry *entry = cache->buckets[bucket_of(cache, key_id)];
+    while (entry != NULL && entry->key_id != key_id)
+        entry = entry->next_in_bucket;
+    if (entry == NULL)
+    {
+        cache->statistics.misses++;
+        return NULL;
+    }
+    cache->statistics.hits++;
+    unlink_entry(cache, entry);
+    push_front(cache, entry);
+    return &entry->key;
+}
+
+/**
+ * Expand a key pair and add it to the cache, after a miss of key_cache_find.
+ * The least recently used keys are evicted until the new key fits in the capacity and in the
+ * memory budget; a key bigger than the whole budget is still kept, alone.
+ *
+ * @param cache cache
+ * @param key_id identifier of the key, not in the cache
+ * @param private_key serialized private key
+ * @param public_key serialized public key
+ * @param t weight of the whole error, used for the thresholds
+ * @param decoder decoder of the decapsulations, see expand_key
+ * @return the expanded key, valid until the next insertion
+ */
+expanded_key *key_cache_insert(key_cache *cache, uint64_t key_id, private_key_view private_key, packed_polynomial_view public_key, unsigned int t, decoder_type decoder)
+{
+    key_cache_entry *entry = (key_cache_entry *)malloc(sizeof(key_cache_entry));
+    entry->key_id = key_id;
+    entry->key = expand_key(private_key, public_key, t, decoder);
+    entry->bytes = expanded_key_bytes(entry->key);
+    while (cache->statistics.nb_entries > 0 && (cache->statistics.nb_entries >= cache->capacity ||
+                                                (cache->max_bytes > 0 && cache->statistics.bytes + entry->bytes > cache->max_bytes)))
+        evict_least_recent(cache);
+    unsigned int bucket = bucket_of(cache, key_id);
+    entry->next_in_bucket = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    push_front(cache, entry);
+
+    cache->statistics.nb_entries++;
+    cache->statistics.bytes += entry->bytes;
+    return &entry->key;
+}
+
+/**
+ * Proportion of key_cache_find calls which found the key.
+ *
+ * @param cache cache
+ * @return the hit rate, 0 if key_cache_find was never called
+ */
+double key_cache_hit_rate(key_cache *cache)
+{
+    unsigned long nb_calls = cache->statistics.hits + cache->statistics.misses;
+    return nb_calls > 0 ? (double)cache->statistics.hits / nb_calls : 0;
+}
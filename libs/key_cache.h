@@ -0,0 +1,77 @@
+#ifndef KEY_CACHE_H
+#define KEY_CACHE_H
+
+#include "kem.h"
+#include "serialization.h"
+
+/**
+ * Everything derived from a key pair, computed once : the decoder of the private key
+ * (supports of the rows and columns of H, thresholds, buffers) and the packed first column
+ * of the public key.
+ */
+typedef struct
+{
+    decoder_context context;        /** decoder of the private key */
+    expanded_public_key public_key; /** packed first column of the public key */
+} expanded_key;
+
+/**
+ * Entry of the cache, in a hash bucket and in the LRU list
+ */
+typedef struct key_cache_entry
+{
+    uint64_t key_id;                        /** identifier of the key */
+    expanded_key key;                       /** expanded key */
+    size_t bytes;                           /** memory used by the expanded key */
+    struct key_cache_entry *previous;       /** more recently used entry */
+    struct key_cache_entry *next;           /** less recently used entry */
+    struct key_cache_entry *next_in_bucket; /** next entry of the same hash bucket */
+} key_cache_entry;
+
+/**
+ * Counters of a cache
+ */
+typedef struct
+{
+    unsigned long hits;      /** key_cache_find calls which found the key */
+    unsigned long misses;    /** key_cache_find calls which did not find the key */
+    unsigned long evictions; /** keys removed to respect the capacity or the memory budget */
+    unsigned int nb_entries; /** keys in the cache */
+    size_t bytes;            /** memory used by the expanded keys */
+} key_cache_statistics;
+
+/**
+ * Bounded cache of expanded keys, the least recently used key is evicted first.
+ * The cache is bounded both by a number of keys and by the memory of the expanded keys.
+ * A cache is not shared between threads : the decoder of an expanded key holds
+ * the buffers of the decoding in progress.
+ */
+typedef struct
+{
+    unsigned int capacity;           /** maximal number of keys */
+    size_t max_bytes;                /** maximal memory of the expanded keys, 0 for no limit */
+    unsigned int nb_buckets;         /** size of the hash table */
+    key_cache_entry **buckets;       /** hash table of the entries */
+    key_cache_entry *most_recent;    /** head of the LRU list */
+    key_cache_entry *least_recent;   /** tail of the LRU list */
+    key_cache_statistics statistics; /** counters of the cache */
+} key_cache;
+
+// Expanded keys
+
+expanded_key expand_key(private_key_view private_key, packed_polynomial_view public_key, unsigned int t, decoder_type decoder);
+void free_expanded_key(expanded_key key);
+size_t expanded_key_bytes(expanded_key key);
+
+// Creation and Destruction of the cache
+
+key_cache init_key_cache(unsigned int capacity, size_t max_bytes);
+void free_key_cache(key_cache cache);
+
+// Operations on the cache
+
+expanded_key *key_cache_find(key_cache *cache, uint64_t key_id);
+expanded_key *key_cache_insert(key_cache *cache, uint64_t key_id, private_key_view private_key, packed_polynomial_view public_key, unsigned int t, decoder_type decoder);
+double key_cache_hit_rate(key_cache *cache);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "key_pool.h"
+
+/**
+ * Push a key pair in the queue (bounded queue of Dmitry Vyukov).
+ *
+ * @param pool pool
+ * @param keys key pair to push
+ * @return 1 if the key pair has been pushed, 0 if the queue is full
+ */
+static int push_key_pair(key_pool *pool, key_pair keys)
+{
+    size_t position = atomic_load_explicit(&pool->push_position, memory_order_relaxed);
+    key_pool_cell *cell;
+    while (1)
+    {
+        cell = &pool->cells[position & pool->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&pool->push_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = atomic_load_explicit(&pool->push_position, memory_order_relaxed);
+    }
+    cell->keys = keys;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    atomic_fetch_add(&pool->nb_ready, 1);
+    return 1;
+}
+
+/**
+ * Pop a key pair from the queue.
+ *
+ * @param pool pool
+ * @param keys result
+ * @return 1 if a key pair has been popped, 0 if the queue is empty
+ */
+static int pop_key_pair(key_pool *pool, key_pair *keys)
+{
+    size_t position = atomic_load_explicit(&pool->pop_position, memory_order_relaxed);
+    key_pool_cell *cell;
+    while (1)
+    {
+        cell = &pool->cells[position & pool->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&pool->pop_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = atomic_load_explicit(&pool->pop_position, memory_order_relaxed);
+    }
+    *keys = cell->keys;
+    atomic_store_explicit(&cell->sequence, position + pool->mask + 1, memory_order_release);
+    atomic_fetch_sub(&pool->nb_ready, 1);
+    return 1;
+}
+
+/**
+ * Generate the next key pair of the pool, with its own random stream.
+ *
+ * @param pool pool
+ * @return the key pair
+ */
+static key_pair next_key_pair(key_pool *pool)
+{
+    drbg generator = init_drbg(pool->seed, atomic_fetch_add(&pool->nb_generated, 1));
+    key_pair keys = init_key_pair(pool->n, pool->w);
+    generate_key_pair(&generator, keys);
+    return keys;
+}
+
+/**
+ * Producer thread : fill the queue up to depth, then sleep until it falls to the watermark.
+ *
+ * @param arg the key_pool
+ * @return NULL
+ */
+static void *key_pool_producer(void *arg)
+{
+    key_pool *pool = (key_pool *)arg;
+    while (atomic_load(&pool->running))
+    {
+        if (atomic_load(&pool->nb_ready) >= (int)pool->depth)
+        {
+            pthread_mutex_lock(&pool->lock);
+            while (atomic_load(&pool->running) && atomic_load(&pool->nb_ready) > (int)pool->watermark)
+                pthread_cond_wait(&pool->refill, &pool->lock);
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+        key_pair keys = next_key_pair(pool);
+        if (push_key_pair(pool, keys))
+            atomic_fetch_add(&pool->statistics.produced, 1);
+        else
+            free_key_pair(keys);
+    }
+    return NULL;
+}
+
+/**
+ * Initialize a pool and start its producers.
+ * The pool is returned by pointer, its producers keep its address.
+ *
+ * @param n size of the keys
+ * @param w weight of each line of h0 and h1, odd so that h0 can be invertible
+ * @param depth maximal number of ready key pairs
+ * @param watermark the producers start again at this number of ready key pairs, < depth
+ * @param nb_producers number of producer threads
+ * @param seed seed of the random streams
+ * @return the pool
+ */
+key_pool *init_key_pool(unsigned int n, unsigned int w, unsigned int depth, unsigned int watermark, unsigned int nb_producers, uint64_t seed)
+{
+    key_pool *pool = (key_pool *)malloc(sizeof(key_pool));
+    pool->n = n;
+    pool->w = w;
+    pool->depth = depth > 0 ? depth : 1;
+    pool->watermark = watermark < pool->depth ? watermark : pool->depth - 1;
+    pool->seed = seed;
+
+    size_t nb_cells = 2;
+    while (nb_cells < pool->depth)
+        nb_cells *= 2;
+    pool->mask = nb_cells - 1;
+    pool->cells = (key_pool_cell *)malloc(sizeof(key_pool_cell) * nb_cells);
+    for (size_t i = 0; i < nb_cells; i++)
+        atomic_init(&pool->cells[i].sequence, i);
+    atomic_init(&pool->push_position, 0);
+    atomic_init(&pool->pop_position, 0);
+    atomic_init(&pool->nb_ready, 0);
+    atomic_init(&pool->nb_generated, 0);
+    atomic_init(&pool->running, 1);
+    atomic_init(&pool->statistics.hits, 0);
+    atomic_init(&pool->statistics.misses, 0);
+    atomic_init(&pool->statistics.produced, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->refill, NULL);
+
+    pool->nb_producers = nb_producers;
+    pool->producers = (pthread_t *)malloc(sizeof(pthread_t) * nb_producers);
+    for (unsigned int i = 0; i < nb_producers; i++)
+        pthread_create(&pool->producers[i], NULL, key_pool_producer, pool);
+    return pool;
+}
+
+/**
+ * Stop the producers and free the pool with the key pairs still in the queue.
+ *
+ * @param pool pool
+ */
+void free_key_pool(key_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->running, 0);
+    pthread_cond_broadcast(&pool->refill);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned int i = 0; i < pool->nb_producers; i++)
+        pthread_join(pool->producers[i], NULL);
+
+    key_pair keys;
+    while (pop_key_pair(pool, &keys))
+        free_key_pair(keys);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->refill);
+    free(pool->producers);
+    free(pool->cells);
+    free(pool);
+}
+
+/**
+ * Take a ready key pair, in O(1).
+ * If the queue is empty (a miss), the key pair is generated by the caller.
+ *
+ * @param pool pool
+ * @return a key pair, to free with free_key_pair
+ */
+key_pair key_pool_pop(key_pool *pool)
+{
+    key_pair keys;
+    if (pop_key_pair(pool, &keys))
+    {
+        atomic_fetch_add(&pool->statistics.hits, 1);
+        if (atomic_load(&pool->nb_ready) <= (int)pool->watermark)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_broadcast(&pool->refill);
+            pthread_mutex_unlock(&pool->lock);
+        }
+        return keys;
+    }
+    atomic_fetch_add(&pool->statistics.misses, 1);
+    return next_key_pair(pool);
+}
+
+int key_pool_size(key_pool *pool)
+{
+    return atomic_load(&pool->nb_ready);
+}
@@ -0,0 +1,65 @@
+#ifndef KEY_POOL_H
+#define KEY_POOL_H
+
+#include "kem.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/**
+ * Cell of the queue : the sequence tells whether the cell is free or holds a key pair
+ */
+typedef struct
+{
+    atomic_size_t sequence; /** position of the next push (free) or pop (full) of the cell */
+    key_pair keys;          /** key pair stored in the cell */
+} key_pool_cell;
+
+/**
+ * Counters of a pool
+ */
+typedef struct
+{
+    atomic_ulong hits;     /** key_pool_pop calls served by the queue */
+    atomic_ulong misses;   /** key_pool_pop calls which generated their key pair inline */
+    atomic_ulong produced; /** key pairs generated by the producers */
+} key_pool_statistics;
+
+/**
+ * Pool of key pairs generated in advance by producer threads.
+ * The key pairs are kept in a bounded lock-free queue (multi-producer, multi-consumer) :
+ * a pop is O(1) and never waits for a key generation. The producers sleep when the queue
+ * holds depth key pairs and are woken when it falls to the watermark.
+ */
+typedef struct
+{
+    unsigned int n;                 /** size of the keys */
+    unsigned int w;                 /** weight of each line of h0 and h1 */
+    unsigned int depth;             /** maximal number of ready key pairs */
+    unsigned int watermark;         /** the producers start again at this number of ready key pairs */
+    size_t mask;                    /** number of cells - 1, the number of cells is a power of 2 */
+    key_pool_cell *cells;           /** cells of the queue */
+    atomic_size_t push_position;    /** next position to push */
+    atomic_size_t pop_position;     /** next position to pop */
+    atomic_int nb_ready;            /** key pairs in the queue */
+    atomic_ulong nb_generated;      /** key pairs generated, key k uses the random stream k */
+    uint64_t seed;                  /** seed of the random streams */
+    atomic_int running;             /** 0 when the producers must stop */
+    pthread_mutex_t lock;           /** only used to sleep and wake the producers */
+    pthread_cond_t refill;          /** signaled when the queue falls to the watermark */
+    unsigned int nb_producers;      /** number of producer threads */
+    pthread_t *producers;           /** producer threads */
+    key_pool_statistics statistics; /** counters of the pool */
+} key_pool;
+
+// Creation and Destruction of the pool
+
+key_pool *init_key_pool(unsigned int n, unsigned int w, unsigned int depth, unsigned int watermark, unsigned int nb_producers, uint64_t seed);
+void free_key_pool(key_pool *pool);
+
+// Operations on the pool
+
+key_pair key_pool_pop(key_pool *pool);
+int key_pool_size(key_pool *pool);
+
+#endif
\ No newline at end of file
@@ -1,4 +1,26 @@
 #include "matrix.h"
+#include <string.h>
+#include "matrix_view.h"
+#include "../libs_optimized/packed_backends.h"
+#include "../libs_optimized/ring.h"
+
+/**
+ * The rows of the matrices are the rows of the packed64 backend of matrix_backend.h, in the layout
+ * of ring.h : bit j of a row is bit j % WORD_SIZE of word j / WORD_SIZE. The bits after nb_columns
+ * are zero, so that the rows are added, counted and compared a word at a time without masks.
+ * The operations on rows are those of packed64_backend, a bit ** matrix is the array of rows of a
+ * backend_matrix of this backend (bits_backend_matrix).
+ */
+
+static uint64_t *line_words(bit *line)
+{
+    return (uint64_t *)line;
+}
+
+static const uint64_t *const_line_words(const bit *line)
+{
+    return (const uint64_t *)line;
+}
 
 /**
  * Initialize a binary matrix.
@@ -9,11 +31,7 @@
  */
 bit **init_matrix(unsigned int nb_rows, unsigned int nb_columns)
 {
-    bit **matrix = (bit **)calloc(nb_rows, sizeof(bit *));
-
-    for (unsigned int i = 0; i < nb_rows; i++)
-        matrix[i] = calloc(nb_columns, sizeof(bit));
-    return matrix;
+    return (bit **)init_backend_matrix(&packed64_backend, nb_rows, nb_columns).rows;
 }
 
 /**
@@ -33,9 +51,7 @@ int **init_non_binary_matrix(unsigned int nb_rows, unsigned int nb_columns)
 
 void free_matrix(bit **matrix, unsigned int nb_rows)
 {
-    for (unsigned int i = 0; i < nb_rows; i++)
-        free(matrix[i]);
-    free(matrix);
+    free_backend_matrix(bits_backend_matrix(matrix, nb_rows, 0));
 }
 
 void free_non_binary_matrix(int **matrix, unsigned int nb_rows)
@@ -52,18 +68,7 @@ void free_non_binary_matrix(int **matrix, unsigned int nb_rows)
  */
 bit **create_identity_matrix(unsigned int nb_rows)
 {
-    bit **identity = init_matrix(nb_rows, nb_rows);
-    for (unsigned int i = 0; i < nb_rows; i++)
-    {
-        for (unsigned int j = 0; j < nb_rows; j++)
-        {
-            if (i == j)
-                identity[i][j].value = 1;
-            else
-                identity[i][j].value = 0;
-        }
-    }
-    return identity;
+    return (bit **)create_backend_identity_matrix(&packed64_backend, nb_rows).rows;
 }
 
 void print_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
@@ -75,14 +80,50 @@ void print_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
         for (int j = 0; j < nb_columns; j++)
         {
             if (j != nb_columns - 1)
-                printf("%d, ", matrix[i][j].value);
+                printf("%d, ", get_matrix_bit(matrix, i, j));
             else
-                printf("%d", matrix[i][j].value);
+                printf("%d", get_matrix_bit(matrix, i, j));
         }
         printf("]\n");
     }
 }
 
+/**
+ * Bit of a row.
+ *
+ * @param line row of a matrix
+ * @param j index of the column
+ * @return the bit j
+ */
+unsigned int get_line_bit(const bit *line, unsigned int j)
+{
+    // Bit j of a packed64 row is bit j % 64 of word j / 64
+    return (((const uint64_t *)line)[j / WORD_SIZE] >> (j % WORD_SIZE)) & 1;
+}
+
+/**
+ * Set a bit of a row.
+ *
+ * @param line row of a matrix
+ * @param j index of the column, below the number of columns of the row
+ * @param value 0 or 1
+ */
+void set_line_bit(bit *line, unsigned int j, unsigned int value)
+{
+    uint64_t *word = (uint64_t *)line + j / WORD_SIZE;
+    *word = (*word & ~((uint64_t)1 << (j % WORD_SIZE))) | ((uint64_t)(value & 1) << (j % WORD_SIZE));
+}
+
+unsigned int get_matrix_bit(bit **matrix, unsigned int i, unsigned int j)
+{
+    return get_line_bit(matrix[i], j);
+}
+
+void set_matrix_bit(bit **matrix, unsigned int i, unsigned int j, unsigned int value)
+{
+    set_line_bit(matrix[i], j, value);
+}
+
 /**
  * Copy a binary matrix.
  *
@@ -93,45 +134,24 @@ void print_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
  */
 bit **copy_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
-    bit **matrix_copy = init_matrix(nb_rows, nb_columns);
-    for (unsigned int i = 0; i < nb_rows; i++)
-    {
-        for (unsigned int j = 0; j < nb_columns; j++)
-        {
-            matrix_copy[i][j].value = matrix[i][j].value;
-        }
-    }
-    return matrix_copy;
+    return (bit **)copy_backend_matrix(bits_backend_matrix(matrix, nb_rows, nb_columns)).rows;
 }
 
 /**
- * Randomize the matrix to a given hamming weight.
+ * Randomize the matrix to a given hamming weight, target_weight_backend_matrix on the packed64 rows.
+ * The support is drawn by the constant time sampler of drbg.c, so every vector of this weight is
+ * equally likely and the number of random draws does not depend on the matrix.
  * Mainly used for the error init.
  *
+ * @param generator random generator
  * @param matrix matrix to get to the hamming weight
  * @param nb_rows number of rows
  * @param nb_columns number of columns
- * @param weight hamming weight
+ * @param weight hamming weight, at most nb_rows * nb_columns
  */
-void target_weight_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns, unsigned int weight)
+void target_weight_matrix(drbg *generator, bit **matrix, unsigned int nb_rows, unsigned int nb_columns, unsigned int weight)
 {
-    unsigned int weight_matrix = 0;
-    for (unsigned int i = 0; i < nb_rows; i++)
-    {
-        for (unsigned int j = 0; j < nb_columns; j++)
-        {
-            unsigned int r = rand() % 2;
-            if (r == 1 && weight_matrix < weight)
-            {
-                matrix[i][j].value = r;
-                weight_matrix++;
-            }
-            else
-            {
-                matrix[i][j].value = 0;
-            }
-        }
-    }
+    target_weight_backend_matrix(generator, bits_backend_matrix(matrix, nb_rows, nb_columns), weight);
 }
 
 /**
@@ -143,13 +163,15 @@ void target_weight_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_co
  */
 void randomize_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(nb_columns));
     for (unsigned int i = 0; i < nb_rows; i++)
     {
+        memset(words, 0, sizeof(uint64_t) * NB_WORDS(nb_columns));
         for (unsigned int j = 0; j < nb_columns; j++)
-        {
-            matrix[i][j].value = rand() % 2;
-        }
+            words[j / WORD_SIZE] |= (uint64_t)(rand() % 2) << (j % WORD_SIZE);
+        packed64_backend.unpack_row(matrix[i], nb_columns, words);
     }
+    free(words);
 }
 
 /**
@@ -175,12 +197,11 @@ void swap_lines(bit **matrix, unsigned int line1, unsigned int line2)
  */
 void add_line(bit *line1, bit *line2, unsigned int nb_columns)
 {
-    for (int i = 0; i < nb_columns; i++)
-        line1[i].value = (line1[i].value ^ line2[i].value);
+    packed64_backend.add_row(line1, line2, nb_columns);
 }
 
 /**
- * Transposition of a matrix.
+ * Transposition of a matrix, transpose_backend_matrix on the packed64 rows.
  *
  * @param matrix matrix to transpose
  * @param nb_rows number of rows
@@ -189,38 +210,26 @@ void add_line(bit *line1, bit *line2, unsigned int nb_columns)
  */
 bit **transpose_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
-    bit **transposed_matrix = init_matrix(nb_columns, nb_rows);
-    for (int i = 0; i < nb_columns; i++)
-    {
-        for (int j = 0; j < nb_rows; j++)
-            transposed_matrix[i][j].value = matrix[j][i].value;
-    }
-    return transposed_matrix;
+    return (bit **)transpose_backend_matrix(bits_backend_matrix(matrix, nb_rows, nb_columns)).rows;
 }
 
 /**
- * Rotation of a matrix
+ * Rotation of a matrix, rotation_backend_matrix on the packed64 rows.
  * @param matrix matrix to rotate
  * @param nb_rows number of rows
  * @param nb_columns number of columns
- * @return the rotated matrix (keeping the source)
+ * @param nb_rotation number of positions
+ * @param direction_rotation LEFT or RIGHT
+ * @return the rotated matrix (keeping the source), bit j of a row is bit (j + direction_rotation * nb_rotation) mod nb_columns of the source
  *
  */
 bit **rotation_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns, unsigned int nb_rotation, int direction_rotation)
 {
-    bit **rotated_matrix = init_matrix(nb_columns, nb_rows);
-    for (int i = 0; i < nb_rows; i++)
-    {
-        for (int j = 0; j < nb_columns; j++)
-        {
-            rotated_matrix[i][j] = matrix[i][(j + direction_rotation * nb_rotation) % nb_columns];
-        }
-    }
-    return rotated_matrix;
+    return (bit **)rotation_backend_matrix(bits_backend_matrix(matrix, nb_rows, nb_columns), nb_rotation, direction_rotation).rows;
 }
 
 /**
- * Concatenation of two matrix
+ * Concatenation of two matrix, concatenation_backend_matrix on the packed64 rows.
  * @param matrix1 first matrix to concatenate
  * @param matrix2 first matrix to concatenate
  * @param nb_rows_matrix1 number of rows of first matrix
@@ -233,88 +242,25 @@ bit **rotation_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_column
 bit **concatenation_matrix(bit **matrix1, bit **matrix2, unsigned int nb_rows_matrix1, unsigned int nb_columns_matrix1, unsigned int nb_rows_matrix2, unsigned int nb_columns_matrix2)
 {
     assert(nb_rows_matrix1 == nb_rows_matrix2);
-    bit **concatenated_matrix = init_matrix(nb_rows_matrix1, nb_columns_matrix1 + nb_columns_matrix2);
-    for (int i = 0; i < nb_rows_matrix1; i++)
-    {
-        for (int j = 0; j < nb_rows_matrix1; j++)
-        {
-            concatenated_matrix[i][j] = matrix1[i][j];
-        }
-        for (int k = 0; k < nb_columns_matrix2; k++)
-        {
-            concatenated_matrix[i][k + nb_columns_matrix1] = matrix2[i][k];
-        }
-    }
-    return concatenated_matrix;
+    return (bit **)concatenation_backend_matrix(bits_backend_matrix(matrix1, nb_rows_matrix1, nb_columns_matrix1), bits_backend_matrix(matrix2, nb_rows_matrix2, nb_columns_matrix2)).rows;
 }
 
 /**
- * Matrix inversion using Gauss - Jordan.
- * Heavily inspired by https://dde.binghamton.edu/filler/mct/hw/1/assignment.pdf
+ * Matrix inversion using Gauss - Jordan, inversion_backend_matrix on the packed64 rows.
  *
  * @param m matrix to invert
  * @param nb_rows number of rows
- * @param nb_columns number of columns
- * @return the inverted matrix (keeping the source)
+ * @param nb_columns number of columns, equal to nb_rows
+ * @return the inverted matrix (keeping the source), NULL if the matrix is not invertible
  */
 bit **inversion_matrix(bit **m, unsigned int nb_rows, unsigned int nb_columns)
 {
-    bit **matrix = copy_matrix(m, nb_rows, nb_columns);
-    bit **inverted_matrix = create_identity_matrix(nb_rows);
-
-    for (int i = 0; i < nb_columns; i++)
-    {
-        int maxi = i;
-
-        for (int k = i; k < nb_rows; k++)
-        {
-            if (matrix[k][i].value == 1)
-            {
-                maxi = k;
-            }
-        }
-
-        if (matrix[maxi][i].value == 1)
-        {
-            swap_lines(matrix, i, maxi);
-            swap_lines(inverted_matrix, i, maxi);
-
-            for (int u = i + 1; u < nb_columns; u++)
-            {
-                if (matrix[u][i].value != 0)
-                {
-                    add_line(matrix[u], matrix[i], nb_columns);
-                    add_line(inverted_matrix[u], inverted_matrix[i], nb_columns);
-                }
-            }
-        }
-    }
-    // Matrix is upper so we need to reduce it to have identity matrix
-    int is_inversible;
-    if (matrix_is_upper(matrix, nb_rows, nb_columns))
-    {
-        is_inversible = 1;
-        // Start from the last column and add every time there is a 1 not in the [i][i]columns
-        int current_column = nb_columns - 1;
-        while (current_column != 0)
-        {
-            for (int i = nb_rows - 1; i >= 0; i--)
-            {
-                if (matrix[i][current_column].value == 1 && i != current_column)
-                {
-                    add_line(matrix[i], matrix[current_column], nb_columns);
-                    add_line(inverted_matrix[i], inverted_matrix[current_column], nb_columns);
-                }
-            }
-            current_column--;
-        }
-    }
-    free_matrix(matrix, nb_rows);
-
-    if (is_inversible)
-        return inverted_matrix;
-    else
-        return NULL;
+    int is_invertible;
+    backend_matrix inverse = inversion_backend_matrix(bits_backend_matrix(m, nb_rows, nb_columns), &is_invertible);
+    if (is_invertible)
+        return (bit **)inverse.rows;
+    free_backend_matrix(inverse);
+    return NULL;
 }
 
 /**
@@ -329,43 +275,45 @@ bit **inversion_matrix(bit **m, unsigned int nb_rows, unsigned int nb_columns)
  */
 void add_matrix(bit **matrix1, bit **matrix2, unsigned int nb_rows, unsigned nb_columns, unsigned int start)
 {
-    for (int i = 0; i < nb_rows; i++)
+    // Word k of the added part is made of the words start / WORD_SIZE + k and the next one of matrix2
+    unsigned int first = start / WORD_SIZE;
+    unsigned int offset = start % WORD_SIZE;
+    unsigned int nb_words2 = NB_WORDS(start + nb_columns);
+    uint64_t last_mask = nb_columns % WORD_SIZE == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (nb_columns % WORD_SIZE)) - 1;
+    for (unsigned int i = 0; i < nb_rows; i++)
     {
-        for (int j = 0; j < nb_columns; j++)
-            matrix1[i][j].value ^= matrix2[i][start + j].value;
+        uint64_t *words1 = line_words(matrix1[i]);
+        const uint64_t *words2 = const_line_words(matrix2[i]);
+        for (unsigned int k = 0; k < NB_WORDS(nb_columns); k++)
+        {
+            uint64_t word = words2[first + k] >> offset;
+            if (offset != 0 && first + k + 1 < nb_words2)
+                word |= words2[first + k + 1] << (WORD_SIZE - offset);
+            if (k == NB_WORDS(nb_columns) - 1)
+                word &= last_mask;
+            words1[k] ^= word;
+        }
     }
 }
 
 /**
- * Multiplication of two binary matrix.
+ * Multiplication of two binary matrix, multiply_backend_matrix on the packed64 rows.
  * nb_columns_matrix1 must be equals to nb_rows_matrix2
- * Inspiration from https://www.geeksforgeeks.org/c-matrix-multiplication/
  *
  * @param matrix1 matrix to multiply with
  * @param matrix2 matrix to get multiplied
- * @param nb_rows_matrix1 number of columns
+ * @param nb_rows_matrix1 number of rows
  * @param nb_columns_matrix1 number of columns
- * @param nb_rows_matrix2 number of columns
+ * @param nb_rows_matrix2 number of rows
  * @param nb_columns_matrix2 number of columns
  *
  * @return the multiplication of both (nb_rows_matrix1 x nb_columns_matrix2)
  */
 bit **multiply_matrix(bit **matrix1, bit **matrix2, unsigned int nb_rows_matrix1, unsigned int nb_columns_matrix1, unsigned int nb_rows_matrix2, unsigned int nb_columns_matrix2)
 {
-    bit **result = init_matrix(nb_rows_matrix1, nb_columns_matrix2);
-    for (int i = 0; i < nb_rows_matrix1; i++)
-    {
-        for (int j = 0; j < nb_columns_matrix2; j++)
-        {
-            result[i][j].value = 0;
-
-            for (int k = 0; k < nb_rows_matrix2; k++)
-            {
-                result[i][j].value += matrix1[i][k].value * matrix2[k][j].value;
-            }
-        }
-    }
-    return result;
+    assert(nb_columns_matrix1 == nb_rows_matrix2);
+    backend_matrix product = multiply_backend_matrix(bits_backend_matrix(matrix1, nb_rows_matrix1, nb_columns_matrix1), bits_backend_matrix(matrix2, nb_rows_matrix2, nb_columns_matrix2));
+    return (bit **)product.rows;
 }
 
 /**
@@ -384,13 +332,23 @@ bit **multiply_matrix(bit **matrix1, bit **matrix2, unsigned int nb_rows_matrix1
  */
 int **multiply_non_binary_matrix(bit **matrix1, bit **matrix2, unsigned int nb_rows_matrix1, unsigned int nb_columns_matrix1, unsigned int nb_rows_matrix2, unsigned int nb_columns_matrix2)
 {
+    assert(nb_columns_matrix1 == nb_rows_matrix2);
     int **result = init_non_binary_matrix(nb_rows_matrix1, nb_columns_matrix2);
-    for (int i = 0; i < nb_rows_matrix1; i++)
+    // Each pair of bits set in row i of matrix1 and in the corresponding row k of matrix2 counts once
+    for (unsigned int i = 0; i < nb_rows_matrix1; i++)
     {
-        for (int j = 0; j < nb_columns_matrix2; j++)
+        const uint64_t *words1 = const_line_words(matrix1[i]);
+        for (unsigned int l = 0; l < NB_WORDS(nb_columns_matrix1); l++)
         {
-            for (int k = 0; k < nb_rows_matrix2; k++)
-                result[i][j] += matrix1[i][k].value * matrix2[k][j].value;
+            for (uint64_t word1 = words1[l]; word1 != 0; word1 &= word1 - 1)
+            {
+                const uint64_t *words2 = const_line_words(matrix2[l * WORD_SIZE + __builtin_ctzll(word1)]);
+                for (unsigned int m = 0; m < NB_WORDS(nb_columns_matrix2); m++)
+                {
+                    for (uint64_t word2 = words2[m]; word2 != 0; word2 &= word2 - 1)
+                        result[i][m * WORD_SIZE + __builtin_ctzll(word2)]++;
+                }
+            }
         }
     }
     return result;
@@ -407,13 +365,18 @@ int **multiply_non_binary_matrix(bit **matrix1, bit **matrix2, unsigned int nb_r
  */
 int matrix_is_upper(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
-    for (int i = 0; i < nb_rows; i++)
+    // Bits 0 to i - 1 of row i, the full words then the low bits of word i / WORD_SIZE
+    for (unsigned int i = 0; i < nb_rows; i++)
     {
-        for (int j = 0; j < i; j++)
+        const uint64_t *words = const_line_words(matrix[i]);
+        unsigned int limit = i < nb_columns ? i : nb_columns;
+        for (unsigned int k = 0; k < limit / WORD_SIZE; k++)
         {
-            if (matrix[i][j].value == 1)
+            if (words[k] != 0)
                 return 0;
         }
+        if (limit % WORD_SIZE != 0 && (words[limit / WORD_SIZE] & (((uint64_t)1 << (limit % WORD_SIZE)) - 1)) != 0)
+            return 0;
     }
     return 1;
 }
@@ -428,27 +391,15 @@ int matrix_is_upper(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
  */
 unsigned int hamming_weight(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
-    unsigned int nb_bit_one = 0;
-    for (int i = 0; i < nb_rows; i++)
-    {
-        for (int j = 0; j < nb_columns; j++)
-        {
-            if (matrix[i][j].value == 1)
-                nb_bit_one++;
-        }
-    }
-    return nb_bit_one;
+    return backend_hamming_weight(bits_backend_matrix(matrix, nb_rows, nb_columns));
 }
 
 int is_matrix_null(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
 {
-    for (int i = 0; i < nb_rows; i++)
+    for (unsigned int i = 0; i < nb_rows; i++)
     {
-        for (int j = 0; j < nb_columns; j++)
-        {
-            if (matrix[i][j].value == 1)
-                return 0;
-        }
+        if (packed64_backend.row_weight(matrix[i], nb_columns) != 0)
+            return 0;
     }
     return 1;
 }
@@ -463,8 +414,6 @@ int is_matrix_null(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
  */
 void shift_line(bit *line_to_modify, bit *initial_line, unsigned int nb_columns, unsigned int shift_size)
 {
-    for (int i = 0; i < nb_columns; i++)
-    {
-        line_to_modify[i].value = initial_line[(i + shift_size) % nb_columns].value;
-    }
+    // Bit i is bit i + shift_size of the initial line : the initial line times X^-shift_size
+    rotate_ring(const_line_words(initial_line), (nb_columns - shift_size % nb_columns) % nb_columns, nb_columns, line_words(line_to_modify));
 }
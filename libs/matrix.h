@@ -5,18 +5,18 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <time.h>
+#include "drbg.h"
 
 // Arbitrary values for rotation types
 #define LEFT -1
 #define RIGHT 1
 
 /**
- * Represents a one bit unsigned int value
+ * Row of a binary matrix : a row of the packed64 backend of matrix_backend.h, the bits are packed
+ * in 64 bits words. A matrix is an array of rows (bit **), swapped by pointer. The bits are read
+ * and written with get_matrix_bit and set_matrix_bit, or get_line_bit and set_line_bit on a row.
  */
-typedef struct
-{
-    unsigned int value : 1; /** Unsigned int on one bit only*/
-} bit;
+typedef struct bit bit;
 
 // Creation and Destruction of binary Matrix
 
@@ -27,11 +27,18 @@ bit **create_identity_matrix(unsigned int nb_rows);
 
 void print_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
 
+// Access to the bits
+
+unsigned int get_line_bit(const bit *line, unsigned int j);
+void set_line_bit(bit *line, unsigned int j, unsigned int value);
+unsigned int get_matrix_bit(bit **matrix, unsigned int i, unsigned int j);
+void set_matrix_bit(bit **matrix, unsigned int i, unsigned int j, unsigned int value);
+
 // Operations on binary Matrix
 
 bit **copy_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
 
-void target_weight_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns, unsigned int weight);
+void target_weight_matrix(drbg *generator, bit **matrix, unsigned int nb_rows, unsigned int nb_columns, unsigned int weight);
 void randomize_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
 
 bit **transpose_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
@@ -0,0 +1,656 @@
+#include "matrix_backend.h"
+#include "../libs_optimized/packed_backends.h"
+
+/**
+ * Matrix algorithms written once on the row operations of a backend.
+ * The reference backend stores one byte per coefficient, without word operations,
+ * the packed backends of packed_backends.c store them in machine words.
+ */
+
+// Reference backend : one byte per bit, the baseline of the other backends
+
+static void *reference_init_row(unsigned int nb_columns)
+{
+    return calloc(nb_columns, sizeof(uint8_t));
+}
+
+static void reference_free_row(void *row)
+{
+    free(row);
+}
+
+static unsigned int reference_get_bit(const void *row, unsigned int nb_columns, unsigned int j)
+{
+    (void)nb_columns;
+    return ((const uint8_t *)row)[j];
+}
+
+static void reference_set_bit(void *row, unsigned int nb_columns, unsigned int j, unsigned int value)
+{
+    (void)nb_columns;
+    ((uint8_t *)row)[j] = value;
+}
+
+static void reference_add_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    for (unsigned int j = 0; j < nb_columns; j++)
+        ((uint8_t *)row1)[j] ^= ((const uint8_t *)row2)[j];
+}
+
+static void reference_copy_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    memcpy(row1, row2, sizeof(uint8_t) * nb_columns);
+}
+
+static unsigned int reference_row_weight(const void *row, unsigned int nb_columns)
+{
+    unsigned int weight = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+        weight += ((const uint8_t *)row)[j];
+    return weight;
+}
+
+static void reference_row_support(const void *row, unsigned int nb_columns, int *support)
+{
+    unsigned int size = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+    {
+        if (((const uint8_t *)row)[j])
+            support[size++] = j;
+    }
+}
+
+static void reference_pack_row(const void *row, unsigned int nb_columns, uint64_t *words)
+{
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        words[i] = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+        words[j / WORD_SIZE] |= (uint64_t)((const uint8_t *)row)[j] << (j % WORD_SIZE);
+}
+
+static void reference_unpack_row(void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    for (unsigned int j = 0; j < nb_columns; j++)
+        ((uint8_t *)row)[j] = (words[j / WORD_SIZE] >> (j % WORD_SIZE)) & 1;
+}
+
+static unsigned int reference_row_dot(const void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    unsigned int parity = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+        parity ^= ((const uint8_t *)row)[j] & (words[j / WORD_SIZE] >> (j % WORD_SIZE));
+    return parity & 1;
+}
+
+static void reference_gather_column(void *const *rows, unsigned int nb_rows, unsigned int nb_columns, unsigned int j, uint64_t *words)
+{
+    (void)nb_columns;
+    for (unsigned int i = 0; i < NB_WORDS(nb_rows); i++)
+        words[i] = 0;
+    for (unsigned int i = 0; i < nb_rows; i++)
+        words[i / WORD_SIZE] |= (uint64_t)((const uint8_t *)rows[i])[j] << (i % WORD_SIZE);
+}
+
+const matrix_backend reference_backend = {
+    "reference",
+    reference_init_row,
+    reference_free_row,
+    reference_get_bit,
+    reference_set_bit,
+    reference_add_row,
+    reference_copy_row,
+    reference_row_weight,
+    reference_row_support,
+    reference_pack_row,
+    reference_unpack_row,
+    reference_row_dot,
+    reference_gather_column,
+};
+
+// Backends chosen by name, the first one is the default
+static const matrix_backend *matrix_backends[] = {&packed64_backend, &simd_backend, &packed32_backend, &reference_backend};
+
+/**
+ * Get a backend from its name.
+ *
+ * @param name reference, packed32, packed64 or simd
+ * @return the backend, NULL if the name is unknown
+ */
+const matrix_backend *find_matrix_backend(const char *name)
+{
+    for (int i = 0; i < (int)(sizeof(matrix_backends) / sizeof(matrix_backends[0])); i++)
+    {
+        if (strcmp(name, matrix_backends[i]->name) == 0)
+            return matrix_backends[i];
+    }
+    return NULL;
+}
+
+/**
+ * Same as find_matrix_backend for the command lines.
+ *
+ * @param name reference, packed32, packed64 or simd
+ * @return the backend, the default one if the name is unknown
+ */
+const matrix_backend *parse_matrix_backend(const char *name)
+{
+    const matrix_backend *backend = find_matrix_backend(name);
+    if (backend != NULL)
+        return backend;
+    printf("Unknown matrix backend %s, using %s\n", name, default_matrix_backend()->name);
+    return default_matrix_backend();
+}
+
+const matrix_backend *default_matrix_backend(void)
+{
+    return matrix_backends[0];
+}
+
+/**
+ * Initialize a null matrix.
+ *
+ * @param backend storage of the rows
+ * @param nb_rows number of rows
+ * @param nb_columns number of columns
+ * @return the matrix
+ */
+backend_matrix init_backend_matrix(const matrix_backend *backend, unsigned int nb_rows, unsigned int nb_columns)
+{
+    backend_matrix matrix;
+    matrix.backend = backend;
+    matrix.nb_rows = nb_rows;
+    matrix.nb_columns = nb_columns;
+    matrix.rows = (void **)malloc(sizeof(void *) * nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+        matrix.rows[i] = backend->init_row(nb_columns);
+    return matrix;
+}
+
+void free_backend_matrix(backend_matrix matrix)
+{
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+        matrix.backend->free_row(matrix.rows[i]);
+    free(matrix.rows);
+}
+
+backend_matrix create_backend_identity_matrix(const matrix_backend *backend, unsigned int nb_rows)
+{
+    backend_matrix identity = init_backend_matrix(backend, nb_rows, nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+        backend->set_bit(identity.rows[i], nb_rows, i, 1);
+    return identity;
+}
+
+backend_matrix copy_backend_matrix(backend_matrix matrix)
+{
+    backend_matrix copy = init_backend_matrix(matrix.backend, matrix.nb_rows, matrix.nb_columns);
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+        matrix.backend->copy_row(copy.rows[i], matrix.rows[i], matrix.nb_columns);
+    return copy;
+}
+
+/**
+ * Copy of a matrix in another backend.
+ *
+ * @param matrix matrix to convert
+ * @param backend backend of the result
+ * @return the converted matrix (keeping the source)
+ */
+backend_matrix convert_backend_matrix(backend_matrix matrix, const matrix_backend *backend)
+{
+    backend_matrix converted = init_backend_matrix(backend, matrix.nb_rows, matrix.nb_columns);
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(matrix.nb_columns));
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+    {
+        matrix.backend->pack_row(matrix.rows[i], matrix.nb_columns, words);
+        backend->unpack_row(converted.rows[i], matrix.nb_columns, words);
+    }
+    free(words);
+    return converted;
+}
+
+/**
+ * A bit ** matrix of matrix.c as a matrix of the packed64 backend, without copy :
+ * its rows are packed64 rows.
+ *
+ * @param matrix rows of the matrix, owned by the caller
+ * @param nb_rows number of rows
+ * @param nb_columns number of columns
+ * @return the matrix, sharing the rows of matrix
+ */
+backend_matrix bits_backend_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
+{
+    backend_matrix wrapped;
+    wrapped.backend = &packed64_backend;
+    wrapped.rows = (void **)matrix;
+    wrapped.nb_rows = nb_rows;
+    wrapped.nb_columns = nb_columns;
+    return wrapped;
+}
+
+/**
+ * Copy of a bit ** matrix of matrix.c in a backend.
+ *
+ * @param backend backend of the result
+ * @param matrix matrix to convert
+ * @param nb_rows number of rows
+ * @param nb_columns number of columns
+ * @return the converted matrix (keeping the source)
+ */
+backend_matrix backend_matrix_from_bits(const matrix_backend *backend, bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
+{
+    return convert_backend_matrix(bits_backend_matrix(matrix, nb_rows, nb_columns), backend);
+}
+
+/**
+ * Copy of a matrix in a bit ** matrix of matrix.c.
+ *
+ * @param matrix matrix to convert
+ * @return the converted matrix (keeping the source), freed by free_matrix
+ */
+bit **backend_matrix_to_bits(backend_matrix matrix)
+{
+    return (bit **)convert_backend_matrix(matrix, &packed64_backend).rows;
+}
+
+unsigned int get_backend_bit(backend_matrix matrix, unsigned int i, unsigned int j)
+{
+    return matrix.backend->get_bit(matrix.rows[i], matrix.nb_columns, j);
+}
+
+void set_backend_bit(backend_matrix matrix, unsigned int i, unsigned int j, unsigned int value)
+{
+    matrix.backend->set_bit(matrix.rows[i], matrix.nb_columns, j, value);
+}
+
+/**
+ * Support of a row.
+ *
+ * @param matrix matrix
+ * @param i index of the row
+ * @return the sorted indices of the bits set, freed by the caller
+ */
+polynome backend_row_support(backend_matrix matrix, unsigned int i)
+{
+    polynome support;
+    support.size = matrix.backend->row_weight(matrix.rows[i], matrix.nb_columns);
+    support.liste_indice = (int *)malloc(sizeof(int) * support.size);
+    matrix.backend->row_support(matrix.rows[i], matrix.nb_columns, support.liste_indice);
+    return support;
+}
+
+/**
+ * Copy a row in packed words : bit j is bit j % WORD_SIZE of word j / WORD_SIZE.
+ *
+ * @param matrix matrix
+ * @param i index of the row
+ * @param words result, NB_WORDS(nb_columns) words
+ */
+void pack_backend_row(backend_matrix matrix, unsigned int i, uint64_t *words)
+{
+    matrix.backend->pack_row(matrix.rows[i], matrix.nb_columns, words);
+}
+
+/**
+ * Set a row from packed words, the inverse of pack_backend_row.
+ *
+ * @param matrix matrix
+ * @param i index of the row
+ * @param words NB_WORDS(nb_columns) words, the bits after nb_columns are ignored
+ */
+void unpack_backend_row(backend_matrix matrix, unsigned int i, const uint64_t *words)
+{
+    matrix.backend->unpack_row(matrix.rows[i], matrix.nb_columns, words);
+}
+
+/**
+ * Set every bit of a matrix at random.
+ *
+ * @param generator random generator
+ * @param matrix matrix to fill
+ */
+void randomize_backend_matrix(drbg *generator, backend_matrix matrix)
+{
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(matrix.nb_columns));
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+    {
+        for (unsigned int k = 0; k < NB_WORDS(matrix.nb_columns); k++)
+            words[k] = random_drbg(generator);
+        matrix.backend->unpack_row(matrix.rows[i], matrix.nb_columns, words);
+    }
+    free(words);
+}
+
+/**
+ * Set a matrix to a random one of a given weight, the support is drawn by the constant time sampler.
+ *
+ * @param generator random generator
+ * @param matrix matrix to fill
+ * @param weight hamming weight, at most nb_rows * nb_columns
+ */
+void target_weight_backend_matrix(drbg *generator, backend_matrix matrix, unsigned int weight)
+{
+    int *support = (int *)malloc(sizeof(int) * weight);
+    sample_support(generator, support, weight, matrix.nb_rows * matrix.nb_columns);
+    uint64_t *words = (uint64_t *)calloc(NB_WORDS(matrix.nb_columns), sizeof(uint64_t));
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+        matrix.backend->unpack_row(matrix.rows[i], matrix.nb_columns, words);
+    free(words);
+    for (unsigned int k = 0; k < weight; k++)
+        set_backend_bit(matrix, support[k] / matrix.nb_columns, support[k] % matrix.nb_columns, 1);
+    free(support);
+}
+
+/**
+ * Add a matrix to another one with the same sizes.
+ *
+ * @param matrix1 result, matrix1 += matrix2
+ * @param matrix2 added matrix, in the same backend
+ */
+void add_backend_matrix(backend_matrix matrix1, backend_matrix matrix2)
+{
+    assert(matrix1.nb_rows == matrix2.nb_rows && matrix1.nb_columns == matrix2.nb_columns && matrix1.backend == matrix2.backend);
+    for (unsigned int i = 0; i < matrix1.nb_rows; i++)
+        matrix1.backend->add_row(matrix1.rows[i], matrix2.rows[i], matrix1.nb_columns);
+}
+
+/**
+ * Scratch of the fused kernels for products A * x, allocated once for a loop of products.
+ *
+ * @param backend backend of A and x
+ * @param nb_columns number of columns of A, and rows of x
+ * @param nb_x_columns number of columns of x
+ * @return the workspace, freed by free_backend_workspace
+ */
+backend_workspace init_backend_workspace(const matrix_backend *backend, unsigned int nb_columns, unsigned int nb_x_columns)
+{
+    backend_workspace workspace;
+    workspace.backend = backend;
+    workspace.nb_columns = nb_columns;
+    workspace.nb_x_columns = nb_x_columns;
+    workspace.column = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(nb_columns));
+    workspace.words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(nb_columns));
+    workspace.support = (int *)malloc(sizeof(int) * nb_columns);
+    workspace.row = backend->init_row(nb_x_columns);
+    return workspace;
+}
+
+void free_backend_workspace(backend_workspace workspace)
+{
+    free(workspace.column);
+    free(workspace.words);
+    free(workspace.support);
+    workspace.backend->free_row(workspace.row);
+}
+
+/**
+ * Multiply - accumulate : y += A * x, without storing A * x.
+ * Row i of A * x is the sum of the rows k of x for the bits k set in row i of A, so the cost
+ * follows the weight of A. When x is a column, it is packed once in the workspace and bit i
+ * of A * x is the parity of row i of A and x, read in place by row_dot.
+ *
+ * @param y result, nb_rows of A x nb_columns of x, in the backend of A
+ * @param A left matrix
+ * @param x right matrix, in the backend of A, with nb_columns of A rows
+ * @param workspace scratch for nb_columns of A and nb_columns of x
+ */
+void multiply_add_backend_matrix(backend_matrix y, backend_matrix A, backend_matrix x, backend_workspace workspace)
+{
+    assert(A.nb_columns == x.nb_rows && A.backend == x.backend && A.backend == y.backend);
+    assert(y.nb_rows == A.nb_rows && y.nb_columns == x.nb_columns);
+    assert(workspace.backend == A.backend && workspace.nb_columns == A.nb_columns && workspace.nb_x_columns == x.nb_columns);
+    const matrix_backend *backend = A.backend;
+    if (x.nb_columns == 1)
+    {
+        backend->gather_column(x.rows, x.nb_rows, 1, 0, workspace.column);
+        for (unsigned int i = 0; i < A.nb_rows; i++)
+        {
+            if (backend->row_dot(A.rows[i], A.nb_columns, workspace.column))
+                backend->set_bit(y.rows[i], 1, 0, !backend->get_bit(y.rows[i], 1, 0));
+        }
+        return;
+    }
+    for (unsigned int i = 0; i < A.nb_rows; i++)
+    {
+        unsigned int weight = backend->row_weight(A.rows[i], A.nb_columns);
+        backend->row_support(A.rows[i], A.nb_columns, workspace.support);
+        for (unsigned int k = 0; k < weight; k++)
+            backend->add_row(y.rows[i], x.rows[workspace.support[k]], x.nb_columns);
+    }
+}
+
+// A^T * x for a column x : sum of the rows i of A for the bits i set in x, in workspace.column
+static void sum_selected_rows(backend_matrix A, backend_matrix x, backend_workspace workspace)
+{
+    const matrix_backend *backend = A.backend;
+    for (unsigned int k = 0; k < NB_WORDS(A.nb_columns); k++)
+        workspace.column[k] = 0;
+    for (unsigned int i = 0; i < A.nb_rows; i++)
+    {
+        if (!backend->get_bit(x.rows[i], 1, 0))
+            continue;
+        backend->pack_row(A.rows[i], A.nb_columns, workspace.words);
+        for (unsigned int k = 0; k < NB_WORDS(A.nb_columns); k++)
+            workspace.column[k] ^= workspace.words[k];
+    }
+}
+
+/**
+ * Transpose - multiply - accumulate : y += A^T * x, without transposing A.
+ * Row i of A is column i of A^T, so row i of x is added to the rows of y given by the support
+ * of row i of A. When x is a column, A^T * x is the sum of the rows i of A for the bits i set
+ * in x, packed in the workspace.
+ *
+ * @param y result, nb_columns of A x nb_columns of x, in the backend of A
+ * @param A matrix to transpose
+ * @param x right matrix, in the backend of A, with nb_rows of A rows
+ * @param workspace scratch for nb_columns of A and nb_columns of x
+ */
+void transpose_multiply_backend_matrix(backend_matrix y, backend_matrix A, backend_matrix x, backend_workspace workspace)
+{
+    assert(A.nb_rows == x.nb_rows && A.backend == x.backend && A.backend == y.backend);
+    assert(y.nb_rows == A.nb_columns && y.nb_columns == x.nb_columns);
+    assert(workspace.backend == A.backend && workspace.nb_columns == A.nb_columns && workspace.nb_x_columns == x.nb_columns);
+    const matrix_backend *backend = A.backend;
+    if (x.nb_columns == 1)
+    {
+        sum_selected_rows(A, x, workspace);
+        for (unsigned int k = 0; k < NB_WORDS(A.nb_columns); k++)
+        {
+            for (uint64_t word = workspace.column[k]; word != 0; word &= word - 1)
+            {
+                unsigned int j = k * WORD_SIZE + __builtin_ctzll(word);
+                backend->set_bit(y.rows[j], 1, 0, !backend->get_bit(y.rows[j], 1, 0));
+            }
+        }
+        return;
+    }
+    for (unsigned int i = 0; i < A.nb_rows; i++)
+    {
+        unsigned int weight = backend->row_weight(A.rows[i], A.nb_columns);
+        backend->row_support(A.rows[i], A.nb_columns, workspace.support);
+        for (unsigned int k = 0; k < weight; k++)
+            backend->add_row(y.rows[workspace.support[k]], x.rows[i], x.nb_columns);
+    }
+}
+
+/**
+ * Multiplication of two matrices, see multiply_add_backend_matrix.
+ *
+ * @param matrix1 left matrix
+ * @param matrix2 right matrix, in the same backend, with nb_columns of matrix1 rows
+ * @return the product (nb_rows of matrix1 x nb_columns of matrix2)
+ */
+backend_matrix multiply_backend_matrix(backend_matrix matrix1, backend_matrix matrix2)
+{
+    backend_matrix product = init_backend_matrix(matrix1.backend, matrix1.nb_rows, matrix2.nb_columns);
+    backend_workspace workspace = init_backend_workspace(matrix1.backend, matrix1.nb_columns, matrix2.nb_columns);
+    multiply_add_backend_matrix(product, matrix1, matrix2, workspace);
+    free_backend_workspace(workspace);
+    return product;
+}
+
+/**
+ * Syndrome - count : hamming weight of H * e, without storing H * e.
+ * Each row of the product is computed in the scratch row of the workspace and counted before the next one.
+ *
+ * @param H left matrix
+ * @param e right matrix, in the backend of H, with nb_columns of H rows
+ * @param workspace scratch for nb_columns of H and nb_columns of e
+ * @return the weight of H * e
+ */
+unsigned int syndrome_weight_backend_matrix(backend_matrix H, backend_matrix e, backend_workspace workspace)
+{
+    assert(H.nb_columns == e.nb_rows && H.backend == e.backend);
+    assert(workspace.backend == H.backend && workspace.nb_columns == H.nb_columns && workspace.nb_x_columns == e.nb_columns);
+    const matrix_backend *backend = H.backend;
+    unsigned int weight = 0;
+    if (e.nb_columns == 1)
+    {
+        backend->gather_column(e.rows, e.nb_rows, 1, 0, workspace.column);
+        for (unsigned int i = 0; i < H.nb_rows; i++)
+            weight += backend->row_dot(H.rows[i], H.nb_columns, workspace.column);
+        return weight;
+    }
+    for (unsigned int i = 0; i < H.nb_rows; i++)
+    {
+        unsigned int row_weight = backend->row_weight(H.rows[i], H.nb_columns);
+        if (row_weight == 0)
+            continue;
+        // The first row of e starts the sum, instead of clearing the scratch row
+        backend->row_support(H.rows[i], H.nb_columns, workspace.support);
+        backend->copy_row(workspace.row, e.rows[workspace.support[0]], e.nb_columns);
+        for (unsigned int k = 1; k < row_weight; k++)
+            backend->add_row(workspace.row, e.rows[workspace.support[k]], e.nb_columns);
+        weight += backend->row_weight(workspace.row, e.nb_columns);
+    }
+    return weight;
+}
+
+/**
+ * Transpose - syndrome - count : hamming weight of H^T * e, without transposing H.
+ * When e is a column, H^T * e is the sum of the rows of H selected by e and only its words are counted,
+ * else it is stored by transpose_multiply_backend_matrix, as no row of it is complete before the last row of H.
+ *
+ * @param H matrix to transpose
+ * @param e right matrix, in the backend of H, with nb_rows of H rows
+ * @param workspace scratch for nb_columns of H and nb_columns of e
+ * @return the weight of H^T * e
+ */
+unsigned int transpose_syndrome_weight_backend_matrix(backend_matrix H, backend_matrix e, backend_workspace workspace)
+{
+    assert(H.nb_rows == e.nb_rows && H.backend == e.backend);
+    assert(workspace.backend == H.backend && workspace.nb_columns == H.nb_columns && workspace.nb_x_columns == e.nb_columns);
+    unsigned int weight = 0;
+    if (e.nb_columns == 1)
+    {
+        sum_selected_rows(H, e, workspace);
+        for (unsigned int k = 0; k < NB_WORDS(H.nb_columns); k++)
+            weight += __builtin_popcountll(workspace.column[k]);
+        return weight;
+    }
+    backend_matrix product = init_backend_matrix(H.backend, H.nb_columns, e.nb_columns);
+    transpose_multiply_backend_matrix(product, H, e, workspace);
+    weight = backend_hamming_weight(product);
+    free_backend_matrix(product);
+    return weight;
+}
+
+/**
+ * Inversion of a square matrix with Gauss - Jordan, the rows are swapped by pointer.
+ * Column j is gathered once per pivot, its bits give the pivot and the rows to reduce.
+ *
+ * @param matrix matrix to invert
+ * @param is_invertible result, 1 if the matrix is invertible, 0 else
+ * @return the inverse (keeping the source), not significant if the matrix is not invertible
+ */
+backend_matrix inversion_backend_matrix(backend_matrix matrix, int *is_invertible)
+{
+    assert(matrix.nb_rows == matrix.nb_columns);
+    const matrix_backend *backend = matrix.backend;
+    unsigned int n = matrix.nb_rows;
+    backend_matrix reduced = copy_backend_matrix(matrix);
+    backend_matrix inverse = create_backend_identity_matrix(backend, n);
+
+    uint64_t *column = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    *is_invertible = 1;
+    for (unsigned int j = 0; j < n && *is_invertible; j++)
+    {
+        backend->gather_column(reduced.rows, n, n, j, column);
+        // First row from j with the bit j set
+        unsigned int pivot = n;
+        uint64_t below = column[j / WORD_SIZE] & (~(uint64_t)0 << (j % WORD_SIZE));
+        for (unsigned int k = j / WORD_SIZE; pivot == n && k < NB_WORDS(n); k++)
+        {
+            uint64_t word = k == j / WORD_SIZE ? below : column[k];
+            if (word != 0)
+                pivot = k * WORD_SIZE + __builtin_ctzll(word);
+        }
+        if (pivot == n)
+        {
+            *is_invertible = 0;
+            break;
+        }
+        void *row = reduced.rows[pivot];
+        reduced.rows[pivot] = reduced.rows[j];
+        reduced.rows[j] = row;
+        row = inverse.rows[pivot];
+        inverse.rows[pivot] = inverse.rows[j];
+        inverse.rows[j] = row;
+
+        // The pivot is now row j and the bit j of the row moved to pivot is null
+        column[pivot / WORD_SIZE] &= ~((uint64_t)1 << (pivot % WORD_SIZE));
+        for (unsigned int k = 0; k < NB_WORDS(n); k++)
+        {
+            for (uint64_t word = column[k]; word != 0; word &= word - 1)
+            {
+                unsigned int i = k * WORD_SIZE + __builtin_ctzll(word);
+                backend->add_row(reduced.rows[i], reduced.rows[j], n);
+                backend->add_row(inverse.rows[i], inverse.rows[j], n);
+            }
+        }
+    }
+
+    free(column);
+    free_backend_matrix(reduced);
+    return inverse;
+}
+
+unsigned int backend_hamming_weight(backend_matrix matrix)
+{
+    unsigned int weight = 0;
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+        weight += matrix.backend->row_weight(matrix.rows[i], matrix.nb_columns);
+    return weight;
+}
+
+/**
+ * Select a random sample of columns from a matrix.
+ *
+ * @param generator random generator
+ * @param matrix matrix to select columns from
+ * @param sample_size number of columns selected
+ * @param columns result, sample_size distinct indices of columns
+ * @return the selected columns, column i is the column columns[i] of the matrix
+ */
+backend_matrix sample_backend_columns(drbg *generator, backend_matrix matrix, unsigned int sample_size, int *columns)
+{
+    const matrix_backend *backend = matrix.backend;
+    backend_matrix sample = init_backend_matrix(backend, matrix.nb_rows, sample_size);
+    uint64_t *source = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(matrix.nb_columns));
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(sample_size));
+
+    sample_support(generator, columns, sample_size, matrix.nb_columns);
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+    {
+        backend->pack_row(matrix.rows[i], matrix.nb_columns, source);
+        for (unsigned int k = 0; k < NB_WORDS(sample_size); k++)
+            words[k] = 0;
+        for (unsigned int j = 0; j < sample_size; j++)
+            words[j / WORD_SIZE] |= ((source[columns[j] / WORD_SIZE] >> (columns[j] % WORD_SIZE)) & 1) << (j % WORD_SIZE);
+        backend->unpack_row(sample.rows[i], sample_size, words);
+    }
+    free(source);
+    free(words);
+    return sample;
+}
@@ -0,0 +1,102 @@
+#ifndef MATRIX_BACKEND_H
+#define MATRIX_BACKEND_H
+
+#include <stdint.h>
+#include <string.h>
+#include "matrix.h"
+#include "drbg.h"
+#include "../libs_optimized/bitslice.h"
+
+/**
+ * Storage and operations of the rows of a binary matrix.
+ * A backend only knows how to store one row : every matrix algorithm is written once in
+ * matrix_backend.c on top of these operations, so the backends only differ by their rows.
+ * Bit j of a row is exchanged with the other backends as bit j % 64 of word j / 64 (pack_row).
+ * row_dot and gather_column read the rows in place, so the kernels do not copy them to read a few bits.
+ */
+typedef struct
+{
+    const char *name;                                                                                                         /** name given on the command line */
+    void *(*init_row)(unsigned int nb_columns);                                                                               /** allocate a null row */
+    void (*free_row)(void *row);                                                                                              /** free a row of init_row */
+    unsigned int (*get_bit)(const void *row, unsigned int nb_columns, unsigned int j);                                        /** bit j of the row */
+    void (*set_bit)(void *row, unsigned int nb_columns, unsigned int j, unsigned int value);                                  /** set bit j of the row */
+    void (*add_row)(void *row1, const void *row2, unsigned int nb_columns);                                                   /** row1 ^= row2 */
+    void (*copy_row)(void *row1, const void *row2, unsigned int nb_columns);                                                  /** row1 = row2 */
+    unsigned int (*row_weight)(const void *row, unsigned int nb_columns);                                                     /** hamming weight of the row */
+    void (*row_support)(const void *row, unsigned int nb_columns, int *support);                                              /** sorted indices of the bits set */
+    void (*pack_row)(const void *row, unsigned int nb_columns, uint64_t *words);                                              /** copy in NB_WORDS(nb_columns) words, the bits after nb_columns are null */
+    void (*unpack_row)(void *row, unsigned int nb_columns, const uint64_t *words);                                            /** copy from NB_WORDS(nb_columns) words, the bits after nb_columns are ignored */
+    unsigned int (*row_dot)(const void *row, unsigned int nb_columns, const uint64_t *words);                                 /** parity of the row and NB_WORDS(nb_columns) words */
+    void (*gather_column)(void *const *rows, unsigned int nb_rows, unsigned int nb_columns, unsigned int j, uint64_t *words); /** bit j of each row in NB_WORDS(nb_rows) words */
+} matrix_backend;
+
+/**
+ * Binary matrix stored by a backend, passed by value as binary_matrix
+ */
+typedef struct
+{
+    const matrix_backend *backend; /** storage and operations of the rows */
+    void **rows;                   /** rows in the format of the backend, swapped by pointer */
+    unsigned int nb_rows;          /** number of rows */
+    unsigned int nb_columns;       /** number of columns */
+} backend_matrix;
+
+/**
+ * Scratch of the fused kernels, so that a loop of products A * x does not allocate
+ */
+typedef struct
+{
+    const matrix_backend *backend; /** backend of A and x */
+    uint64_t *column;              /** x packed, when it has one column */
+    uint64_t *words;               /** one row of A packed */
+    int *support;                  /** support of a row of A */
+    void *row;                     /** one row of the product */
+    unsigned int nb_columns;       /** number of columns of A */
+    unsigned int nb_x_columns;     /** number of columns of x */
+} backend_workspace;
+
+// Backends
+
+extern const matrix_backend reference_backend;
+
+const matrix_backend *find_matrix_backend(const char *name);
+const matrix_backend *parse_matrix_backend(const char *name);
+const matrix_backend *default_matrix_backend(void);
+
+// Creation and Destruction of backend matrices
+
+backend_matrix init_backend_matrix(const matrix_backend *backend, unsigned int nb_rows, unsigned int nb_columns);
+void free_backend_matrix(backend_matrix matrix);
+backend_matrix create_backend_identity_matrix(const matrix_backend *backend, unsigned int nb_rows);
+backend_matrix copy_backend_matrix(backend_matrix matrix);
+backend_matrix convert_backend_matrix(backend_matrix matrix, const matrix_backend *backend);
+backend_matrix bits_backend_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
+backend_matrix backend_matrix_from_bits(const matrix_backend *backend, bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
+bit **backend_matrix_to_bits(backend_matrix matrix);
+backend_workspace init_backend_workspace(const matrix_backend *backend, unsigned int nb_columns, unsigned int nb_x_columns);
+void free_backend_workspace(backend_workspace workspace);
+
+// Access to the bits and rows
+
+unsigned int get_backend_bit(backend_matrix matrix, unsigned int i, unsigned int j);
+void set_backend_bit(backend_matrix matrix, unsigned int i, unsigned int j, unsigned int value);
+polynome backend_row_support(backend_matrix matrix, unsigned int i);
+void pack_backend_row(backend_matrix matrix, unsigned int i, uint64_t *words);
+void unpack_backend_row(backend_matrix matrix, unsigned int i, const uint64_t *words);
+
+// Operations on backend matrices
+
+void randomize_backend_matrix(drbg *generator, backend_matrix matrix);
+void target_weight_backend_matrix(drbg *generator, backend_matrix matrix, unsigned int weight);
+void add_backend_matrix(backend_matrix matrix1, backend_matrix matrix2);
+backend_matrix multiply_backend_matrix(backend_matrix matrix1, backend_matrix matrix2);
+void multiply_add_backend_matrix(backend_matrix y, backend_matrix A, backend_matrix x, backend_workspace workspace);
+void transpose_multiply_backend_matrix(backend_matrix y, backend_matrix A, backend_matrix x, backend_workspace workspace);
+unsigned int syndrome_weight_backend_matrix(backend_matrix H, backend_matrix e, backend_workspace workspace);
+unsigned int transpose_syndrome_weight_backend_matrix(backend_matrix H, backend_matrix e, backend_workspace workspace);
+backend_matrix inversion_backend_matrix(backend_matrix matrix, int *is_invertible);
+unsigned int backend_hamming_weight(backend_matrix matrix);
+backend_matrix sample_backend_columns(drbg *generator, backend_matrix matrix, unsigned int sample_size, int *columns);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "matrix_view.h"
+
+/**
+ * Views of backend matrices : transposition, rotation of the rows and concatenation are
+ * computed when a row is read instead of copying the matrices. The rows of a view are read
+ * as a support (view_row_support) or as packed words (pack_view_row). Both write in buffers
+ * of the caller, so reading the rows of a view does not allocate. multiply_add_view_matrix
+ * and syndrome_weight_view_matrix multiply a view without materializing it.
+ */
+
+/**
+ * View of a whole matrix, the leaf of every other view.
+ *
+ * @param matrix matrix
+ * @return the view
+ */
+matrix_view whole_view(backend_matrix matrix)
+{
+    matrix_view view;
+    view.type = VIEW_MATRIX;
+    view.matrix = matrix;
+    view.source = NULL;
+    view.right = NULL;
+    view.shift = 0;
+    view.nb_rows = matrix.nb_rows;
+    view.nb_columns = matrix.nb_columns;
+    return view;
+}
+
+/**
+ * Transposition of a view.
+ *
+ * @param source view to transpose, must outlive the result
+ * @return the view
+ */
+matrix_view transposed_view(const matrix_view *source)
+{
+    matrix_view view = *source;
+    view.type = VIEW_TRANSPOSED;
+    view.source = source;
+    view.right = NULL;
+    view.nb_rows = source->nb_columns;
+    view.nb_columns = source->nb_rows;
+    return view;
+}
+
+/**
+ * Rotation of every row of a view, as rotation_backend_matrix.
+ *
+ * @param source view to rotate, must outlive the result
+ * @param nb_rotation number of positions
+ * @param direction_rotation LEFT or RIGHT
+ * @return the view, bit j of row i is bit (j + direction_rotation * nb_rotation) mod nb_columns of row i of the source
+ */
+matrix_view rotated_view(const matrix_view *source, unsigned int nb_rotation, int direction_rotation)
+{
+    matrix_view view = *source;
+    view.type = VIEW_ROTATED;
+    view.source = source;
+    view.right = NULL;
+    view.shift = nb_rotation % source->nb_columns;
+    if (direction_rotation == LEFT)
+        view.shift = (source->nb_columns - view.shift) % source->nb_columns;
+    return view;
+}
+
+/**
+ * Concatenation of two views with the same number of rows : [left | right].
+ *
+ * @param left left part, must outlive the result
+ * @param right right part, must outlive the result
+ * @return the view
+ */
+matrix_view concatenated_view(const matrix_view *left, const matrix_view *right)
+{
+    assert(left->nb_rows == right->nb_rows);
+    matrix_view view = *left;
+    view.type = VIEW_CONCATENATED;
+    view.source = left;
+    view.right = right;
+    view.nb_columns = left->nb_columns + right->nb_columns;
+    return view;
+}
+
+unsigned int get_view_bit(matrix_view view, unsigned int i, unsigned int j)
+{
+    switch (view.type)
+    {
+    case VIEW_TRANSPOSED:
+        return get_view_bit(*view.source, j, i);
+    case VIEW_ROTATED:
+        return get_view_bit(*view.source, i, (j + view.shift) % view.nb_columns);
+    case VIEW_CONCATENATED:
+        if (j < view.source->nb_columns)
+            return get_view_bit(*view.source, i, j);
+        return get_view_bit(*view.right, i, j - view.source->nb_columns);
+    default:
+        return get_backend_bit(view.matrix, i, j);
+    }
+}
+
+// Reverse the integers of support from start to stop - 1
+static void reverse_support(int *support, unsigned int start, unsigned int stop)
+{
+    for (; start + 1 < stop; start++, stop--)
+    {
+        int index = support[start];
+        support[start] = support[stop - 1];
+        support[stop - 1] = index;
+    }
+}
+
+/**
+ * Support of a row of a view.
+ * Rotations and concatenations only move the indices of the rows of their sources,
+ * a transposed row is a column of the source and costs one bit read per row of the source.
+ *
+ * @param view view
+ * @param i index of the row
+ * @param support result, the sorted indices of the bits set, nb_columns ints
+ * @return the number of bits set
+ */
+unsigned int view_row_support(matrix_view view, unsigned int i, int *support)
+{
+    switch (view.type)
+    {
+    case VIEW_TRANSPOSED:
+    {
+        unsigned int size = 0;
+        for (unsigned int j = 0; j < view.nb_columns; j++)
+        {
+            if (get_view_bit(*view.source, j, i))
+                support[size++] = j;
+        }
+        return size;
+    }
+    case VIEW_ROTATED:
+    {
+        // Index k of the source moves to k - shift, the first ones are below the shift and come last
+        unsigned int size = view_row_support(*view.source, i, support);
+        unsigned int nb_wrapped = 0;
+        while (nb_wrapped < size && support[nb_wrapped] < (int)view.shift)
+            nb_wrapped++;
+        reverse_support(support, 0, nb_wrapped);
+        reverse_support(support, nb_wrapped, size);
+        reverse_support(support, 0, size);
+        for (unsigned int k = 0; k < size; k++)
+            support[k] += k < size - nb_wrapped ? -(int)view.shift : (int)(view.nb_columns - view.shift);
+        return size;
+    }
+    case VIEW_CONCATENATED:
+    {
+        unsigned int size = view_row_support(*view.source, i, support);
+        unsigned int right_size = view_row_support(*view.right, i, support + size);
+        for (unsigned int k = size; k < size + right_size; k++)
+            support[k] += view.source->nb_columns;
+        return size + right_size;
+    }
+    default:
+        view.matrix.backend->row_support(view.matrix.rows[i], view.nb_columns, support);
+        return view.matrix.backend->row_weight(view.matrix.rows[i], view.nb_columns);
+    }
+}
+
+/**
+ * Words of scratch needed by pack_view_row for a view.
+ *
+ * @param view view
+ * @return the number of words
+ */
+unsigned int view_scratch_words(matrix_view view)
+{
+    switch (view.type)
+    {
+    case VIEW_ROTATED:
+        // The row of the source and its doubled copy
+        return NB_WORDS(view.nb_columns) + DOUBLED_WORDS(view.nb_columns) + view_scratch_words(*view.source);
+    case VIEW_CONCATENATED:
+    {
+        // The left part is read in the result, the right part in the scratch
+        unsigned int left = view_scratch_words(*view.source);
+        unsigned int right = NB_WORDS(view.right->nb_columns) + view_scratch_words(*view.right);
+        return left > right ? left : right;
+    }
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Copy a row of a view in packed words, as pack_backend_row.
+ *
+ * @param view view
+ * @param i index of the row
+ * @param words result, NB_WORDS(nb_columns) words, the bits after nb_columns are null
+ * @param scratch view_scratch_words(view) words
+ */
+void pack_view_row(matrix_view view, unsigned int i, uint64_t *words, uint64_t *scratch)
+{
+    switch (view.type)
+    {
+    case VIEW_TRANSPOSED:
+    {
+        // A row of the transposition of a matrix is a column of the matrix
+        if (view.source->type == VIEW_MATRIX)
+        {
+            backend_matrix source = view.source->matrix;
+            source.backend->gather_column(source.rows, source.nb_rows, source.nb_columns, i, words);
+            break;
+        }
+        for (unsigned int k = 0; k < NB_WORDS(view.nb_columns); k++)
+            words[k] = 0;
+        for (unsigned int j = 0; j < view.nb_columns; j++)
+            words[j / WORD_SIZE] |= (uint64_t)get_view_bit(*view.source, j, i) << (j % WORD_SIZE);
+        break;
+    }
+    case VIEW_ROTATED:
+    {
+        // Bit j is bit j + shift of the source, the source times X^-shift
+        uint64_t *doubled = scratch + NB_WORDS(view.nb_columns);
+        pack_view_row(*view.source, i, scratch, doubled + DOUBLED_WORDS(view.nb_columns));
+        init_doubled_ring(scratch, view.nb_columns, doubled);
+        rotate_doubled_ring(doubled, view.nb_columns - view.shift, view.nb_columns, words);
+        break;
+    }
+    case VIEW_CONCATENATED:
+    {
+        unsigned int nb_columns = view.source->nb_columns;
+        for (unsigned int k = 0; k < NB_WORDS(view.nb_columns); k++)
+            words[k] = 0;
+        pack_view_row(*view.source, i, words, scratch);
+        uint64_t *right = scratch;
+        pack_view_row(*view.right, i, right, scratch + NB_WORDS(view.right->nb_columns));
+        // The words of the right part start at bit nb_columns of the left one
+        unsigned int start = nb_columns / WORD_SIZE;
+        unsigned int offset = nb_columns % WORD_SIZE;
+        for (unsigned int k = 0; k < NB_WORDS(view.right->nb_columns); k++)
+        {
+            words[start + k] |= right[k] << offset;
+            if (offset != 0 && start + k + 1 < NB_WORDS(view.nb_columns))
+                words[start + k + 1] |= right[k] >> (WORD_SIZE - offset);
+        }
+        break;
+    }
+    default:
+        pack_backend_row(view.matrix, i, words);
+    }
+}
+
+/**
+ * Copy of a view in a matrix with contiguous rows.
+ * A transposed view is copied by scattering the rows of its source in packed words, the other ones row by row.
+ *
+ * @param view view to copy
+ * @param backend backend of the result
+ * @return the matrix (keeping the sources)
+ */
+backend_matrix materialize_view(matrix_view view, const matrix_backend *backend)
+{
+    backend_matrix matrix = init_backend_matrix(backend, view.nb_rows, view.nb_columns);
+    if (view.type == VIEW_TRANSPOSED)
+    {
+        size_t nb_words = NB_WORDS(view.nb_columns);
+        uint64_t *rows = (uint64_t *)calloc(nb_words * view.nb_rows, sizeof(uint64_t));
+        int *column = (int *)malloc(sizeof(int) * view.nb_rows);
+        for (unsigned int j = 0; j < view.nb_columns; j++)
+        {
+            unsigned int size = view_row_support(*view.source, j, column);
+            for (unsigned int k = 0; k < size; k++)
+                rows[column[k] * nb_words + j / WORD_SIZE] |= (uint64_t)1 << (j % WORD_SIZE);
+        }
+        for (unsigned int i = 0; i < view.nb_rows; i++)
+            unpack_backend_row(matrix, i, rows + i * nb_words);
+        free(column);
+        free(rows);
+        return matrix;
+    }
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * (NB_WORDS(view.nb_columns) + view_scratch_words(view)));
+    for (unsigned int i = 0; i < view.nb_rows; i++)
+    {
+        pack_view_row(view, i, words, words + NB_WORDS(view.nb_columns));
+        unpack_backend_row(matrix, i, words);
+    }
+    free(words);
+    return matrix;
+}
+
+// The transposition of a matrix is multiplied by the transposed kernels of matrix_backend.c
+static int is_transposed_matrix(matrix_view view, const matrix_backend *backend)
+{
+    return view.type == VIEW_TRANSPOSED && view.source->type == VIEW_MATRIX && view.source->matrix.backend == backend;
+}
+
+/**
+ * Scratch of the products by a view, multiply_add_view_matrix and syndrome_weight_view_matrix.
+ * The transposition of a matrix uses the workspace of the transposed kernels, the other views
+ * read each row with pack_view_row in the words of the workspace, followed by its scratch.
+ *
+ * @param A view to multiply
+ * @param backend backend of x and of the result
+ * @param nb_x_columns number of columns of x
+ * @return the workspace, freed by free_backend_workspace
+ */
+backend_workspace init_view_workspace(matrix_view A, const matrix_backend *backend, unsigned int nb_x_columns)
+{
+    if (is_transposed_matrix(A, backend))
+        return init_backend_workspace(backend, A.nb_rows, nb_x_columns);
+    backend_workspace workspace = init_backend_workspace(backend, A.nb_columns, nb_x_columns);
+    free(workspace.words);
+    workspace.words = (uint64_t *)malloc(sizeof(uint64_t) * (NB_WORDS(A.nb_columns) + view_scratch_words(A)));
+    return workspace;
+}
+
+/**
+ * Multiply - accumulate by a view : y += A * x, as multiply_add_backend_matrix, without materializing A.
+ * A matrix and the transposition of a matrix go to the kernels of matrix_backend.c, the rows of the
+ * other views are packed one at a time.
+ *
+ * @param y result, nb_rows of A x nb_columns of x, in the backend of x
+ * @param A left view
+ * @param x right matrix, with nb_columns of A rows
+ * @param workspace init_view_workspace(A, backend of x, nb_columns of x)
+ */
+void multiply_add_view_matrix(backend_matrix y, matrix_view A, backend_matrix x, backend_workspace workspace)
+{
+    assert(A.nb_columns == x.nb_rows && y.nb_rows == A.nb_rows && y.nb_columns == x.nb_columns);
+    const matrix_backend *backend = x.backend;
+    if (A.type == VIEW_MATRIX && A.matrix.backend == backend)
+    {
+        multiply_add_backend_matrix(y, A.matrix, x, workspace);
+        return;
+    }
+    if (is_transposed_matrix(A, backend))
+    {
+        transpose_multiply_backend_matrix(y, A.source->matrix, x, workspace);
+        return;
+    }
+    assert(workspace.backend == backend && workspace.nb_columns == A.nb_columns && workspace.nb_x_columns == x.nb_columns);
+    uint64_t *words = workspace.words;
+    if (x.nb_columns == 1)
+        backend->gather_column(x.rows, x.nb_rows, 1, 0, workspace.column);
+    for (unsigned int i = 0; i < A.nb_rows; i++)
+    {
+        pack_view_row(A, i, words, words + NB_WORDS(A.nb_columns));
+        if (x.nb_columns == 1)
+        {
+            unsigned int parity = 0;
+            for (unsigned int k = 0; k < NB_WORDS(A.nb_columns); k++)
+                parity ^= __builtin_parityll(words[k] & workspace.column[k]);
+            if (parity)
+                backend->set_bit(y.rows[i], 1, 0, !backend->get_bit(y.rows[i], 1, 0));
+            continue;
+        }
+        for (unsigned int k = 0; k < NB_WORDS(A.nb_columns); k++)
+        {
+            for (uint64_t word = words[k]; word != 0; word &= word - 1)
+                backend->add_row(y.rows[i], x.rows[k * WORD_SIZE + __builtin_ctzll(word)], x.nb_columns);
+        }
+    }
+}
+
+/**
+ * Syndrome - count by a view : hamming weight of H * e, as syndrome_weight_backend_matrix, without materializing H.
+ *
+ * @param H left view
+ * @param e right matrix, with nb_columns of H rows
+ * @param workspace init_view_workspace(H, backend of e, nb_columns of e)
+ * @return the weight of H * e
+ */
+unsigned int syndrome_weight_view_matrix(matrix_view H, backend_matrix e, backend_workspace workspace)
+{
+    assert(H.nb_columns == e.nb_rows);
+    const matrix_backend *backend = e.backend;
+    if (H.type == VIEW_MATRIX && H.matrix.backend == backend)
+        return syndrome_weight_backend_matrix(H.matrix, e, workspace);
+    if (is_transposed_matrix(H, backend))
+        return transpose_syndrome_weight_backend_matrix(H.source->matrix, e, workspace);
+    assert(workspace.backend == backend && workspace.nb_columns == H.nb_columns && workspace.nb_x_columns == e.nb_columns);
+    uint64_t *words = workspace.words;
+    unsigned int weight = 0;
+    if (e.nb_columns == 1)
+        backend->gather_column(e.rows, e.nb_rows, 1, 0, workspace.column);
+    for (unsigned int i = 0; i < H.nb_rows; i++)
+    {
+        pack_view_row(H, i, words, words + NB_WORDS(H.nb_columns));
+        if (e.nb_columns == 1)
+        {
+            unsigned int parity = 0;
+            for (unsigned int k = 0; k < NB_WORDS(H.nb_columns); k++)
+                parity ^= __builtin_parityll(words[k] & workspace.column[k]);
+            weight += parity;
+            continue;
+        }
+        // The first row of e starts the sum, instead of clearing the scratch row
+        int is_empty = 1;
+        for (unsigned int k = 0; k < NB_WORDS(H.nb_columns); k++)
+        {
+            for (uint64_t word = words[k]; word != 0; word &= word - 1)
+            {
+                void *row = e.rows[k * WORD_SIZE + __builtin_ctzll(word)];
+                if (is_empty)
+                    backend->copy_row(workspace.row, row, e.nb_columns);
+                else
+                    backend->add_row(workspace.row, row, e.nb_columns);
+                is_empty = 0;
+            }
+        }
+        if (!is_empty)
+            weight += backend->row_weight(workspace.row, e.nb_columns);
+    }
+    return weight;
+}
+
+/**
+ * Transposition of a matrix.
+ *
+ * @param matrix matrix to transpose
+ * @return the transposed matrix (keeping the source)
+ */
+backend_matrix transpose_backend_matrix(backend_matrix matrix)
+{
+    matrix_view source = whole_view(matrix);
+    return materialize_view(transposed_view(&source), matrix.backend);
+}
+
+/**
+ * Rotation of every row of a matrix, as rotation_matrix.
+ *
+ * @param matrix matrix to rotate
+ * @param nb_rotation number of positions
+ * @param direction_rotation LEFT or RIGHT
+ * @return the rotated matrix (keeping the source), row i is row i of the source with
+ * bit j = bit (j + direction_rotation * nb_rotation) mod nb_columns of the source
+ */
+backend_matrix rotation_backend_matrix(backend_matrix matrix, unsigned int nb_rotation, int direction_rotation)
+{
+    matrix_view source = whole_view(matrix);
+    return materialize_view(rotated_view(&source, nb_rotation, direction_rotation), matrix.backend);
+}
+
+/**
+ * Concatenation of two matrices with the same number of rows : [matrix1 | matrix2].
+ * The result uses the backend of matrix1.
+ *
+ * @param matrix1 left part
+ * @param matrix2 right part
+ * @return the concatenated matrix (keeping the sources)
+ */
+backend_matrix concatenation_backend_matrix(backend_matrix matrix1, backend_matrix matrix2)
+{
+    matrix_view left = whole_view(matrix1);
+    matrix_view right = whole_view(matrix2);
+    return materialize_view(concatenated_view(&left, &right), matrix1.backend);
+}
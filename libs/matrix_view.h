@@ -0,0 +1,61 @@
+#ifndef MATRIX_VIEW_H
+#define MATRIX_VIEW_H
+
+#include "matrix_backend.h"
+#include "../libs_optimized/ring.h"
+
+/**
+ * Kind of a view
+ */
+typedef enum
+{
+    VIEW_MATRIX,      /** the matrix itself */
+    VIEW_TRANSPOSED,  /** transposition of the source */
+    VIEW_ROTATED,     /** every row of the source rotated, as rotation_backend_matrix */
+    VIEW_CONCATENATED /** [source | right], as concatenation_backend_matrix */
+} view_type;
+
+/**
+ * Matrix computed on the fly from other matrices, nothing is copied when it is built.
+ * A view only points to its sources, which must outlive it, and is passed by value.
+ * It is read row by row in buffers of the caller, materialize_view copies it when contiguous rows are needed.
+ */
+typedef struct matrix_view
+{
+    view_type type;                   /** how the bits are computed from the sources */
+    backend_matrix matrix;            /** VIEW_MATRIX only */
+    const struct matrix_view *source; /** matrix transposed, rotated or left of the concatenation */
+    const struct matrix_view *right;  /** VIEW_CONCATENATED only */
+    unsigned int shift;               /** VIEW_ROTATED only, bit j is bit (j + shift) % nb_columns of the source */
+    unsigned int nb_rows;             /** number of rows */
+    unsigned int nb_columns;          /** number of columns */
+} matrix_view;
+
+// Creation of views
+
+matrix_view whole_view(backend_matrix matrix);
+matrix_view transposed_view(const matrix_view *source);
+matrix_view rotated_view(const matrix_view *source, unsigned int nb_rotation, int direction_rotation);
+matrix_view concatenated_view(const matrix_view *left, const matrix_view *right);
+
+// Reading of views
+
+unsigned int get_view_bit(matrix_view view, unsigned int i, unsigned int j);
+unsigned int view_row_support(matrix_view view, unsigned int i, int *support);
+unsigned int view_scratch_words(matrix_view view);
+void pack_view_row(matrix_view view, unsigned int i, uint64_t *words, uint64_t *scratch);
+backend_matrix materialize_view(matrix_view view, const matrix_backend *backend);
+
+// Products by views, without materializing them
+
+backend_workspace init_view_workspace(matrix_view A, const matrix_backend *backend, unsigned int nb_x_columns);
+void multiply_add_view_matrix(backend_matrix y, matrix_view A, backend_matrix x, backend_workspace workspace);
+unsigned int syndrome_weight_view_matrix(matrix_view H, backend_matrix e, backend_workspace workspace);
+
+// Copies, built on the views
+
+backend_matrix transpose_backend_matrix(backend_matrix matrix);
+backend_matrix rotation_backend_matrix(backend_matrix matrix, unsigned int nb_rotation, int direction_rotation);
+backend_matrix concatenation_backend_matrix(backend_matrix matrix1, backend_matrix matrix2);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "parameter_sets.h"
+
+#define PARAMETER_SET_ENTRY(identifier, name, n, w, t) {name, n, w, t},
+
+static const parameter_set parameter_sets[] = {PARAMETER_SETS(PARAMETER_SET_ENTRY)};
+
+/**
+ * Parameter set of a name.
+ *
+ * @param name name of the set
+ * @return the set, NULL if the name is unknown
+ */
+const parameter_set *find_parameter_set(const char *name)
+{
+    for (unsigned int i = 0; i < sizeof(parameter_sets) / sizeof(parameter_sets[0]); i++)
+    {
+        if (strcmp(parameter_sets[i].name, name) == 0)
+            return &parameter_sets[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef PARAMETER_SETS_H
+#define PARAMETER_SETS_H
+
+#include <string.h>
+
+/**
+ * Parameter sets known at compile time, X(identifier, name, n, w, t) for each one :
+ * the sizes of the BIKE rounds (w is half of the row weight of H) and the sizes of mdpc and dfr.
+ * The kernels of ring.c are generated once per size from this list, with n as a constant,
+ * and the functions taking n at runtime dispatch to them.
+ */
+#define PARAMETER_SETS(X)                  \
+    X(test, "test", 4813, 39, 78)          \
+    X(bike_l1, "bike-l1", 12323, 71, 134)  \
+    X(bike_l3, "bike-l3", 24659, 103, 199) \
+    X(bike_l5, "bike-l5", 40973, 137, 264)
+
+/**
+ * Sizes of a key pair and of its errors
+ */
+typedef struct
+{
+    const char *name; /** name given on the command line */
+    unsigned int n;   /** size of each block of the private key */
+    unsigned int w;   /** weight of each line of h0 and h1 */
+    unsigned int t;   /** weight of the whole error, t / 2 on each part */
+} parameter_set;
+
+const parameter_set *find_parameter_set(const char *name);
+
+#endif
\ No newline at end of file
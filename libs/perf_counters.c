@@ -0,0 +1,277 @@
+#include "perf_counters.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware counters of the calling thread around the hot kernels.
+ * The counters (user space only) are opened by init_perf_counters in the thread that measures,
+ * they run from then on and a measure is the difference of two reads, so measures can be nested.
+ * The events form one group read at once : when the PMU has fewer counters than events, the group
+ * is multiplexed as a whole and each measure is scaled by the time it was enabled over the time
+ * it was running, so the counts and their ratios stay consistent.
+ * Everything lives in the perf_counters of the caller, the library keeps no state.
+ * An event the CPU or the kernel does not provide is reported as null, the others still work.
+ */
+
+// Names of the call sites, in the order of perf_site
+static const char *site_names[] = {"isd_sample", "isd_inversion", "isd_multiplication", "pubkey", "bitflip_counters"};
+// Names of the events, in the order of perf_event
+static const char *event_names[] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+#ifdef __linux__
+/**
+ * Open the counter of one event for the calling thread.
+ *
+ * @param event event to count
+ * @param leader counter of the group, -1 to open the leader
+ * @return the file descriptor, -1 if the event is not available
+ */
+static int open_event(perf_event event, int leader)
+{
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (event)
+    {
+    case PERF_CYCLES:
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_L1D_MISSES:
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PERF_LLC_MISSES:
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    default:
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+    }
+    // This thread, any CPU, in the group of the leader
+    return syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+}
+#endif
+
+/**
+ * Open the hardware counters of the calling thread.
+ *
+ * @return the counters, freed by free_perf_counters
+ */
+perf_counters *init_perf_counters(void)
+{
+    perf_counters *counters = (perf_counters *)calloc(1, sizeof(perf_counters));
+    counters->leader = -1;
+    for (int e = 0; e < NB_PERF_EVENTS; e++)
+    {
+#ifdef __linux__
+        // The first event available leads the group of the others
+        counters->fds[e] = open_event((perf_event)e, counters->leader);
+        if (counters->leader < 0)
+            counters->leader = counters->fds[e];
+#else
+        counters->fds[e] = -1;
+#endif
+    }
+    return counters;
+}
+
+void free_perf_counters(perf_counters *counters)
+{
+#ifdef __linux__
+    // The leader is closed last, after the events of its group
+    for (int e = NB_PERF_EVENTS - 1; e >= 0; e--)
+    {
+        if (counters->fds[e] >= 0)
+            close(counters->fds[e]);
+    }
+#endif
+    free(counters);
+}
+
+/**
+ * Number of events the counters measure.
+ *
+ * @param counters counters
+ * @return number of events available, 0 if perf_event_open is refused (see /proc/sys/kernel/perf_event_paranoid)
+ */
+int nb_perf_events_available(perf_counters *counters)
+{
+    int nb_available = 0;
+    for (int e = 0; e < NB_PERF_EVENTS; e++)
+        nb_available += counters->fds[e] >= 0;
+    return nb_available;
+}
+
+/**
+ * Add the events of every call site to a total, for the counters of the workers of a parallel run.
+ *
+ * @param total counters to update
+ * @param part counters to add
+ */
+void merge_perf_counters(perf_counters *total, perf_counters *part)
+{
+    for (int s = 0; s < NB_PERF_SITES; s++)
+    {
+        total->sites[s].nb_calls += part->sites[s].nb_calls;
+        total->sites[s].nb_bits += part->sites[s].nb_bits;
+        for (int e = 0; e < NB_PERF_EVENTS; e++)
+            total->sites[s].events[e] += part->sites[s].events[e];
+    }
+}
+
+/**
+ * Read the whole group with one read of its leader.
+ * The values of the group come in the order the events were opened, which skips the events not available.
+ *
+ * @param counters counters of the calling thread
+ * @param reading result, null if nothing is available
+ */
+static void read_counters(perf_counters *counters, perf_reading *reading)
+{
+    memset(reading, 0, sizeof(perf_reading));
+#ifdef __linux__
+    if (counters->leader < 0)
+        return;
+    // nr, time_enabled, time_running then one value per event of the group
+    uint64_t group[3 + NB_PERF_EVENTS];
+    ssize_t size = read(counters->leader, group, sizeof(group));
+    if (size < (ssize_t)(3 * sizeof(uint64_t)) || size < (ssize_t)((3 + group[0]) * sizeof(uint64_t)))
+        return;
+    reading->time_enabled = group[1];
+    reading->time_running = group[2];
+    uint64_t k = 0;
+    for (int e = 0; e < NB_PERF_EVENTS && k < group[0]; e++)
+    {
+        if (counters->fds[e] >= 0)
+            reading->values[e] = group[3 + k++];
+    }
+#endif
+}
+
+/**
+ * Start a measure.
+ *
+ * @param counters counters of the calling thread, NULL if the measures are disabled
+ * @param site call site measured
+ * @return the running measure
+ */
+perf_measure start_perf_measure(perf_counters *counters, perf_site site)
+{
+    perf_measure measure;
+    measure.counters = counters;
+    measure.site = site;
+    if (counters != NULL)
+        read_counters(counters, &measure.start);
+    return measure;
+}
+
+/**
+ * Stop a measure and add its events to its call site.
+ * The events are scaled by the time the group was enabled over the time it was running during the measure.
+ *
+ * @param measure measure returned by start_perf_measure
+ * @param nb_bits bits processed by the kernel, for the cycles per bit
+ */
+void stop_perf_measure(perf_measure measure, uint64_t nb_bits)
+{
+    if (measure.counters == NULL)
+        return;
+    perf_reading end;
+    read_counters(measure.counters, &end);
+
+    perf_site_statistics *site = &measure.counters->sites[measure.site];
+    site->nb_calls++;
+    site->nb_bits += nb_bits;
+    uint64_t enabled = end.time_enabled - measure.start.time_enabled;
+    uint64_t running = end.time_running - measure.start.time_running;
+    for (int e = 0; e < NB_PERF_EVENTS; e++)
+    {
+        uint64_t count = end.values[e] - measure.start.values[e];
+        // Not multiplexed when running == enabled, never scheduled when running is null
+        if (running != enabled)
+            count = running == 0 ? 0 : (uint64_t)((double)count * enabled / running);
+        site->events[e] += count;
+    }
+}
+
+perf_site_statistics get_perf_site_statistics(perf_counters *counters, perf_site site)
+{
+    return counters->sites[site];
+}
+
+const char *perf_site_name(perf_site site)
+{
+    return site_names[site];
+}
+
+/**
+ * Write the events of a call site and the ratios telling whether it is compute or memory bound.
+ */
+static void write_perf_site(FILE *output, const int *is_event_available, const char *name, perf_site_statistics site, int is_last)
+{
+    fprintf(output, "    \"%s\": {\"calls\": %lu, \"bits\": %lu", name, site.nb_calls, site.nb_bits);
+    for (int e = 0; e < NB_PERF_EVENTS; e++)
+    {
+        if (is_event_available[e])
+            fprintf(output, ", \"%s\": %lu", event_names[e], site.events[e]);
+        else
+            fprintf(output, ", \"%s\": null", event_names[e]);
+    }
+
+    uint64_t cycles = site.events[PERF_CYCLES], instructions = site.events[PERF_INSTRUCTIONS];
+    if (is_event_available[PERF_CYCLES] && is_event_available[PERF_INSTRUCTIONS] && cycles > 0)
+        fprintf(output, ", \"ipc\": %.3f", (double)instructions / cycles);
+    if (is_event_available[PERF_CYCLES] && site.nb_bits > 0)
+        fprintf(output, ", \"cycles_per_bit\": %.4f", (double)cycles / site.nb_bits);
+    // Misses per 1000 instructions
+    for (int e = PERF_L1D_MISSES; e < NB_PERF_EVENTS; e++)
+    {
+        if (is_event_available[e] && is_event_available[PERF_INSTRUCTIONS] && instructions > 0)
+            fprintf(output, ", \"%s_per_kilo_instruction\": %.3f", event_names[e], 1000.0 * site.events[e] / instructions);
+    }
+    fprintf(output, "}%s\n", is_last ? "" : ",");
+}
+
+/**
+ * Write the events of every call site and their total in JSON.
+ *
+ * @param counters counters to report
+ * @param output file to write in
+ */
+void write_perf_report(perf_counters *counters, FILE *output)
+{
+    int is_event_available[NB_PERF_EVENTS];
+    for (int e = 0; e < NB_PERF_EVENTS; e++)
+        is_event_available[e] = counters->fds[e] >= 0;
+    fprintf(output, "{\n  \"available\": %s,\n  \"sites\": {\n", nb_perf_events_available(counters) > 0 ? "true" : "false");
+
+    perf_site_statistics total;
+    memset(&total, 0, sizeof(total));
+    for (int s = 0; s < NB_PERF_SITES; s++)
+    {
+        perf_site_statistics site = get_perf_site_statistics(counters, (perf_site)s);
+        write_perf_site(output, is_event_available, site_names[s], site, s == NB_PERF_SITES - 1);
+        total.nb_calls += site.nb_calls;
+        total.nb_bits += site.nb_bits;
+        for (int e = 0; e < NB_PERF_EVENTS; e++)
+            total.events[e] += site.events[e];
+    }
+    fprintf(output, "  },\n  \"total\": {\n");
+    write_perf_site(output, is_event_available, "all", total, 1);
+    fprintf(output, "  }\n}\n");
+}
@@ -0,0 +1,94 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * Hardware events counted around the kernels
+ */
+typedef enum
+{
+    PERF_CYCLES,        /** CPU cycles */
+    PERF_INSTRUCTIONS,  /** retired instructions */
+    PERF_L1D_MISSES,    /** L1 data cache read misses */
+    PERF_LLC_MISSES,    /** last level cache misses */
+    PERF_BRANCH_MISSES, /** mispredicted branches */
+    NB_PERF_EVENTS
+} perf_event;
+
+/**
+ * Call sites measured
+ */
+typedef enum
+{
+    SITE_ISD_SAMPLE,         /** draw of the columns in isd_solve */
+    SITE_ISD_INVERSION,      /** inversion_backend_matrix in isd_solve */
+    SITE_ISD_MULTIPLICATION, /** syndrome_weight_view_matrix in isd_solve */
+    SITE_PUBKEY,             /** pubkey_generation */
+    SITE_BITFLIP_COUNTERS,   /** counters of one iteration of fixed_threshold_bitflip */
+    NB_PERF_SITES
+} perf_site;
+
+/**
+ * Events accumulated by one call site.
+ */
+typedef struct
+{
+    uint64_t nb_calls;               /** number of measures */
+    uint64_t nb_bits;                /** bits processed, as given to stop_perf_measure */
+    uint64_t events[NB_PERF_EVENTS]; /** sum of each event */
+} perf_site_statistics;
+
+/**
+ * Hardware counters of one thread and the events of each call site, owned by the caller.
+ * The counters count the thread that created them : the workers of a parallel run
+ * each own one and merge it into the total with merge_perf_counters.
+ * The events are opened as one group, so they are scheduled together when the PMU multiplexes them.
+ */
+typedef struct
+{
+    int fds[NB_PERF_EVENTS];                   /** counter of each event, -1 if the event is not available */
+    int leader;                                /** counter read for the whole group, -1 if no event is available */
+    perf_site_statistics sites[NB_PERF_SITES]; /** events of each call site */
+} perf_counters;
+
+/**
+ * One read of the group of counters.
+ */
+typedef struct
+{
+    uint64_t values[NB_PERF_EVENTS]; /** count of each event, 0 if it is not available */
+    uint64_t time_enabled;           /** ns since the group was opened */
+    uint64_t time_running;           /** ns the group was on the PMU, below time_enabled when multiplexed */
+} perf_reading;
+
+/**
+ * Running measure, started by start_perf_measure.
+ */
+typedef struct
+{
+    perf_counters *counters; /** counters of the measure, NULL if the measures are disabled */
+    perf_site site;          /** call site measured */
+    perf_reading start;      /** counters at the start */
+} perf_measure;
+
+// Creation and Destruction of the hardware counters (Linux perf_event_open) of the calling thread
+
+perf_counters *init_perf_counters(void);
+void free_perf_counters(perf_counters *counters);
+int nb_perf_events_available(perf_counters *counters);
+void merge_perf_counters(perf_counters *total, perf_counters *part);
+
+// Measures, NULL counters cost one test
+
+perf_measure start_perf_measure(perf_counters *counters, perf_site site);
+void stop_perf_measure(perf_measure measure, uint64_t nb_bits);
+
+// Report
+
+perf_site_statistics get_perf_site_statistics(perf_counters *counters, perf_site site);
+const char *perf_site_name(perf_site site);
+void write_perf_report(perf_counters *counters, FILE *output);
+
+#endif
\ No newline at end of file
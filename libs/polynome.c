@@ -14,12 +14,7 @@ polynome *init_polynomial_matrix(bit **matrix, unsigned int nb_rows, unsigned in
     for (int i = 0; i < nb_rows; i++)
     {
         // Get size of each polynomial rows
-        int size = 0;
-        for (int j = 0; j < nb_columns; j++)
-        {
-            if (matrix[i][j].value == 1)
-                size++;
-        }
+        int size = hamming_weight(matrix + i, 1, nb_columns);
         polynomial_matrix[i].liste_indice = (int *)malloc(sizeof(int) * size);
         polynomial_matrix[i].size = size;
 
@@ -27,7 +22,7 @@ polynome *init_polynomial_matrix(bit **matrix, unsigned int nb_rows, unsigned in
         int index = 0;
         for (int j = 0; j < nb_columns; j++)
         {
-            if (matrix[i][j].value == 1)
+            if (get_matrix_bit(matrix, i, j))
             {
                 polynomial_matrix[i].liste_indice[index] = j;
                 index++;
@@ -47,7 +42,10 @@ void free_polynomial_matrix(polynome *polynomial_matrix, unsigned int nb_rows)
 void free_polynomial_matrix_Z(polynome_Z *polynomial_matrix_Z, unsigned int nb_rows)
 {
     for (int i = 0; i < nb_rows; i++)
+    {
         free(polynomial_matrix_Z[i].liste_indice);
+        free(polynomial_matrix_Z[i].coeff);
+    }
     free(polynomial_matrix_Z);
 }
 
@@ -133,7 +131,9 @@ int search(void *index_to_search, int *array, int nb_element)
 /**
  * Multiplication of two polynomial matrix.
  * nb_columns_matrix1 must be equals to nb_rows_matrix2
- * Inspiration from https://www.geeksforgeeks.org/c-matrix-multiplication/
+ * Row i of the product is the sum of the rows k of matrix2 for k in row i of matrix1 :
+ * the parity of each column is accumulated in buckets and only the touched columns are read back,
+ * so a row costs O(w1 * w2) instead of O(nb_columns * w1 * log w2).
  *
  * @param matrix1 matrix to multiply with
  * @param matrix2 matrix to get multiplied
@@ -146,45 +146,112 @@ polynome *multiplication_polynomial_matrix(polynome *polynomial_matrix1, polynom
 {
     polynome *result = (polynome *)malloc(sizeof(polynome) * nb_rows_polynome1);
 
-    int *tmp_line = (int *)malloc(nb_columns_polynome2 * sizeof(int));
-    int value, current_index;
+    unsigned char *parity = (unsigned char *)calloc(nb_columns_polynome2, sizeof(unsigned char));
+    unsigned char *is_touched = (unsigned char *)calloc(nb_columns_polynome2, sizeof(unsigned char));
+    int *touched = (int *)malloc(nb_columns_polynome2 * sizeof(int));
 
     for (int i = 0; i < nb_rows_polynome1; i++)
     {
-        current_index = 0;
-
-        for (int j = 0; j < nb_columns_polynome2; j++)
+        // Buckets : parity of each column, and the list of the columns met
+        int nb_touched = 0;
+        for (int k = 0; k < polynomial_matrix1[i].size; k++)
         {
-            value = 0;
-            for (int k = 0; k < polynomial_matrix1[i].size; k++)
+            polynome line = polynomial_matrix2[polynomial_matrix1[i].liste_indice[k]];
+            for (int l = 0; l < line.size; l++)
             {
-                int index = polynomial_matrix1[i].liste_indice[k];
-                value = (value + search(&j, polynomial_matrix2[index].liste_indice, polynomial_matrix2[index].size)) % 2;
+                int j = line.liste_indice[l];
+                parity[j] ^= 1;
+                if (!is_touched[j])
+                {
+                    is_touched[j] = 1;
+                    touched[nb_touched++] = j;
+                }
             }
-            if (value != 0)
+        }
+
+        // Sorting the touched columns is cheaper than scanning every column while they are few
+        if (nb_touched < nb_columns_polynome2 / 16)
+            qsort(touched, nb_touched, sizeof(int), compare_int);
+        else
+        {
+            nb_touched = 0;
+            for (int j = 0; j < nb_columns_polynome2; j++)
             {
-                tmp_line[current_index] = j;
-                current_index++;
+                if (is_touched[j])
+                    touched[nb_touched++] = j;
             }
         }
 
-        result[i].size = current_index;
-        result[i].liste_indice = (int *)malloc(sizeof(int) * current_index);
-        current_index = 0;
+        int size = 0;
+        for (int l = 0; l < nb_touched; l++)
+            size += parity[touched[l]];
+        result[i].size = size;
+        result[i].liste_indice = (int *)malloc(sizeof(int) * size);
+        size = 0;
+        for (int l = 0; l < nb_touched; l++)
+        {
+            int j = touched[l];
+            if (parity[j])
+                result[i].liste_indice[size++] = j;
+            parity[j] = 0;
+            is_touched[j] = 0;
+        }
+    }
+    free(parity);
+    free(is_touched);
+    free(touched);
+    return result;
+}
+
+/**
+ * Collect the non null coefficients of the buckets met, sorted, and empty the buckets.
+ *
+ * @param counts coefficient of each bucket
+ * @param touched buckets met, modified
+ * @param nb_touched number of buckets met
+ * @param nb_buckets number of buckets
+ * @return the polynomial of the non null coefficients
+ */
+static polynome_Z collect_buckets(int *counts, int *touched, int nb_touched, int nb_buckets)
+{
+    // Sorting the touched buckets is cheaper than scanning every bucket while they are few
+    if (nb_touched < nb_buckets / 16)
+        qsort(touched, nb_touched, sizeof(int), compare_int);
+    else
+    {
+        nb_touched = 0;
+        for (int j = 0; j < nb_buckets; j++)
+        {
+            if (counts[j] != 0)
+                touched[nb_touched++] = j;
+        }
+    }
 
-        for (int l = 0; l < result[i].size; l++)
+    polynome_Z result;
+    result.size = 0;
+    for (int l = 0; l < nb_touched; l++)
+        result.size += counts[touched[l]] != 0;
+    result.liste_indice = (int *)malloc(sizeof(int) * result.size);
+    result.coeff = (int *)malloc(sizeof(int) * result.size);
+    result.size = 0;
+    for (int l = 0; l < nb_touched; l++)
+    {
+        int j = touched[l];
+        if (counts[j] != 0)
         {
-            result[i].liste_indice[l] = tmp_line[l];
+            result.liste_indice[result.size] = j;
+            result.coeff[result.size] = counts[j];
+            result.size++;
         }
+        counts[j] = 0;
     }
-    free(tmp_line);
     return result;
 }
 
 /**
  * Multiplication of two polynomial matrix, but result in Z, not in 2.
  * nb_columns_matrix1 must be equals to nb_rows_matrix2
- * Inspiration from https://www.geeksforgeeks.org/c-matrix-multiplication/
+ * Same buckets as multiplication_polynomial_matrix, counting instead of keeping the parity.
  *
  * @param matrix1 matrix to multiply with
  * @param matrix2 matrix to get multiplied
@@ -197,50 +264,122 @@ polynome_Z *multiplication_polynomial_matrix_Z(polynome *polynomial_matrix1, pol
 {
     polynome_Z *result = (polynome_Z *)malloc(sizeof(polynome_Z) * nb_rows_polynome1);
 
-    int *tmp_line_index = (int *)malloc(nb_columns_polynome2 * sizeof(int));
-    int *tmp_line_coeff = (int *)malloc(nb_columns_polynome2 * sizeof(int));
-
-    int value, current_index, index;
+    int *counts = (int *)calloc(nb_columns_polynome2, sizeof(int));
+    int *touched = (int *)malloc(nb_columns_polynome2 * sizeof(int));
 
     for (int i = 0; i < nb_rows_polynome1; i++)
     {
-        current_index = 0;
-
-        for (int j = 0; j < nb_columns_polynome2; j++)
+        int nb_touched = 0;
+        for (int k = 0; k < polynomial_matrix1[i].size; k++)
         {
-            value = 0;
-            for (int k = 0; k < polynomial_matrix1[i].size; k++)
-            {
-                index = polynomial_matrix1[i].liste_indice[k];
-                value += search(&j, polynomial_matrix2[index].liste_indice, polynomial_matrix2[index].size);
-            }
-            if (value != 0)
+            polynome line = polynomial_matrix2[polynomial_matrix1[i].liste_indice[k]];
+            for (int l = 0; l < line.size; l++)
             {
-                tmp_line_index[current_index] = j;
-                tmp_line_coeff[current_index] = value;
-                current_index++;
+                int j = line.liste_indice[l];
+                if (counts[j]++ == 0)
+                    touched[nb_touched++] = j;
             }
         }
+        result[i] = collect_buckets(counts, touched, nb_touched, nb_columns_polynome2);
+    }
+    free(counts);
+    free(touched);
+    return result;
+}
 
-        result[i].size = current_index;
-        result[i].liste_indice = (int *)malloc(sizeof(int) * current_index);
-        result[i].coeff = (int *)malloc(sizeof(int) * current_index);
-        current_index = 0;
-
-        for (int l = 0; l < result[i].size; l++)
+/**
+ * Product of two sparse polynomials in Z[X] / (X^n - 1).
+ *
+ * @param polynome1 support of the first polynomial, indices < n
+ * @param polynome2 support of the second polynomial, indices < n
+ * @param n size of the ring
+ * @return coefficient of each exponent of the product, sorted
+ */
+polynome_Z convolution_polynome_Z(polynome polynome1, polynome polynome2, unsigned int n)
+{
+    int *counts = (int *)calloc(n, sizeof(int));
+    int *touched = (int *)malloc(n * sizeof(int));
+    int nb_touched = 0;
+    for (int k = 0; k < polynome1.size; k++)
+    {
+        for (int l = 0; l < polynome2.size; l++)
         {
-            result[i].liste_indice[l] = tmp_line_index[l];
-            result[i].coeff[l] = tmp_line_coeff[l];
+            int j = (polynome1.liste_indice[k] + polynome2.liste_indice[l]) % n;
+            if (counts[j]++ == 0)
+                touched[nb_touched++] = j;
         }
     }
-    free(tmp_line_index);
-    free(tmp_line_coeff);
+    polynome_Z result = collect_buckets(counts, touched, nb_touched, n);
+    free(counts);
+    free(touched);
     return result;
 }
 
+/**
+ * counters += support * vector in Z[X] / (X^n - 1), vector being dense.
+ * For each index k of the support, vector rotated by k is added to the counters in two
+ * contiguous loops without modulo, which the compiler vectorizes.
+ * With vector the syndrome (permuted for the quasi-cyclic shift), the counters are the
+ * numbers of unsatisfied parity checks of the bit flipping decoder.
+ *
+ * @param support sparse polynomial, indices < n
+ * @param vector dense polynomial, n coefficients
+ * @param n size of the ring
+ * @param counters dense accumulator, n coefficients
+ */
+void convolution_counters(polynome support, const int *vector, unsigned int n, int *counters)
+{
+    for (int k = 0; k < support.size; k++)
+    {
+        unsigned int shift = support.liste_indice[k];
+        // counters[shift + m] += vector[m] then counters[m] += vector[n - shift + m]
+        int *restrict high = counters + shift;
+        const int *restrict low = vector;
+        for (unsigned int m = 0; m < n - shift; m++)
+            high[m] += low[m];
+        const int *restrict wrapped = vector + n - shift;
+        for (unsigned int m = 0; m < shift; m++)
+            counters[m] += wrapped[m];
+    }
+}
+
+/**
+ * Sum of two sorted supports, merged in one pass : an index in both cancels (1 + 1 = 0).
+ *
+ * @param polynome1 sorted support
+ * @param polynome2 sorted support
+ * @param result sorted support of the sum, big enough, or NULL to only count
+ * @return size of the sum
+ */
+static int merge_polynome(polynome polynome1, polynome polynome2, int *result)
+{
+    int k1 = 0, k2 = 0, size = 0;
+    while (k1 < polynome1.size && k2 < polynome2.size)
+    {
+        int index1 = polynome1.liste_indice[k1], index2 = polynome2.liste_indice[k2];
+        if (index1 != index2 && result != NULL)
+            result[size] = index1 < index2 ? index1 : index2;
+        size += index1 != index2;
+        k1 += index1 <= index2;
+        k2 += index2 <= index1;
+    }
+    for (; k1 < polynome1.size; k1++, size++)
+    {
+        if (result != NULL)
+            result[size] = polynome1.liste_indice[k1];
+    }
+    for (; k2 < polynome2.size; k2++, size++)
+    {
+        if (result != NULL)
+            result[size] = polynome2.liste_indice[k2];
+    }
+    return size;
+}
+
 /**
  * add two polynomial matrix.
  * matrix must be the same dimensions
+ * Each row is the XOR merge of both rows, allocated once with its exact size.
  *
  * @param matrix1 matrix
  * @param matrix2 matrix
@@ -252,44 +391,13 @@ polynome_Z *multiplication_polynomial_matrix_Z(polynome *polynomial_matrix1, pol
 polynome *add_polymonial_matrix(polynome *polynome1, polynome *polynome2, unsigned int nb_rows_polynome, unsigned int nb_columns_polynome, unsigned int start)
 {
     polynome *result = (polynome *)malloc(sizeof(polynome) * nb_rows_polynome);
-    int current_index, index;
-    int *tmp_line = (int *)malloc(sizeof(int) * nb_columns_polynome);
 
     for (int i = 0; i < nb_rows_polynome; i++)
     {
-        // Each line we check both polynomes
-        current_index = 0;
-        for (int j = 0; j < polynome1[i].size; j++)
-        {
-            index = polynome1[i].liste_indice[j];
-            // If the index is only on polynome 1 we store in the result polynome
-            if (!search(&index, polynome2[i].liste_indice, polynome2[i].size))
-            {
-                tmp_line[current_index] = index;
-                current_index++;
-            }
-        }
-        for (int k = 0; k < polynome2[i].size; k++)
-        {
-            index = polynome2[i].liste_indice[k];
-            /// If the index is only on polynome 2 we store in the result polynome
-            if (!search(&index, polynome1[i].liste_indice, polynome1[i].size))
-            {
-                tmp_line[current_index] = index;
-                current_index++;
-            }
-        }
-        result[i].size = current_index;
+        result[i].size = merge_polynome(polynome1[i], polynome2[i], NULL);
         result[i].liste_indice = (int *)malloc(sizeof(int) * result[i].size);
-
-        qsort(tmp_line, current_index, sizeof(int), compare_int);
-
-        for (int l = 0; l < current_index; l++)
-        {
-            result[i].liste_indice[l] = tmp_line[l];
-        }
+        merge_polynome(polynome1[i], polynome2[i], result[i].liste_indice);
     }
-    free(tmp_line);
     return result;
 }
 
@@ -309,7 +417,7 @@ bit **conversion_polynome_to_binary(polynome *matrix, unsigned int nb_rows, unsi
     for (int i = 0; i < nb_rows; i++)
     {
         for (int j = 0; j < matrix[i].size; j++)
-            binary_matrix[i][matrix[i].liste_indice[j]].value = 1;
+            set_matrix_bit(binary_matrix, i, matrix[i].liste_indice[j], 1);
     }
     return binary_matrix;
 }
\ No newline at end of file
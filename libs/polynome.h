@@ -27,6 +27,7 @@ typedef struct
 
 polynome *init_polynomial_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
 void free_polynomial_matrix(polynome *polynomial_matrix, unsigned int nb_rows);
+void free_polynomial_matrix_Z(polynome_Z *polynomial_matrix_Z, unsigned int nb_rows);
 
 void print_polynomial_matrix(polynome *polynomial_matrix, unsigned int nb_rows);
 void print_polynomial_matrix_Z(polynome_Z *polynomial_Z_matrix, unsigned int nb_rows);
@@ -39,6 +40,11 @@ polynome *multiplication_polynomial_matrix(polynome *polynomial_matrix1, polynom
 polynome_Z *multiplication_polynomial_matrix_Z(polynome *polynomial_matrix1, polynome *polynomial_matrix2, unsigned int nb_rows_polynome1, unsigned int nb_columns_polynome2);
 bit **conversion_polynome_to_binary(polynome *matrix, unsigned int nb_rows, unsigned int nb_columns);
 
+// Convolutions in Z[X] / (X^n - 1)
+
+polynome_Z convolution_polynome_Z(polynome polynome1, polynome polynome2, unsigned int n);
+void convolution_counters(polynome support, const int *vector, unsigned int n, int *counters);
+
 // Multiplication utilities
 
 int compare_int(const void *a, const void *b);
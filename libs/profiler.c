@@ -0,0 +1,210 @@
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Wall clock profiler of the phases of MDPC and ISD.
+ * Each phase keeps a count, a total and a log-linear histogram of its durations,
+ * so the memory does not grow with the number of timings and the percentiles stay cheap.
+ * The statistics live in a phase_profiler owned by the caller, so the library keeps no state :
+ * each thread records in its own profiler without any lock, and the profilers are merged
+ * when the report is written.
+ */
+
+// Names of the phases, in the order of profiler_phase
+static const char *phase_names[] = {"keygen", "pubkey", "encrypt", "decode", "decoder_iteration", "isd_sample", "isd_invert", "isd_check"};
+
+/**
+ * Monotonic wall clock (not the CPU time of clock()).
+ *
+ * @return time in ns since an arbitrary origin
+ */
+uint64_t monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * Bucket of a duration : exact below PROFILER_SUB_BUCKETS, else PROFILER_SUB_BUCKETS buckets
+ * for each power of 2.
+ */
+static unsigned int bucket_index(uint64_t duration)
+{
+    if (duration < PROFILER_SUB_BUCKETS)
+        return duration;
+    unsigned int exponent = 63 - __builtin_clzll(duration);
+    unsigned int sub_bucket = (duration >> (exponent - 4)) & (PROFILER_SUB_BUCKETS - 1);
+    return (exponent - 3) * PROFILER_SUB_BUCKETS + sub_bucket;
+}
+
+/**
+ * Largest duration of a bucket.
+ */
+static uint64_t bucket_upper_bound(unsigned int index)
+{
+    if (index < PROFILER_SUB_BUCKETS)
+        return index;
+    unsigned int exponent = index / PROFILER_SUB_BUCKETS + 3;
+    uint64_t lower = (uint64_t)(PROFILER_SUB_BUCKETS + index % PROFILER_SUB_BUCKETS) << (exponent - 4);
+    return lower + ((uint64_t)1 << (exponent - 4)) - 1;
+}
+
+/**
+ * Initialize a profiler without any timing.
+ *
+ * @return the profiler, freed by free_profiler
+ */
+phase_profiler *init_profiler(void)
+{
+    return (phase_profiler *)calloc(1, sizeof(phase_profiler));
+}
+
+void free_profiler(phase_profiler *profiler)
+{
+    free(profiler);
+}
+
+void reset_profiler(phase_profiler *profiler)
+{
+    memset(profiler, 0, sizeof(phase_profiler));
+}
+
+/**
+ * Start a timer.
+ *
+ * @param profiler profiler recording the duration, NULL to only measure it
+ * @param phase phase timed
+ * @return the running timer
+ */
+profiler_timer start_timer(phase_profiler *profiler, profiler_phase phase)
+{
+    profiler_timer timer;
+    timer.profiler = profiler;
+    timer.phase = phase;
+    timer.start = monotonic_ns();
+    return timer;
+}
+
+/**
+ * Add a duration to statistics owned by the caller (no lock).
+ *
+ * @param phase statistics to update
+ * @param duration duration in ns
+ */
+void record_duration(phase_statistics *phase, uint64_t duration)
+{
+    if (phase->count == 0 || duration < phase->min)
+        phase->min = duration;
+    if (duration > phase->max)
+        phase->max = duration;
+    phase->count++;
+    phase->total += duration;
+    phase->histogram[bucket_index(duration)]++;
+}
+
+/**
+ * Add the durations of statistics to a total, for statistics kept by each thread.
+ *
+ * @param total statistics to update
+ * @param part statistics to add
+ */
+void merge_phase_statistics(phase_statistics *total, phase_statistics *part)
+{
+    if (part->count == 0)
+        return;
+    if (total->count == 0 || part->min < total->min)
+        total->min = part->min;
+    if (part->max > total->max)
+        total->max = part->max;
+    total->count += part->count;
+    total->total += part->total;
+    for (unsigned int b = 0; b < PROFILER_BUCKETS; b++)
+        total->histogram[b] += part->histogram[b];
+}
+
+/**
+ * Add every phase of a profiler to a total, for the profilers of the workers of a parallel run.
+ *
+ * @param total profiler to update
+ * @param part profiler to add
+ */
+void merge_profiler(phase_profiler *total, phase_profiler *part)
+{
+    for (int p = 0; p < NB_PHASES; p++)
+        merge_phase_statistics(&total->phases[p], &part->phases[p]);
+}
+
+/**
+ * Stop a timer and record its duration in its profiler, if any.
+ *
+ * @param timer timer returned by start_timer
+ * @return the duration in ns
+ */
+uint64_t stop_timer(profiler_timer timer)
+{
+    uint64_t duration = monotonic_ns() - timer.start;
+    if (timer.profiler != NULL)
+        record_duration(&timer.profiler->phases[timer.phase], duration);
+    return duration;
+}
+
+phase_statistics get_phase_statistics(phase_profiler *profiler, profiler_phase phase)
+{
+    return profiler->phases[phase];
+}
+
+/**
+ * Percentile of the durations of a phase.
+ *
+ * @param statistics statistics of the phase
+ * @param percentile between 0 and 100
+ * @return upper bound of the bucket holding the percentile (at most the max), 0 if no timing
+ */
+uint64_t phase_percentile(phase_statistics statistics, double percentile)
+{
+    if (statistics.count == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(percentile / 100 * statistics.count);
+    if (rank >= statistics.count)
+        rank = statistics.count - 1;
+    uint64_t seen = 0;
+    for (unsigned int b = 0; b < PROFILER_BUCKETS; b++)
+    {
+        seen += statistics.histogram[b];
+        if (seen > rank)
+        {
+            uint64_t bound = bucket_upper_bound(b);
+            return bound < statistics.max ? bound : statistics.max;
+        }
+    }
+    return statistics.max;
+}
+
+const char *phase_name(profiler_phase phase)
+{
+    return phase_names[phase];
+}
+
+/**
+ * Write the statistics of every phase in JSON, durations in ns.
+ * Every phase is written, even without timing, so that two reports have the same keys.
+ *
+ * @param profiler profiler to report
+ * @param output file to write in
+ */
+void write_profiler_report(phase_profiler *profiler, FILE *output)
+{
+    fprintf(output, "{\n  \"unit\": \"ns\",\n  \"phases\": {\n");
+    for (int p = 0; p < NB_PHASES; p++)
+    {
+        phase_statistics phase = get_phase_statistics(profiler, (profiler_phase)p);
+        fprintf(output, "    \"%s\": {\"count\": %lu, \"total\": %lu, \"mean\": %.1f, \"min\": %lu, \"max\": %lu, "
+                        "\"p50\": %lu, \"p90\": %lu, \"p99\": %lu, \"p999\": %lu}%s\n",
+                phase_names[p], phase.count, phase.total, phase.count ? (double)phase.total / phase.count : 0.0,
+                phase.min, phase.max, phase_percentile(phase, 50), phase_percentile(phase, 90),
+                phase_percentile(phase, 99), phase_percentile(phase, 99.9), p < NB_PHASES - 1 ? "," : "");
+    }
+    fprintf(output, "  }\n}\n");
+}
@@ -0,0 +1,88 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// 16 buckets per power of 2 : the percentiles are exact below 16 ns and within 6 % above
+#define PROFILER_SUB_BUCKETS 16
+#define PROFILER_BUCKETS (61 * PROFILER_SUB_BUCKETS)
+
+/**
+ * Phases timed by the profiler
+ */
+typedef enum
+{
+    PHASE_KEYGEN,            /** private key generation */
+    PHASE_PUBKEY,            /** public key generation */
+    PHASE_ENCRYPT,           /** cypher of one message */
+    PHASE_DECODE,            /** whole decoding of one message */
+    PHASE_DECODER_ITERATION, /** one iteration of a decoder */
+    PHASE_ISD_SAMPLE,        /** choice of the columns of one ISD iteration */
+    PHASE_ISD_INVERT,        /** inversion of one ISD iteration */
+    PHASE_ISD_CHECK,         /** product and weight check of one ISD iteration */
+    NB_PHASES
+} profiler_phase;
+
+/**
+ * Durations of one phase, in ns.
+ */
+typedef struct
+{
+    uint64_t count;                       /** number of timings */
+    uint64_t total;                       /** sum of the durations */
+    uint64_t min;                         /** shortest duration */
+    uint64_t max;                         /** longest duration */
+    uint64_t histogram[PROFILER_BUCKETS]; /** number of durations in each log-linear bucket */
+} phase_statistics;
+
+/**
+ * Statistics of every phase, owned by the caller.
+ * A profiler records the timings of one thread at a time : the workers of a parallel run
+ * each own one and merge it into the total with merge_profiler.
+ */
+typedef struct
+{
+    phase_statistics phases[NB_PHASES]; /** durations of each phase */
+} phase_profiler;
+
+/**
+ * Running timer, started by start_timer.
+ */
+typedef struct
+{
+    phase_profiler *profiler; /** profiler recording the duration, NULL to only measure */
+    profiler_phase phase;     /** phase timed */
+    uint64_t start;           /** start in ns */
+} profiler_timer;
+
+// Clock
+
+uint64_t monotonic_ns(void);
+
+// Statistics kept by the caller, with the same histogram as the phases
+
+void record_duration(phase_statistics *phase, uint64_t duration);
+void merge_phase_statistics(phase_statistics *total, phase_statistics *part);
+
+// Creation and Destruction of a profiler
+
+phase_profiler *init_profiler(void);
+void free_profiler(phase_profiler *profiler);
+void reset_profiler(phase_profiler *profiler);
+void merge_profiler(phase_profiler *total, phase_profiler *part);
+
+// Timers, a NULL profiler only measures the duration
+
+profiler_timer start_timer(phase_profiler *profiler, profiler_phase phase);
+uint64_t stop_timer(profiler_timer timer);
+
+// Report
+
+phase_statistics get_phase_statistics(phase_profiler *profiler, profiler_phase phase);
+uint64_t phase_percentile(phase_statistics statistics, double percentile);
+const char *phase_name(profiler_phase phase);
+void write_profiler_report(phase_profiler *profiler, FILE *output);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "reference_kem.h"
+
+/**
+ * Key generation, cypher and decoding on the n x n matrices h0 and h1 (reference version).
+ * The matrices are those of matrix_backend.h, so the same code runs on every backend.
+ * Nothing is printed : the caller displays the durations and the hashes of the errors.
+ */
+
+/**
+ * Generation of the private key
+ * @param h0 first part of the private key (n x n)
+ * @param h1 second part of the private key (n x n), in the backend of h0
+ * @param weight weight of each line
+ * @param generator random generator
+ * @param profiler profiler of the phases, NULL if not profiled
+ * @param duration result, wall time of the generation in ns
+ *
+ */
+void privkey_generation(backend_matrix h0, backend_matrix h1, unsigned int weight, drbg *generator, phase_profiler *profiler, uint64_t *duration)
+{
+    profiler_timer timer = start_timer(profiler, PHASE_KEYGEN);
+    unsigned int n = h0.nb_columns;
+    // Support of the first line of each matrix that will be used for the permutation
+    int *first_line_h0 = (int *)malloc(sizeof(int) * weight);
+    int *first_line_h1 = (int *)malloc(sizeof(int) * weight);
+    sample_support(generator, first_line_h0, weight, n);
+    sample_support(generator, first_line_h1, weight, n);
+
+    // A shift which is not coprime with n would give the same line several times
+    unsigned int random_shift;
+    do
+    {
+        random_shift = 1 + uniform_drbg(generator, n - 1);
+    } while (!is_coprime_shift(random_shift, n));
+    // Line i is the first line shifted by (i + 1) * random_shift, as shift_line : line[j] = first_line[(j + shift) % n]
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    for (unsigned int i = 0; i < h0.nb_rows; i++)
+    {
+        unsigned int shift = (unsigned int)(((unsigned long)(i + 1) * random_shift) % n);
+        for (int part = 0; part < 2; part++)
+        {
+            int *first_line = part == 0 ? first_line_h0 : first_line_h1;
+            for (unsigned int k = 0; k < NB_WORDS(n); k++)
+                words[k] = 0;
+            for (unsigned int k = 0; k < weight; k++)
+            {
+                unsigned int j = (first_line[k] + n - shift) % n;
+                words[j / WORD_SIZE] |= (uint64_t)1 << (j % WORD_SIZE);
+            }
+            unpack_backend_row(part == 0 ? h0 : h1, i, words);
+        }
+    }
+
+    *duration = stop_timer(timer);
+    free(words);
+    free(first_line_h0);
+    free(first_line_h1);
+}
+
+/**
+ * Rows of a backend matrix as hybrid polynomials, each row in its own representation.
+ *
+ * @param matrix binary matrix
+ * @return hybrid polynomial matrix of nb_rows rows
+ */
+static hybrid_polynome *init_hybrid_backend_matrix(backend_matrix matrix)
+{
+    hybrid_polynome *polynomial_matrix = (hybrid_polynome *)malloc(sizeof(hybrid_polynome) * matrix.nb_rows);
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(matrix.nb_columns));
+    for (unsigned int i = 0; i < matrix.nb_rows; i++)
+    {
+        pack_backend_row(matrix, i, words);
+        polynomial_matrix[i] = init_hybrid_polynome_from_words(words, matrix.nb_columns);
+    }
+    free(words);
+    return polynomial_matrix;
+}
+
+/**
+ * Generate public key from the private key
+ *
+ * @param h0 the first part of the private key
+ * @param h1 the second part of the private key
+ * @param profiler profiler of the phases, NULL if not profiled
+ * @param counters hardware counters, NULL if not measured
+ * @param duration result, wall time of the generation in ns
+ * @return the multiplication of both (a polynomial matrix), NULL if h0 is not invertible
+ */
+polynome *pubkey_generation(backend_matrix h0, backend_matrix h1, phase_profiler *profiler, perf_counters *counters, uint64_t *duration)
+{
+    unsigned int nb_rows = h0.nb_rows;
+    unsigned int nb_columns = h0.nb_columns;
+    profiler_timer timer = start_timer(profiler, PHASE_PUBKEY);
+    perf_measure measure = start_perf_measure(counters, SITE_PUBKEY);
+    int is_invertible;
+    backend_matrix inversion_h0 = inversion_backend_matrix(h0, &is_invertible);
+    if (!is_invertible)
+    {
+        stop_perf_measure(measure, (uint64_t)nb_rows * nb_columns);
+        *duration = stop_timer(timer);
+        free_backend_matrix(inversion_h0);
+        return NULL;
+    }
+    // Switching h0^-1 (dense) and h1 (sparse) to polynome for the multiplication
+    hybrid_polynome *polynome_matrix_A = init_hybrid_backend_matrix(inversion_h0);
+    hybrid_polynome *polynome_matrix_B = init_hybrid_backend_matrix(h1);
+    // Private key
+    hybrid_polynome *product = multiplication_hybrid_polynomial_matrix(polynome_matrix_A, polynome_matrix_B, nb_rows, nb_columns);
+    polynome *h = hybrid_to_polynomial_matrix(product, nb_rows);
+
+    stop_perf_measure(measure, (uint64_t)nb_rows * nb_columns);
+    *duration = stop_timer(timer);
+    free_backend_matrix(inversion_h0);
+    free_hybrid_polynomial_matrix(polynome_matrix_A, nb_rows);
+    free_hybrid_polynomial_matrix(polynome_matrix_B, nb_rows);
+    free_hybrid_polynomial_matrix(product, nb_rows);
+
+    return h;
+}
+
+/**
+ * Initialize the decoder of a private key given by backend matrices.
+ *
+ * @param h0 first part of the private key (n x n)
+ * @param h1 second part of the private key (n x n)
+ * @param t weight of the whole error, used for the thresholds
+ * @return the decoder, syndrome and error set to zero
+ */
+decoder_context init_decoder_context_from_matrices(backend_matrix h0, backend_matrix h1, unsigned int t)
+{
+    unsigned int n = h0.nb_rows;
+    // Rows of H = [h0 | h1], read through a view instead of a copy of H
+    matrix_view left = whole_view(h0);
+    matrix_view right = whole_view(h1);
+    matrix_view H = concatenated_view(&left, &right);
+    polynome *rows = (polynome *)malloc(sizeof(polynome) * n);
+    int *support = (int *)malloc(sizeof(int) * H.nb_columns);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        rows[i].size = view_row_support(H, i, support);
+        rows[i].liste_indice = (int *)malloc(sizeof(int) * rows[i].size);
+        memcpy(rows[i].liste_indice, support, sizeof(int) * rows[i].size);
+    }
+    free(support);
+    return init_decoder_context_from_rows(rows, n, t);
+}
+
+/**
+ * Decode a cypher, as decode_cypher on backend matrices.
+ *
+ * @param context decoder of the private key
+ * @param decoder decoder to use
+ * @param c cypher (1 x n)
+ * @param threshold threshold of the fixed threshold decoders
+ * @param weight weight of each part of the error
+ * @param e0_output first part of the error found (1 x n), allocated by the caller
+ * @param e1_output second part of the error found (1 x n), allocated by the caller
+ * @return 1 if the error has been decoded, 0 else
+ */
+int decode_matrix_cypher(decoder_context *context, decoder_type decoder, backend_matrix c, int threshold, unsigned int weight, backend_matrix e0_output, backend_matrix e1_output)
+{
+    unsigned int n = context->nb_rows;
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(2 * n));
+    pack_backend_row(c, 0, words);
+    load_packed_cypher(context, words);
+    int decoded = decode_syndrome(context, decoder, threshold, weight);
+    if (decoded)
+    {
+        store_packed_error(context, words);
+        unpack_backend_row(e0_output, 0, words);
+        // e1 starts at bit n of the packed error
+        uint64_t *e1_words = (uint64_t *)calloc(NB_WORDS(n), sizeof(uint64_t));
+        for (unsigned int j = 0; j < n; j++)
+            e1_words[j / WORD_SIZE] |= ((words[(n + j) / WORD_SIZE] >> ((n + j) % WORD_SIZE)) & 1) << (j % WORD_SIZE);
+        unpack_backend_row(e1_output, 0, e1_words);
+        free(e1_words);
+    }
+    free(words);
+    return decoded;
+}
+
+/**
+ * Cypher the error generated by the public key : c = e0 + h * e1
+ * @param e0 first error generated (1 x n)
+ * @param e1 second error generated (1 x n), in the backend of e0
+ * @param pubkey public key
+ * @param e weight of the error
+ * @param generator random generator
+ * @param profiler profiler of the phases, NULL if not profiled
+ * @param duration result, wall time of the cypher in ns
+ *
+ * @return the cypher matrix (1 x n) in the backend of e0
+ */
+backend_matrix cypher(backend_matrix e0, backend_matrix e1, polynome *pubkey, int e, drbg *generator, phase_profiler *profiler, uint64_t *duration)
+{
+    unsigned int n = e0.nb_columns;
+    profiler_timer timer = start_timer(profiler, PHASE_ENCRYPT);
+    // Creating the two errors of weight w = e/2
+    target_weight_backend_matrix(generator, e0, e / 2);
+    target_weight_backend_matrix(generator, e1, e / 2);
+
+    // Bit i of h * e1 is the parity of the indices of line i of h set in e1
+    uint64_t *packed_e1 = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(n));
+    pack_backend_row(e1, 0, packed_e1);
+    pack_backend_row(e0, 0, words);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        uint64_t parity = 0;
+        for (int k = 0; k < pubkey[i].size; k++)
+        {
+            int index = pubkey[i].liste_indice[k];
+            parity ^= packed_e1[index / WORD_SIZE] >> (index % WORD_SIZE);
+        }
+        words[i / WORD_SIZE] ^= (parity & 1) << (i % WORD_SIZE);
+    }
+    backend_matrix c = init_backend_matrix(e0.backend, 1, n);
+    unpack_backend_row(c, 0, words);
+    *duration = stop_timer(timer);
+
+    free(packed_e1);
+    free(words);
+    return c;
+}
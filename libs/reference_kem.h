@@ -0,0 +1,22 @@
+#ifndef REFERENCE_KEM_H
+#define REFERENCE_KEM_H
+
+#include "polynome.h"
+#include "matrix_backend.h"
+#include "matrix_view.h"
+#include "decoder.h"
+#include "drbg.h"
+#include "../libs_optimized/hybrid_polynome.h"
+
+// Keys and cypher on the n x n matrices of a backend, the errors and the cypher are 1 x n
+
+void privkey_generation(backend_matrix h0, backend_matrix h1, unsigned int weight, drbg *generator, phase_profiler *profiler, uint64_t *duration);
+polynome *pubkey_generation(backend_matrix h0, backend_matrix h1, phase_profiler *profiler, perf_counters *counters, uint64_t *duration);
+backend_matrix cypher(backend_matrix e0, backend_matrix e1, polynome *pubkey, int e, drbg *generator, phase_profiler *profiler, uint64_t *duration);
+
+// Decoder of backend matrices
+
+decoder_context init_decoder_context_from_matrices(backend_matrix h0, backend_matrix h1, unsigned int t);
+int decode_matrix_cypher(decoder_context *context, decoder_type decoder, backend_matrix c, int threshold, unsigned int weight, backend_matrix e0_output, backend_matrix e1_output);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "serialization.h"
+
+/**
+ * Compact binary format of the keys and cyphers.
+ * The private key is quasi-cyclic, so only the support of the first line of h0 and h1
+ * and the shift between two lines are stored (12 + 8w bytes). The public key is circulant,
+ * so only its first line is stored, packed (4 + n / 8 bytes).
+ * Reading only checks the buffer and points into it, nothing is copied.
+ */
+
+static void store_uint32(uint8_t *buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        buffer[i] = (value >> (8 * i)) & 0xff;
+}
+
+static uint32_t load_uint32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/**
+ * Check that line 1 of a matrix is its line 0 shifted by shift.
+ *
+ * @param matrix quasi-cyclic matrix (n x n)
+ * @param n size of the matrix
+ * @param shift shift to check
+ * @return 1 if line_1[j] = line_0[(j + shift) % n] for every j, 0 else
+ */
+static int is_line_shift(bit **matrix, unsigned int n, unsigned int shift)
+{
+    for (unsigned int j = 0; j < n; j++)
+    {
+        if (get_matrix_bit(matrix, 1, j) != get_matrix_bit(matrix, 0, (j + shift) % n))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Write a private key generated by privkey_generation.
+ *
+ * @param h0 first part of the private key (n x n)
+ * @param h1 second part of the private key (n x n)
+ * @param n size of the private key, at least 2
+ * @param buffer result, PRIVATE_KEY_BYTES(w) bytes
+ * @return number of bytes written, 0 if the key is not quasi-cyclic with lines of the same weight
+ */
+size_t write_private_key(bit **h0, bit **h1, unsigned int n, uint8_t *buffer)
+{
+    unsigned int w = 0, w1 = 0;
+    for (unsigned int j = 0; j < n; j++)
+    {
+        w += get_matrix_bit(h0, 0, j);
+        w1 += get_matrix_bit(h1, 0, j);
+    }
+    if (n < 2 || w == 0 || w != w1)
+        return 0;
+
+    // line_1[j] = line_0[(j + shift) % n], so shift = b - a for a in line 1 and some b in line 0
+    unsigned int a = 0;
+    while (a < n && !get_matrix_bit(h0, 1, a))
+        a++;
+    if (a == n)
+        return 0;
+    int shift = -1;
+    for (unsigned int b = 0; b < n && shift < 0; b++)
+    {
+        unsigned int candidate = (b + n - a) % n;
+        if (get_matrix_bit(h0, 0, b) && is_line_shift(h0, n, candidate) && is_line_shift(h1, n, candidate))
+            shift = candidate;
+    }
+    if (shift < 0)
+        return 0;
+
+    // Supports of the first lines, sorted
+    polynome *h0_support = init_polynomial_matrix(h0, 1, n);
+    polynome *h1_support = init_polynomial_matrix(h1, 1, n);
+    size_t size = write_private_key_from_support(h0_support[0], h1_support[0], n, shift, buffer);
+    free_polynomial_matrix(h0_support, 1);
+    free_polynomial_matrix(h1_support, 1);
+    return size;
+}
+
+/**
+ * Write a private key given by the support of the first line of h0 and h1.
+ *
+ * @param h0_support sorted support of the first line of h0
+ * @param h1_support sorted support of the first line of h1, same weight as h0_support
+ * @param n size of the private key
+ * @param shift shift between two lines
+ * @param buffer result, PRIVATE_KEY_BYTES(w) bytes
+ * @return number of bytes written
+ */
+size_t write_private_key_from_support(polynome h0_support, polynome h1_support, unsigned int n, unsigned int shift, uint8_t *buffer)
+{
+    store_uint32(buffer, n);
+    store_uint32(buffer + 4, h0_support.size);
+    store_uint32(buffer + 8, shift);
+    uint8_t *support = buffer + PRIVATE_KEY_HEADER_BYTES;
+    for (int k = 0; k < h0_support.size; k++)
+        store_uint32(support + 4 * k, h0_support.liste_indice[k]);
+    support += 4 * h0_support.size;
+    for (int k = 0; k < h1_support.size; k++)
+        store_uint32(support + 4 * k, h1_support.liste_indice[k]);
+    return PRIVATE_KEY_BYTES(h0_support.size);
+}
+
+/**
+ * Read a private key.
+ * The length, the weight, the shift (coprime with n) and the supports (sorted, distinct, < n) are checked.
+ *
+ * @param buffer serialized private key
+ * @param size size of the buffer
+ * @param key result, points into the buffer
+ * @return 1 if the private key is valid, 0 else
+ */
+int read_private_key(const uint8_t *buffer, size_t size, private_key_view *key)
+{
+    if (size < PRIVATE_KEY_HEADER_BYTES)
+        return 0;
+    key->n = load_uint32(buffer);
+    key->w = load_uint32(buffer + 4);
+    key->shift = load_uint32(buffer + 8);
+    key->supports = buffer + PRIVATE_KEY_HEADER_BYTES;
+    // The rows of H are distinct only if gcd(shift, n) == 1, which excludes a null shift
+    if (key->n == 0 || key->w == 0 || key->w > key->n || key->shift >= key->n || !is_coprime_shift(key->shift, key->n))
+        return 0;
+    if (size != PRIVATE_KEY_BYTES((size_t)key->w))
+        return 0;
+
+    for (unsigned int part = 0; part < 2; part++)
+    {
+        for (unsigned int k = 0; k < key->w; k++)
+        {
+            unsigned int index = private_key_index(*key, part, k);
+            if (index >= key->n || (k > 0 && index <= private_key_index(*key, part, k - 1)))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Index of the support of the first line of h0 or h1.
+ *
+ * @param key private key
+ * @param part 0 for h0, 1 for h1
+ * @param k rank of the index, < w
+ * @return the index
+ */
+unsigned int private_key_index(private_key_view key, unsigned int part, unsigned int k)
+{
+    return load_uint32(key.supports + 4 * (part * key.w + k));
+}
+
+/**
+ * Initialize the decoder of a serialized private key.
+ *
+ * @param key private key
+ * @param t weight of the whole error, used for the thresholds
+ * @return the decoder
+ */
+decoder_context init_decoder_context_from_private_key(private_key_view key, unsigned int t)
+{
+    polynome supports[2];
+    for (unsigned int part = 0; part < 2; part++)
+    {
+        supports[part].size = key.w;
+        supports[part].liste_indice = (int *)malloc(sizeof(int) * key.w);
+        for (unsigned int k = 0; k < key.w; k++)
+            supports[part].liste_indice[k] = private_key_index(key, part, k);
+    }
+    decoder_context context = init_decoder_context_from_support(supports[0], supports[1], key.n, key.shift, t);
+    free(supports[0].liste_indice);
+    free(supports[1].liste_indice);
+    return context;
+}
+
+/**
+ * Write a packed binary polynomial (a cypher for example).
+ *
+ * @param words coefficients packed in words, NB_WORDS(n) words
+ * @param n number of coefficients
+ * @param buffer result, PACKED_POLYNOMIAL_BYTES(n) bytes
+ * @return number of bytes written
+ */
+size_t write_packed_polynomial(const uint64_t *words, unsigned int n, uint8_t *buffer)
+{
+    store_uint32(buffer, n);
+    uint8_t *bits = buffer + PACKED_POLYNOMIAL_HEADER_BYTES;
+    for (unsigned int b = 0; b < (n + 7) / 8; b++)
+        bits[b] = (words[b / 8] >> (8 * (b % 8))) & 0xff;
+    // Coefficients after n are not part of the polynomial
+    if (n % 8)
+        bits[n / 8] &= (1 << (n % 8)) - 1;
+    return PACKED_POLYNOMIAL_BYTES(n);
+}
+
+/**
+ * Write a public key generated by pubkey_generation.
+ * The public key is circulant, only its first line is written.
+ *
+ * @param pubkey public key, support of each of its n lines
+ * @param n size of the public key
+ * @param buffer result, PACKED_POLYNOMIAL_BYTES(n) bytes
+ * @return number of bytes written
+ */
+size_t write_public_key(polynome *pubkey, unsigned int n, uint8_t *buffer)
+{
+    uint64_t *words = (uint64_t *)calloc(NB_WORDS(n), sizeof(uint64_t));
+    for (int k = 0; k < pubkey[0].size; k++)
+        words[pubkey[0].liste_indice[k] / WORD_SIZE] |= (uint64_t)1 << (pubkey[0].liste_indice[k] % WORD_SIZE);
+    size_t size = write_packed_polynomial(words, n, buffer);
+    free(words);
+    return size;
+}
+
+/**
+ * Read a packed binary polynomial.
+ * The length and the unused bits of the last byte are checked.
+ *
+ * @param buffer serialized polynomial
+ * @param size size of the buffer
+ * @param polynomial result, points into the buffer
+ * @return 1 if the polynomial is valid, 0 else
+ */
+int read_packed_polynomial(const uint8_t *buffer, size_t size, packed_polynomial_view *polynomial)
+{
+    if (size < PACKED_POLYNOMIAL_HEADER_BYTES)
+        return 0;
+    polynomial->n = load_uint32(buffer);
+    polynomial->bits = buffer + PACKED_POLYNOMIAL_HEADER_BYTES;
+    if (polynomial->n == 0 || size != PACKED_POLYNOMIAL_BYTES((size_t)polynomial->n))
+        return 0;
+    if (polynomial->n % 8 && polynomial->bits[polynomial->n / 8] >> (polynomial->n % 8))
+        return 0;
+    return 1;
+}
+
+/**
+ * Copy a packed polynomial in words.
+ *
+ * @param polynomial polynomial to copy
+ * @param words result, NB_WORDS(n) words
+ */
+void unpack_polynomial(packed_polynomial_view polynomial, uint64_t *words)
+{
+    for (unsigned int i = 0; i < NB_WORDS(polynomial.n); i++)
+        words[i] = 0;
+    for (unsigned int b = 0; b < (polynomial.n + 7) / 8; b++)
+        words[b / 8] |= (uint64_t)polynomial.bits[b] << (8 * (b % 8));
+}
@@ -0,0 +1,51 @@
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include "decoder.h"
+
+// Every integer is stored in little endian on 4 bytes
+#define PRIVATE_KEY_HEADER_BYTES 12
+#define PACKED_POLYNOMIAL_HEADER_BYTES 4
+#define PRIVATE_KEY_BYTES(w) (PRIVATE_KEY_HEADER_BYTES + 8 * (w))
+#define PACKED_POLYNOMIAL_BYTES(n) (PACKED_POLYNOMIAL_HEADER_BYTES + ((n) + 7) / 8)
+
+/**
+ * Private key read in a buffer, without copy.
+ * Format : n, w, shift, then the sorted support of the first line of h0 and of h1 (w indices each).
+ * Line i of h0 and h1 is their first line shifted by i * shift.
+ */
+typedef struct
+{
+    unsigned int n;          /** size of the private key */
+    unsigned int w;          /** weight of each line of h0 and h1 */
+    unsigned int shift;      /** shift between two lines */
+    const uint8_t *supports; /** 2 * w indices of 4 bytes, in the buffer */
+} private_key_view;
+
+/**
+ * Binary polynomial of degree < n read in a buffer, without copy.
+ * Format : n, then the n coefficients packed in bytes (coefficient j is bit j % 8 of byte j / 8).
+ * Used for the public key (its first line, the key is circulant) and for the cyphers.
+ */
+typedef struct
+{
+    unsigned int n;      /** number of coefficients */
+    const uint8_t *bits; /** (n + 7) / 8 bytes, in the buffer */
+} packed_polynomial_view;
+
+// Private key
+
+size_t write_private_key(bit **h0, bit **h1, unsigned int n, uint8_t *buffer);
+size_t write_private_key_from_support(polynome h0_support, polynome h1_support, unsigned int n, unsigned int shift, uint8_t *buffer);
+int read_private_key(const uint8_t *buffer, size_t size, private_key_view *key);
+unsigned int private_key_index(private_key_view key, unsigned int part, unsigned int k);
+decoder_context init_decoder_context_from_private_key(private_key_view key, unsigned int t);
+
+// Public key and cyphers
+
+size_t write_packed_polynomial(const uint64_t *words, unsigned int n, uint8_t *buffer);
+size_t write_public_key(polynome *pubkey, unsigned int n, uint8_t *buffer);
+int read_packed_polynomial(const uint8_t *buffer, size_t size, packed_polynomial_view *polynomial);
+void unpack_polynomial(packed_polynomial_view polynomial, uint64_t *words);
+
+#endif
\ No newline at end of file
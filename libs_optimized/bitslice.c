@@ -0,0 +1,164 @@
+#include "bitslice.h"
+#include "ring.h"
+#include <string.h>
+
+/**
+ * Bit-sliced counters used to count the unsatisfied parity checks of the decoder.
+ * Inspired by the optimized implementation of BIKE : instead of one int per counter,
+ * each bit of the counters is stored in its own array of words (a slice).
+ * Additions and comparisons are then done with word operations, without any branch.
+ */
+
+/**
+ * Initialize bit-sliced counters set to zero.
+ *
+ * @param nb_counters number of counters
+ * @param max_value biggest value a counter can reach
+ * @return the counters
+ */
+bitsliced_counters init_bitsliced_counters(unsigned int nb_counters, unsigned int max_value)
+{
+    bitsliced_counters counters;
+    counters.nb_counters = nb_counters;
+    counters.nb_slices = 1;
+    while ((1u << counters.nb_slices) <= max_value)
+        counters.nb_slices++;
+
+    counters.slices = (uint64_t **)calloc(counters.nb_slices, sizeof(uint64_t *));
+    for (unsigned int b = 0; b < counters.nb_slices; b++)
+        counters.slices[b] = (uint64_t *)calloc(NB_WORDS(nb_counters), sizeof(uint64_t));
+    return counters;
+}
+
+void free_bitsliced_counters(bitsliced_counters counters)
+{
+    for (unsigned int b = 0; b < counters.nb_slices; b++)
+        free(counters.slices[b]);
+    free(counters.slices);
+}
+
+void reset_bitsliced_counters(bitsliced_counters counters)
+{
+    for (unsigned int b = 0; b < counters.nb_slices; b++)
+    {
+        for (unsigned int i = 0; i < NB_WORDS(counters.nb_counters); i++)
+            counters.slices[b][i] = 0;
+    }
+}
+
+/**
+ * Add a binary vector to the counters (counter j is incremented if bit j of the vector is set).
+ * Ripple carry adder applied on every slice, the overflow is dropped.
+ *
+ * @param counters counters to increment
+ * @param vector packed binary vector of nb_counters bits
+ */
+void add_bitsliced_counters(bitsliced_counters counters, uint64_t *vector)
+{
+    for (unsigned int i = 0; i < NB_WORDS(counters.nb_counters); i++)
+    {
+        uint64_t carry = vector[i];
+        for (unsigned int b = 0; b < counters.nb_slices; b++)
+        {
+            uint64_t next_carry = counters.slices[b][i] & carry;
+            counters.slices[b][i] ^= carry;
+            carry = next_carry;
+        }
+    }
+}
+
+/**
+ * Compare every counter with a threshold.
+ * The comparison goes from the most significant slice to the least one.
+ *
+ * @param counters counters to compare
+ * @param threshold value to compare with
+ * @param result packed binary vector, bit j is set if counter j >= threshold
+ */
+void threshold_bitsliced_counters(bitsliced_counters counters, unsigned int threshold, uint64_t *result)
+{
+    for (unsigned int i = 0; i < NB_WORDS(counters.nb_counters); i++)
+    {
+        // Threshold too big to be reached by the counters
+        if (threshold >> counters.nb_slices)
+        {
+            result[i] = 0;
+            continue;
+        }
+        uint64_t greater = 0;
+        uint64_t equal = ~(uint64_t)0;
+        for (int b = counters.nb_slices - 1; b >= 0; b--)
+        {
+            uint64_t threshold_bit = -(uint64_t)((threshold >> b) & 1);
+            greater |= equal & counters.slices[b][i] & ~threshold_bit;
+            equal &= ~(counters.slices[b][i] ^ threshold_bit);
+        }
+        result[i] = greater | equal;
+    }
+    // Positions after nb_counters are not counters
+    if (counters.nb_counters % WORD_SIZE)
+        result[NB_WORDS(counters.nb_counters) - 1] &= ((uint64_t)1 << (counters.nb_counters % WORD_SIZE)) - 1;
+}
+
+/**
+ * Read the value of one counter.
+ *
+ * @param counters counters to read
+ * @param position index of the counter
+ * @return value of the counter
+ */
+unsigned int get_bitsliced_counter(bitsliced_counters counters, unsigned int position)
+{
+    unsigned int value = 0;
+    for (unsigned int b = 0; b < counters.nb_slices; b++)
+        value |= ((counters.slices[b][position / WORD_SIZE] >> (position % WORD_SIZE)) & 1) << b;
+    return value;
+}
+
+/**
+ * Count the unsatisfied parity checks of every position of a quasi-cyclic parity check matrix.
+ * Once the syndrome is permuted as in compute_convolution_counters, the counters of half h are
+ * the sum of the rotations of the permuted syndrome by each index of first_rows[h] : the k-th
+ * index of both halves gives one word-wide rotation added to the vertical counters.
+ * The half with the smallest weight is padded with null rotations.
+ * Counter j of half h is at position h * NB_WORDS(n) * WORD_SIZE + j, each half starts on a word.
+ *
+ * @param counters counters to fill, 2 * NB_WORDS(n) * WORD_SIZE counters
+ * @param doubled_syndrome doubled copy of the permuted syndrome (init_doubled_ring)
+ * @param first_rows support of row 0 in each half, indices < n
+ * @param n size of each half
+ * @param buffer 2 * NB_WORDS(n) words, the rotations of the k-th indices
+ */
+void compute_bitsliced_counters(bitsliced_counters counters, const uint64_t *doubled_syndrome, const polynome *first_rows, unsigned int n, uint64_t *buffer)
+{
+    reset_bitsliced_counters(counters);
+
+    int max_weight = first_rows[0].size > first_rows[1].size ? first_rows[0].size : first_rows[1].size;
+    for (int k = 0; k < max_weight; k++)
+    {
+        for (unsigned int half = 0; half < 2; half++)
+        {
+            uint64_t *rotation = buffer + half * NB_WORDS(n);
+            if (k < first_rows[half].size)
+                rotate_doubled_ring(doubled_syndrome, first_rows[half].liste_indice[k], n, rotation);
+            else
+                memset(rotation, 0, sizeof(uint64_t) * NB_WORDS(n));
+        }
+        add_bitsliced_counters(counters, buffer);
+    }
+}
+
+/**
+ * Pack a binary column (nb_rows x 1) in words.
+ *
+ * @param matrix column to pack
+ * @param nb_rows number of rows
+ * @param packed result, NB_WORDS(nb_rows) words
+ */
+void pack_column(bit **matrix, unsigned int nb_rows, uint64_t *packed)
+{
+    for (unsigned int i = 0; i < NB_WORDS(nb_rows); i++)
+        packed[i] = 0;
+    for (unsigned int i = 0; i < nb_rows; i++)
+        packed[i / WORD_SIZE] |= (uint64_t)get_matrix_bit(matrix, i, 0) << (i % WORD_SIZE);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef BITSLICE_H
+#define BITSLICE_H
+
+#include <stdint.h>
+#include "../libs/polynome.h"
+
+#define WORD_SIZE 64
+#define NB_WORDS(nb_bits) (((nb_bits) + WORD_SIZE - 1) / WORD_SIZE)
+
+/**
+ * Vertical counters : bit b of every counter is stored in slices[b],
+ * so one word operation updates 64 counters at once.
+ */
+typedef struct
+{
+   uint64_t **slices;        /** slices[b][word] holds the bit b of 64 counters */
+   unsigned int nb_slices;   /** Number of bits of each counter */
+   unsigned int nb_counters; /** Number of counters */
+} bitsliced_counters;
+
+// Creation and Destruction of bit-sliced counters
+
+bitsliced_counters init_bitsliced_counters(unsigned int nb_counters, unsigned int max_value);
+void free_bitsliced_counters(bitsliced_counters counters);
+void reset_bitsliced_counters(bitsliced_counters counters);
+
+// Operations on bit-sliced counters
+
+void add_bitsliced_counters(bitsliced_counters counters, uint64_t *vector);
+void threshold_bitsliced_counters(bitsliced_counters counters, unsigned int threshold, uint64_t *result);
+unsigned int get_bitsliced_counter(bitsliced_counters counters, unsigned int position);
+void compute_bitsliced_counters(bitsliced_counters counters, const uint64_t *doubled_syndrome, const polynome *first_rows, unsigned int n, uint64_t *buffer);
+
+// Packing utilities
+
+void pack_column(bit **matrix, unsigned int nb_rows, uint64_t *packed);
+
+#endif
\ No newline at end of file
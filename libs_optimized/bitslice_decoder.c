@@ -0,0 +1,236 @@
+#include "bitslice_decoder.h"
+
+/**
+ * Fixed threshold bit flipping on NB_LANES cyphers in parallel.
+ * The supports of H are the same for every lane, so the loops over the columns and rows
+ * are shared and the work of one lane costs one bit of each word operation.
+ * Every lane follows exactly the decisions of fixed_threshold_bitflip on its own cypher.
+ */
+
+/**
+ * Initialize a lanes decoder for a private key.
+ *
+ * @param context decoder of the private key, must outlive the lanes decoder
+ * @return the lanes decoder, without any cypher loaded
+ */
+lanes_decoder init_lanes_decoder(decoder_context *context)
+{
+    lanes_decoder decoder;
+    decoder.context = context;
+    decoder.nb_lanes = 0;
+    decoder.nb_iterations = 0;
+
+    int max_weight = 0;
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+        max_weight = context->columns[j].size > max_weight ? context->columns[j].size : max_weight;
+    decoder.nb_slices = 1;
+    while ((1 << decoder.nb_slices) <= max_weight)
+        decoder.nb_slices++;
+
+    decoder.syndrome = (uint64_t *)calloc(context->nb_rows, sizeof(uint64_t));
+    decoder.error = (uint64_t *)calloc(context->nb_columns, sizeof(uint64_t));
+    decoder.flips = (uint64_t *)calloc(context->nb_columns, sizeof(uint64_t));
+    decoder.weights[0] = init_bitsliced_counters(NB_LANES, context->nb_rows);
+    decoder.weights[1] = init_bitsliced_counters(NB_LANES, context->nb_rows);
+    return decoder;
+}
+
+void free_lanes_decoder(lanes_decoder decoder)
+{
+    free(decoder.syndrome);
+    free(decoder.error);
+    free(decoder.flips);
+    free_bitsliced_counters(decoder.weights[0]);
+    free_bitsliced_counters(decoder.weights[1]);
+}
+
+/**
+ * Memory used by a lanes decoder.
+ *
+ * @param decoder lanes decoder
+ * @return number of bytes allocated by init_lanes_decoder
+ */
+size_t lanes_decoder_bytes(lanes_decoder decoder)
+{
+    // syndrome, error, flips and the slices of both weights
+    size_t bytes = sizeof(uint64_t) * (decoder.context->nb_rows + 2 * decoder.context->nb_columns);
+    bytes += sizeof(uint64_t) * NB_WORDS(NB_LANES) * (decoder.weights[0].nb_slices + decoder.weights[1].nb_slices);
+    return bytes;
+}
+
+/**
+ * Load up to NB_LANES packed cyphers, the syndrome of lane l is h0 * c_l.
+ * The cyphers are transposed first, then each parity check is the XOR of the words
+ * of its support.
+ *
+ * @param decoder lanes decoder
+ * @param cyphers packed cyphers, NB_WORDS(nb_rows) words for each cypher
+ * @param nb_cyphers number of cyphers, at most NB_LANES
+ */
+void load_lanes_cyphers(lanes_decoder *decoder, uint64_t *cyphers, unsigned int nb_cyphers)
+{
+    decoder_context *context = decoder->context;
+    unsigned int nb_words = NB_WORDS(context->nb_rows);
+    decoder->nb_lanes = nb_cyphers;
+    decoder->nb_iterations = 0;
+
+    // Transposition : error is used as buffer, word i holds the bit i of every cypher
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+        decoder->error[j] = 0;
+    for (unsigned int l = 0; l < nb_cyphers; l++)
+    {
+        for (unsigned int i = 0; i < nb_words; i++)
+        {
+            for (uint64_t word = cyphers[(size_t)l * nb_words + i]; word != 0; word &= word - 1)
+                decoder->error[i * WORD_SIZE + __builtin_ctzll(word)] |= (uint64_t)1 << l;
+        }
+    }
+
+    for (unsigned int i = 0; i < context->nb_rows; i++)
+    {
+        uint64_t value = 0;
+        for (int k = 0; k < context->rows[i].size && context->rows[i].liste_indice[k] < (int)context->nb_rows; k++)
+            value ^= decoder->error[context->rows[i].liste_indice[k]];
+        decoder->syndrome[i] = value;
+    }
+
+    for (unsigned int j = 0; j < context->nb_columns; j++)
+        decoder->error[j] = 0;
+}
+
+/**
+ * Compare bit-sliced counters of every lane with a threshold.
+ *
+ * @param slices slices[b] holds the bit b of the counter of every lane
+ * @param nb_slices number of slices
+ * @param threshold value to compare with
+ * @return lanes whose counter is >= threshold
+ */
+static uint64_t greater_or_equal(uint64_t *slices, unsigned int nb_slices, unsigned int threshold)
+{
+    if (threshold >> nb_slices)
+        return 0;
+    uint64_t greater = 0;
+    uint64_t equal = ~(uint64_t)0;
+    for (int b = nb_slices - 1; b >= 0; b--)
+    {
+        uint64_t threshold_bit = -(uint64_t)((threshold >> b) & 1);
+        greater |= equal & slices[b] & ~threshold_bit;
+        equal &= ~(slices[b] ^ threshold_bit);
+    }
+    return greater | equal;
+}
+
+/**
+ * Lanes whose error has the expected weight on both halves.
+ *
+ * @param decoder lanes decoder
+ * @param weight weight of each part of the error
+ * @return lanes where fixed_threshold_bitflip would stop
+ */
+static uint64_t expected_weight_lanes(lanes_decoder *decoder, unsigned int weight)
+{
+    unsigned int n = decoder->context->nb_rows;
+    uint64_t result = ~(uint64_t)0;
+    uint64_t mask[1];
+    for (int h = 0; h < 2; h++)
+    {
+        reset_bitsliced_counters(decoder->weights[h]);
+        for (unsigned int j = h * n; j < (h + 1) * n; j++)
+        {
+            if (decoder->error[j])
+                add_bitsliced_counters(decoder->weights[h], &decoder->error[j]);
+        }
+        threshold_bitsliced_counters(decoder->weights[h], weight, mask);
+        result &= mask[0];
+        threshold_bitsliced_counters(decoder->weights[h], weight + 1, mask);
+        result &= ~mask[0];
+    }
+    return result;
+}
+
+/**
+ * Fixed threshold bit flipping on every loaded lane.
+ * A lane stops as fixed_threshold_bitflip does : null syndrome, expected weights,
+ * no position reaching the threshold, or BITFLIP_MAX_ITERATIONS iterations.
+ *
+ * @param decoder lanes decoder with loaded cyphers
+ * @param threshold minimal number of unsatisfied parity checks to flip a position
+ * @param weight weight of each part of the error
+ * @return lanes whose syndrome is null at the end (decoded)
+ */
+uint64_t bitflip_lanes(lanes_decoder *decoder, int threshold, unsigned int weight)
+{
+    decoder_context *context = decoder->context;
+    uint64_t lanes = decoder->nb_lanes == NB_LANES ? ~(uint64_t)0 : ((uint64_t)1 << decoder->nb_lanes) - 1;
+    uint64_t slices[WORD_SIZE];
+
+    while (decoder->nb_iterations < BITFLIP_MAX_ITERATIONS)
+    {
+        uint64_t active = 0;
+        for (unsigned int i = 0; i < context->nb_rows; i++)
+            active |= decoder->syndrome[i];
+        active &= lanes & ~expected_weight_lanes(decoder, weight);
+        if (active == 0)
+            break;
+
+        // Counters of every position, compared to the threshold before any flip
+        uint64_t any_flip = 0;
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+        {
+            for (unsigned int b = 0; b < decoder->nb_slices; b++)
+                slices[b] = 0;
+            polynome column = context->columns[j];
+            for (int k = 0; k < column.size; k++)
+            {
+                uint64_t carry = decoder->syndrome[column.liste_indice[k]];
+                for (unsigned int b = 0; b < decoder->nb_slices && carry != 0; b++)
+                {
+                    uint64_t next_carry = slices[b] & carry;
+                    slices[b] ^= carry;
+                    carry = next_carry;
+                }
+            }
+            decoder->flips[j] = greater_or_equal(slices, decoder->nb_slices, threshold) & active;
+            any_flip |= decoder->flips[j];
+        }
+        if (any_flip == 0)
+            break;
+
+        for (unsigned int j = 0; j < context->nb_columns; j++)
+        {
+            uint64_t flip = decoder->flips[j];
+            if (flip == 0)
+                continue;
+            decoder->error[j] ^= flip;
+            polynome column = context->columns[j];
+            for (int k = 0; k < column.size; k++)
+                decoder->syndrome[column.liste_indice[k]] ^= flip;
+        }
+        decoder->nb_iterations++;
+    }
+
+    uint64_t unsatisfied = 0;
+    for (unsigned int i = 0; i < context->nb_rows; i++)
+        unsatisfied |= decoder->syndrome[i];
+    return lanes & ~unsatisfied;
+}
+
+/**
+ * Copy the error of every lane, packed.
+ *
+ * @param decoder lanes decoder
+ * @param errors result, NB_WORDS(nb_columns) words for each lane
+ */
+void store_lanes_errors(lanes_decoder *decoder, uint64_t *errors)
+{
+    unsigned int nb_columns = decoder->context->nb_columns;
+    unsigned int nb_words = NB_WORDS(nb_columns);
+    for (unsigned int i = 0; i < decoder->nb_lanes * nb_words; i++)
+        errors[i] = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+    {
+        for (uint64_t word = decoder->error[j]; word != 0; word &= word - 1)
+            errors[(size_t)__builtin_ctzll(word) * nb_words + j / WORD_SIZE] |= (uint64_t)1 << (j % WORD_SIZE);
+    }
+}
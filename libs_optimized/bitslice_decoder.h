@@ -0,0 +1,37 @@
+#ifndef BITSLICE_DECODER_H
+#define BITSLICE_DECODER_H
+
+#include "../libs/decoder.h"
+
+#define NB_LANES WORD_SIZE
+
+/**
+ * Bit flipping decoder running on NB_LANES cyphers of the same key at once.
+ * Bit l of every word belongs to the cypher l (a lane), so each word operation
+ * updates the syndrome, the counters or the error of every lane.
+ */
+typedef struct lanes_decoder
+{
+    decoder_context *context;      /** decoder of the private key, gives the supports of H */
+    unsigned int nb_lanes;         /** number of cyphers loaded */
+    unsigned int nb_slices;        /** bits of a counter of unsatisfied parity checks */
+    uint64_t *syndrome;            /** syndrome[i] holds the parity check i of every lane */
+    uint64_t *error;               /** error[j] holds the position j of every lane */
+    uint64_t *flips;               /** lanes flipping each position in the current iteration */
+    bitsliced_counters weights[2]; /** hamming weight of each half of the error of every lane */
+    unsigned int nb_iterations;    /** iterations done by the last decoding */
+} lanes_decoder;
+
+// Creation and Destruction of the decoder
+
+lanes_decoder init_lanes_decoder(decoder_context *context);
+void free_lanes_decoder(lanes_decoder decoder);
+size_t lanes_decoder_bytes(lanes_decoder decoder);
+
+// Decoding
+
+void load_lanes_cyphers(lanes_decoder *decoder, uint64_t *cyphers, unsigned int nb_cyphers);
+uint64_t bitflip_lanes(lanes_decoder *decoder, int threshold, unsigned int weight);
+void store_lanes_errors(lanes_decoder *decoder, uint64_t *errors);
+
+#endif
\ No newline at end of file
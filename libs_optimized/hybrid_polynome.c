@@ -0,0 +1,335 @@
+#include "hybrid_polynome.h"
+#include <string.h>
+
+/**
+ * Polynomials stored as a sorted support while they are sparse and as packed words once they
+ * are dense, so that memory and time follow the weight. The public key of MDPC (about n / 2
+ * coefficients per row) is dense, the private key and the errors are sparse.
+ * Each operation is specialized for the representations of its operands :
+ * merge for sparse + sparse, XOR of words for dense + dense, scatter for sparse + dense.
+ */
+
+static int is_dense_weight(unsigned int weight, unsigned int nb_columns)
+{
+    return (size_t)weight * DENSE_WEIGHT_RATIO >= nb_columns;
+}
+
+/**
+ * words += support, by flipping the bit of each index.
+ */
+static void scatter_support(uint64_t *words, polynome support)
+{
+    for (int k = 0; k < support.size; k++)
+        words[support.liste_indice[k] / WORD_SIZE] ^= (uint64_t)1 << (support.liste_indice[k] % WORD_SIZE);
+}
+
+static unsigned int words_weight(const uint64_t *words, unsigned int nb_columns)
+{
+    unsigned int weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        weight += __builtin_popcountll(words[i]);
+    return weight;
+}
+
+/**
+ * Support of packed coefficients.
+ *
+ * @param words packed coefficients
+ * @param nb_columns number of coefficients
+ * @param weight hamming weight of words
+ * @return the sorted support, allocated with exactly weight indices
+ */
+static polynome words_support(const uint64_t *words, unsigned int nb_columns, unsigned int weight)
+{
+    polynome support;
+    support.size = weight;
+    support.liste_indice = (int *)malloc(sizeof(int) * weight);
+    int k = 0;
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+    {
+        for (uint64_t word = words[i]; word != 0; word &= word - 1)
+            support.liste_indice[k++] = i * WORD_SIZE + __builtin_ctzll(word);
+    }
+    return support;
+}
+
+/**
+ * Build a hybrid polynomial from packed coefficients, which it takes the ownership of.
+ *
+ * @param words packed coefficients, allocated with malloc, kept if dense and freed else
+ * @param nb_columns number of coefficients
+ * @return the polynomial in the representation of its weight
+ */
+static hybrid_polynome adapt_words(uint64_t *words, unsigned int nb_columns)
+{
+    hybrid_polynome polynomial;
+    polynomial.nb_columns = nb_columns;
+    polynomial.weight = words_weight(words, nb_columns);
+    polynomial.sparse.liste_indice = NULL;
+    polynomial.sparse.size = 0;
+    polynomial.words = NULL;
+    if (is_dense_weight(polynomial.weight, nb_columns))
+    {
+        polynomial.representation = DENSE_REPRESENTATION;
+        polynomial.words = words;
+    }
+    else
+    {
+        polynomial.representation = SPARSE_REPRESENTATION;
+        polynomial.sparse = words_support(words, nb_columns, polynomial.weight);
+        free(words);
+    }
+    return polynomial;
+}
+
+/**
+ * Initialize a hybrid polynomial from its support.
+ *
+ * @param support sorted support, copied
+ * @param nb_columns number of coefficients
+ * @return the polynomial in the representation of its weight
+ */
+hybrid_polynome init_hybrid_polynome(polynome support, unsigned int nb_columns)
+{
+    hybrid_polynome polynomial;
+    polynomial.nb_columns = nb_columns;
+    polynomial.weight = support.size;
+    polynomial.sparse.liste_indice = NULL;
+    polynomial.sparse.size = 0;
+    polynomial.words = NULL;
+    if (is_dense_weight(polynomial.weight, nb_columns))
+    {
+        polynomial.representation = DENSE_REPRESENTATION;
+        polynomial.words = (uint64_t *)calloc(NB_WORDS(nb_columns), sizeof(uint64_t));
+        scatter_support(polynomial.words, support);
+    }
+    else
+    {
+        polynomial.representation = SPARSE_REPRESENTATION;
+        polynomial.sparse.size = support.size;
+        polynomial.sparse.liste_indice = (int *)malloc(sizeof(int) * support.size);
+        memcpy(polynomial.sparse.liste_indice, support.liste_indice, sizeof(int) * support.size);
+    }
+    return polynomial;
+}
+
+/**
+ * Initialize a hybrid polynomial from packed coefficients.
+ *
+ * @param words packed coefficients, copied, the bits after nb_columns must be zero
+ * @param nb_columns number of coefficients
+ * @return the polynomial in the representation of its weight
+ */
+hybrid_polynome init_hybrid_polynome_from_words(const uint64_t *words, unsigned int nb_columns)
+{
+    uint64_t *copy = (uint64_t *)malloc(sizeof(uint64_t) * NB_WORDS(nb_columns));
+    memcpy(copy, words, sizeof(uint64_t) * NB_WORDS(nb_columns));
+    return adapt_words(copy, nb_columns);
+}
+
+/**
+ * Initialize a hybrid polynomial matrix from a binary matrix, each row in its own representation.
+ *
+ * @param matrix binary matrix
+ * @param nb_rows number of rows of both
+ * @param nb_columns number of columns of the binary matrix
+ * @return hybrid polynomial matrix
+ */
+hybrid_polynome *init_hybrid_polynomial_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns)
+{
+    hybrid_polynome *polynomial_matrix = (hybrid_polynome *)malloc(sizeof(hybrid_polynome) * nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+    {
+        uint64_t *words = (uint64_t *)calloc(NB_WORDS(nb_columns), sizeof(uint64_t));
+        for (unsigned int j = 0; j < nb_columns; j++)
+            words[j / WORD_SIZE] |= (uint64_t)get_matrix_bit(matrix, i, j) << (j % WORD_SIZE);
+        polynomial_matrix[i] = adapt_words(words, nb_columns);
+    }
+    return polynomial_matrix;
+}
+
+void free_hybrid_polynome(hybrid_polynome polynomial)
+{
+    free(polynomial.sparse.liste_indice);
+    free(polynomial.words);
+}
+
+void free_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix, unsigned int nb_rows)
+{
+    for (unsigned int i = 0; i < nb_rows; i++)
+        free_hybrid_polynome(polynomial_matrix[i]);
+    free(polynomial_matrix);
+}
+
+/**
+ * Memory used by a hybrid polynomial.
+ *
+ * @param polynomial polynomial
+ * @return number of bytes
+ */
+size_t hybrid_polynome_bytes(hybrid_polynome polynomial)
+{
+    if (polynomial.representation == DENSE_REPRESENTATION)
+        return sizeof(hybrid_polynome) + sizeof(uint64_t) * NB_WORDS(polynomial.nb_columns);
+    return sizeof(hybrid_polynome) + sizeof(int) * polynomial.sparse.size;
+}
+
+/**
+ * Support of a hybrid polynomial, whatever its representation.
+ *
+ * @param polynomial polynomial
+ * @return the sorted support, to free by the caller
+ */
+polynome hybrid_polynome_support(hybrid_polynome polynomial)
+{
+    if (polynomial.representation == DENSE_REPRESENTATION)
+        return words_support(polynomial.words, polynomial.nb_columns, polynomial.weight);
+    polynome support;
+    support.size = polynomial.sparse.size;
+    support.liste_indice = (int *)malloc(sizeof(int) * support.size);
+    memcpy(support.liste_indice, polynomial.sparse.liste_indice, sizeof(int) * support.size);
+    return support;
+}
+
+/**
+ * Convert a hybrid polynomial matrix to a polynomial matrix.
+ *
+ * @param polynomial_matrix hybrid polynomial matrix
+ * @param nb_rows number of rows
+ * @return the polynomial matrix, to free with free_polynomial_matrix
+ */
+polynome *hybrid_to_polynomial_matrix(hybrid_polynome *polynomial_matrix, unsigned int nb_rows)
+{
+    polynome *result = (polynome *)malloc(sizeof(polynome) * nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+        result[i] = hybrid_polynome_support(polynomial_matrix[i]);
+    return result;
+}
+
+/**
+ * accumulator += polynomial : scatter of the support if sparse, XOR of the words if dense.
+ *
+ * @param accumulator packed coefficients, NB_WORDS(nb_columns) words
+ * @param polynomial polynomial to add
+ */
+void accumulate_hybrid_polynome(uint64_t *accumulator, hybrid_polynome polynomial)
+{
+    if (polynomial.representation == DENSE_REPRESENTATION)
+    {
+        for (unsigned int i = 0; i < NB_WORDS(polynomial.nb_columns); i++)
+            accumulator[i] ^= polynomial.words[i];
+        return;
+    }
+    scatter_support(accumulator, polynomial.sparse);
+}
+
+/**
+ * Sum of two sparse polynomials, by merging their supports.
+ */
+static hybrid_polynome add_sparse_polynome(hybrid_polynome polynomial1, hybrid_polynome polynomial2)
+{
+    polynome support1 = polynomial1.sparse, support2 = polynomial2.sparse;
+    polynome sum;
+    sum.liste_indice = (int *)malloc(sizeof(int) * (support1.size + support2.size));
+    int k1 = 0, k2 = 0, size = 0;
+    while (k1 < support1.size && k2 < support2.size)
+    {
+        if (support1.liste_indice[k1] < support2.liste_indice[k2])
+            sum.liste_indice[size++] = support1.liste_indice[k1++];
+        else if (support1.liste_indice[k1] > support2.liste_indice[k2])
+            sum.liste_indice[size++] = support2.liste_indice[k2++];
+        else
+        {
+            // Same exponent in both, 1 + 1 = 0
+            k1++;
+            k2++;
+        }
+    }
+    while (k1 < support1.size)
+        sum.liste_indice[size++] = support1.liste_indice[k1++];
+    while (k2 < support2.size)
+        sum.liste_indice[size++] = support2.liste_indice[k2++];
+    sum.size = size;
+
+    hybrid_polynome result = init_hybrid_polynome(sum, polynomial1.nb_columns);
+    free(sum.liste_indice);
+    return result;
+}
+
+/**
+ * Sum of two hybrid polynomials of the same number of columns.
+ *
+ * @param polynomial1 polynomial
+ * @param polynomial2 polynomial
+ * @return the sum, in the representation of its weight
+ */
+hybrid_polynome add_hybrid_polynome(hybrid_polynome polynomial1, hybrid_polynome polynomial2)
+{
+    if (polynomial1.representation == SPARSE_REPRESENTATION && polynomial2.representation == SPARSE_REPRESENTATION)
+        return add_sparse_polynome(polynomial1, polynomial2);
+
+    // At least one is dense : copy it and add the other one (XOR or scatter)
+    if (polynomial1.representation == SPARSE_REPRESENTATION)
+    {
+        hybrid_polynome swap = polynomial1;
+        polynomial1 = polynomial2;
+        polynomial2 = swap;
+    }
+    unsigned int nb_words = NB_WORDS(polynomial1.nb_columns);
+    uint64_t *words = (uint64_t *)malloc(sizeof(uint64_t) * nb_words);
+    memcpy(words, polynomial1.words, sizeof(uint64_t) * nb_words);
+    accumulate_hybrid_polynome(words, polynomial2);
+    return adapt_words(words, polynomial1.nb_columns);
+}
+
+/**
+ * Add two hybrid polynomial matrix of the same dimensions.
+ *
+ * @param polynomial_matrix1 matrix
+ * @param polynomial_matrix2 matrix
+ * @param nb_rows number of rows of both
+ * @return the addition of both
+ */
+hybrid_polynome *add_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix1, hybrid_polynome *polynomial_matrix2, unsigned int nb_rows)
+{
+    hybrid_polynome *result = (hybrid_polynome *)malloc(sizeof(hybrid_polynome) * nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+        result[i] = add_hybrid_polynome(polynomial_matrix1[i], polynomial_matrix2[i]);
+    return result;
+}
+
+/**
+ * Multiplication of two hybrid polynomial matrix.
+ * Row i of the product is the sum of the rows k of matrix2 for k in the support of row i
+ * of matrix1, accumulated in packed words.
+ *
+ * @param polynomial_matrix1 matrix to multiply with, its number of columns is the number of rows of matrix2
+ * @param polynomial_matrix2 matrix to get multiplied
+ * @param nb_rows_polynome1 number of rows of matrix1
+ * @param nb_columns_polynome2 number of columns of matrix2
+ * @return the multiplication of both
+ */
+hybrid_polynome *multiplication_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix1, hybrid_polynome *polynomial_matrix2, unsigned int nb_rows_polynome1, unsigned int nb_columns_polynome2)
+{
+    hybrid_polynome *result = (hybrid_polynome *)malloc(sizeof(hybrid_polynome) * nb_rows_polynome1);
+    for (unsigned int i = 0; i < nb_rows_polynome1; i++)
+    {
+        uint64_t *accumulator = (uint64_t *)calloc(NB_WORDS(nb_columns_polynome2), sizeof(uint64_t));
+        hybrid_polynome line = polynomial_matrix1[i];
+        if (line.representation == DENSE_REPRESENTATION)
+        {
+            for (unsigned int w = 0; w < NB_WORDS(line.nb_columns); w++)
+            {
+                for (uint64_t word = line.words[w]; word != 0; word &= word - 1)
+                    accumulate_hybrid_polynome(accumulator, polynomial_matrix2[w * WORD_SIZE + __builtin_ctzll(word)]);
+            }
+        }
+        else
+        {
+            for (int k = 0; k < line.sparse.size; k++)
+                accumulate_hybrid_polynome(accumulator, polynomial_matrix2[line.sparse.liste_indice[k]]);
+        }
+        result[i] = adapt_words(accumulator, nb_columns_polynome2);
+    }
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef HYBRID_POLYNOME_H
+#define HYBRID_POLYNOME_H
+
+#include "bitslice.h"
+
+/**
+ * A sparse index costs 32 bits and a dense coefficient 1 bit, so a polynomial is stored dense
+ * once its weight reaches nb_columns / DENSE_WEIGHT_RATIO.
+ */
+#define DENSE_WEIGHT_RATIO 32
+
+/**
+ * Representation of a hybrid polynomial
+ */
+typedef enum
+{
+    SPARSE_REPRESENTATION, /** sorted support */
+    DENSE_REPRESENTATION   /** packed coefficients */
+} polynome_representation;
+
+/**
+ * Binary polynomial (a row of a polynomial matrix) stored sparse or dense depending on its weight.
+ */
+typedef struct
+{
+    polynome_representation representation; /** representation chosen from the weight */
+    polynome sparse;                        /** support, SPARSE_REPRESENTATION only */
+    uint64_t *words;                        /** NB_WORDS(nb_columns) words, DENSE_REPRESENTATION only */
+    unsigned int nb_columns;                /** number of coefficients */
+    unsigned int weight;                    /** hamming weight */
+} hybrid_polynome;
+
+// Creation and Destruction of hybrid polynomials
+
+hybrid_polynome init_hybrid_polynome(polynome support, unsigned int nb_columns);
+hybrid_polynome init_hybrid_polynome_from_words(const uint64_t *words, unsigned int nb_columns);
+hybrid_polynome *init_hybrid_polynomial_matrix(bit **matrix, unsigned int nb_rows, unsigned int nb_columns);
+void free_hybrid_polynome(hybrid_polynome polynomial);
+void free_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix, unsigned int nb_rows);
+size_t hybrid_polynome_bytes(hybrid_polynome polynomial);
+polynome hybrid_polynome_support(hybrid_polynome polynomial);
+polynome *hybrid_to_polynomial_matrix(hybrid_polynome *polynomial_matrix, unsigned int nb_rows);
+
+// Operations on hybrid polynomials
+
+void accumulate_hybrid_polynome(uint64_t *accumulator, hybrid_polynome polynomial);
+hybrid_polynome add_hybrid_polynome(hybrid_polynome polynomial1, hybrid_polynome polynomial2);
+hybrid_polynome *add_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix1, hybrid_polynome *polynomial_matrix2, unsigned int nb_rows);
+hybrid_polynome *multiplication_hybrid_polynomial_matrix(hybrid_polynome *polynomial_matrix1, hybrid_polynome *polynomial_matrix2, unsigned int nb_rows_polynome1, unsigned int nb_columns_polynome2);
+
+#endif
\ No newline at end of file
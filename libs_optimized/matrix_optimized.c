@@ -1,11 +1,35 @@
 #include "matrix_optimized.h"
+#include "packed_backends.h"
 
 /**
  * All the functions are serving the same purpose as in matrix.c
  * The twist is that we are using binary operation on unsigned int to have a binary matrix.
  * It helps speeding up the algorithm.
+ * The rows are the rows of the packed32 backend : the inversion and the multiplication are
+ * those of matrix_backend.c on these rows.
  */
 
+// The rows of a binary_matrix as a matrix of the packed32 backend, without copy
+static backend_matrix packed32_matrix(binary_matrix matrix)
+{
+    backend_matrix wrapped;
+    wrapped.backend = &packed32_backend;
+    wrapped.rows = (void **)matrix.array;
+    wrapped.nb_rows = matrix.line_size;
+    wrapped.nb_columns = matrix.column_size;
+    return wrapped;
+}
+
+// The rows of a matrix of the packed32 backend as a binary_matrix, freed by free_optimized_matrix
+static binary_matrix optimized_matrix_from_backend(backend_matrix matrix)
+{
+    binary_matrix result;
+    result.array = (unsigned int **)matrix.rows;
+    result.line_size = matrix.nb_rows;
+    result.column_size = matrix.nb_columns;
+    return result;
+}
+
 binary_matrix init_optimized_matrix(unsigned int nb_rows, unsigned int nb_columns)
 {
     binary_matrix matrix;
@@ -77,11 +101,12 @@ binary_matrix copy_optimized_matrix(binary_matrix matrix)
 {
     unsigned int nb_rows = matrix.line_size;
     unsigned int nb_columns = matrix.column_size;
+    unsigned int nb_memory_columns = ceil((float)nb_columns / INT_SIZE);
     binary_matrix cp_matrix = init_optimized_matrix(nb_rows, nb_columns);
 
     for (unsigned int i = 0; i < nb_rows; i++)
     {
-        for (unsigned int j = 0; j < nb_columns; j++)
+        for (unsigned int j = 0; j < nb_memory_columns; j++)
         {
             cp_matrix.array[i][j] = matrix.array[i][j];
         }
@@ -89,23 +114,16 @@ binary_matrix copy_optimized_matrix(binary_matrix matrix)
     return cp_matrix;
 }
 
-void target_weight_optimized_matrix(binary_matrix matrix, unsigned int weight)
+/**
+ * Randomize the matrix to a given hamming weight, as target_weight_matrix on the packed32 rows.
+ *
+ * @param generator random generator
+ * @param matrix matrix to fill
+ * @param weight hamming weight, at most line_size * column_size
+ */
+void target_weight_optimized_matrix(drbg *generator, binary_matrix matrix, unsigned int weight)
 {
-    unsigned int nb_rows = matrix.line_size;
-    unsigned int nb_columns = matrix.column_size;
-    unsigned int index = 0;
-    unsigned int i, j;
-    assert(weight < nb_rows * nb_columns);
-    while (index < weight)
-    {
-        i = rand() % nb_rows;
-        j = rand() % nb_columns;
-        if (((matrix.array[i][j / INT_SIZE] >> (j % INT_SIZE)) & 1) == 0)
-        {
-            matrix.array[i][j / INT_SIZE] ^= (1 << (j % INT_SIZE));
-            index++;
-        }
-    }
+    target_weight_backend_matrix(generator, packed32_matrix(matrix), weight);
 }
 
 void randomize_optimized_matrix(binary_matrix matrix)
@@ -121,47 +139,21 @@ void randomize_optimized_matrix(binary_matrix matrix)
     }
 }
 
-binary_matrix optimized_sample_random(binary_matrix matrix, int sample_size)
+/**
+ * Columns of a matrix drawn without replacement, sample_backend_columns on the packed32 rows.
+ * The columns are drawn by the constant time sampler and kept in increasing order.
+ *
+ * @param generator random generator
+ * @param matrix matrix to sample
+ * @param sample_size number of columns, at most column_size
+ * @return the sampled columns (line_size x sample_size)
+ */
+binary_matrix optimized_sample_random(drbg *generator, binary_matrix matrix, int sample_size)
 {
-    unsigned int nb_rows = matrix.line_size;
-    unsigned int nb_columns = matrix.column_size;
-    unsigned int nb_memory_columns = ceil((float)matrix.column_size / INT_SIZE);
-
-    int *not_already_picked_index = (int *)malloc(sizeof(int) * nb_columns);
-    for (int i = 0; i < nb_columns; i++)
-        not_already_picked_index[i] = i;
-
-    binary_matrix result = init_optimized_matrix(nb_rows, sample_size);
-
-    int count = 0;
-    int indice;
-    while (count != sample_size)
-    {
-        indice = rand() % matrix.column_size;
-        if (not_already_picked_index[indice] == -1)
-            continue;
-        else
-        {
-            not_already_picked_index[indice] = -1;
-            for (int i = 0; i < nb_rows; i++)
-            {
-                unsigned int columns_index_original = indice / INT_SIZE;
-                unsigned int index_column = count / INT_SIZE;
-                unsigned int index_line = i / INT_SIZE;
-
-                unsigned int right_shift_value = ((min(INT_SIZE, nb_columns - columns_index_original * INT_SIZE)) - 1 - indice % INT_SIZE);
-                unsigned int left_shift_value = ((min(INT_SIZE, sample_size - index_column * INT_SIZE)) - 1 - count % INT_SIZE);
-                unsigned int value = ((matrix.array[i][columns_index_original] >> right_shift_value) & 1);
-
-                value = value << left_shift_value;
-                result.array[i][index_column] |= value;
-            }
-            count++;
-        }
-    }
-
-    free(not_already_picked_index);
-    return result;
+    int *columns = (int *)malloc(sizeof(int) * sample_size);
+    binary_matrix sample = optimized_matrix_from_backend(sample_backend_columns(generator, packed32_matrix(matrix), sample_size, columns));
+    free(columns);
+    return sample;
 }
 
 void add_optimized_matrix(binary_matrix matrix1, binary_matrix matrix2, unsigned int start)
@@ -250,7 +242,7 @@ binary_matrix concatenation_optimized_matrix(binary_matrix matrix1, binary_matri
         }
         else
         {
-            for (unsigned int j = 0; j < nb_columns2; j++)
+            for (unsigned int j = 0; j < ceil((float)nb_columns2 / INT_SIZE); j++)
             {
                 concatenated_matrix.array[i][started_index + j] = matrix2.array[i][j];
             }
@@ -261,103 +253,12 @@ binary_matrix concatenation_optimized_matrix(binary_matrix matrix1, binary_matri
 
 binary_matrix inversion_optimized_matrix(binary_matrix m, int *result)
 {
-    unsigned int nb_rows = m.line_size;
-    unsigned int nb_columns = m.column_size;
-    unsigned int nb_memory_columns = ceil((float)nb_columns / INT_SIZE);
-
-    binary_matrix matrix = copy_optimized_matrix(m);
-    binary_matrix inverted_matrix = create_optimized_identity_matrix(nb_columns);
-    for (int i = 0; i < nb_columns; i++)
-    {
-        int maxi = i;
-        int index_column = i / INT_SIZE;
-
-        for (int k = i; k < nb_rows; k++)
-        {
-            if (((matrix.array[k][index_column] >> min(INT_SIZE, nb_columns - index_column * INT_SIZE) - i % INT_SIZE - 1) & 1) != 0)
-            {
-                maxi = k;
-            }
-        }
-
-        if (((matrix.array[maxi][index_column] >> min(INT_SIZE, nb_columns - index_column * INT_SIZE) - i % INT_SIZE - 1) & 1) != 0)
-        {
-            optimized_swap_lines(matrix, i, maxi);
-            optimized_swap_lines(inverted_matrix, i, maxi);
-            for (int u = i + 1; u < nb_columns; u++)
-            {
-                if (((matrix.array[u][index_column] >> min(INT_SIZE, nb_columns - index_column * INT_SIZE) - i % INT_SIZE - 1) & 1) != 0)
-                {
-                    optimized_add_line(matrix.array[u], matrix.array[i], nb_columns);
-                    optimized_add_line((inverted_matrix).array[u], (inverted_matrix).array[i], nb_columns);
-                }
-            }
-        }
-        else
-        {
-            // More than one solution exists
-            free_optimized_matrix(matrix);
-            *(result) = 0;
-            return inverted_matrix;
-        }
-    }
-
-    int is_inversible;
-    if (is_inversible = optimized_matrix_is_upper(matrix))
-    {
-        int current_column = nb_columns - 1;
-        int index = 0;
-        while (current_column != 0)
-        {
-            int column_index = current_column / INT_SIZE;
-            for (int i = current_column - 1; i >= 0; i--)
-            {
-                if (((matrix.array[i][column_index] >> index % INT_SIZE) & 1) == 1)
-                {
-                    optimized_add_line(matrix.array[i], matrix.array[current_column], nb_columns);
-                    optimized_add_line((inverted_matrix).array[i], (inverted_matrix).array[current_column], nb_columns);
-                }
-            }
-            if ((current_column) % INT_SIZE == 0)
-                index = 0;
-            else
-                index++;
-            current_column--;
-        }
-    }
-
-    free_optimized_matrix(matrix);
-    *(result) = is_inversible;
-    return inverted_matrix;
+    return optimized_matrix_from_backend(inversion_backend_matrix(packed32_matrix(m), result));
 }
 
 binary_matrix multiply_optimized_matrix(binary_matrix matrix1, binary_matrix matrix2)
 {
-    unsigned int nb_rows_1 = matrix1.line_size;
-    unsigned int nb_rows_2 = matrix1.line_size;
-    unsigned int nb_columns_1 = matrix1.column_size;
-    unsigned int nb_columns_2 = matrix2.column_size;
-    unsigned int nb_memory_columns_1 = ceil((float)nb_columns_1 / INT_SIZE);
-    unsigned int nb_memory_columns_2 = ceil((float)nb_columns_2 / INT_SIZE);
-
-    binary_matrix result_matrix = init_optimized_matrix(nb_rows_1, nb_columns_2);
-    for (int i = 0; i < nb_rows_1; i++)
-    {
-        for (int j = 0; j < nb_columns_2; j++)
-        {
-            int true_column_m2 = j / INT_SIZE;
-            unsigned int value = 0;
-            for (int k = 0; k < nb_columns_1; k++)
-            {
-                int true_column_m1 = k / INT_SIZE;
-                unsigned int first_value = ((matrix1.array[i][true_column_m1] >> min(INT_SIZE, nb_columns_1 - true_column_m1 * INT_SIZE) - k % INT_SIZE - 1) & 1);
-                unsigned int second_value = ((matrix2.array[k][true_column_m2] >> min(INT_SIZE, nb_columns_2 - true_column_m2 * INT_SIZE) - j % INT_SIZE - 1) & 1);
-                value ^= first_value & second_value;
-            }
-            result_matrix.array[i][j / INT_SIZE] ^= (value << min(INT_SIZE, nb_columns_2 - true_column_m2 * INT_SIZE) - j % INT_SIZE - 1);
-        }
-    }
-    return result_matrix;
+    return optimized_matrix_from_backend(multiply_backend_matrix(packed32_matrix(matrix1), packed32_matrix(matrix2)));
 }
 
 int optimized_matrix_is_upper(binary_matrix matrix)
@@ -546,6 +447,7 @@ void test_optimized_print_matrix()
 
 void test_hamming_weight()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     binary_matrix test_matrix_print = init_optimized_matrix(2, 3);
     test_matrix_print.array[0][0] = 3;
     test_matrix_print.array[1][0] = 1;
@@ -557,7 +459,7 @@ void test_hamming_weight()
     test_matrix_weight.array[3][0] = 255;
 
     binary_matrix test_matrix_target = init_optimized_matrix(200, 400);
-    target_weight_optimized_matrix(test_matrix_target, 125);
+    target_weight_optimized_matrix(&generator, test_matrix_target, 125);
 
     printf("----------@RUNNING TEST : hamming_weight | target_weight----------\n");
     // Should be 3
@@ -612,10 +514,11 @@ void test_concatenation_matrix()
 
 /*void test_shift_line()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     printf("----------@RUNNING TEST : shift_line----------\n");
     int binary_size_test_matrix_shift = 250;
     binary_matrix test_matrix_shift = init_optimized_matrix(2, binary_size_test_matrix_shift);
-    target_weight_optimized_matrix(test_matrix_shift, binary_size_test_matrix_shift);
+    target_weight_optimized_matrix(&generator, test_matrix_shift, binary_size_test_matrix_shift);
     optimized_print_matrix(test_matrix_shift);
     printf("Shift > 64\n");
     int *line = optimized_shift_line(test_matrix_shift.array[0], test_matrix_shift.column_size, 65);
@@ -635,9 +538,10 @@ void test_identity_matrix()
 
 void test_transpose_matrix()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     printf("----------@RUNNING TEST : Transpose----------\n");
     binary_matrix test_matrix_transpose = init_optimized_matrix(36, 40);
-    target_weight_optimized_matrix(test_matrix_transpose, 600);
+    target_weight_optimized_matrix(&generator, test_matrix_transpose, 600);
     optimized_print_matrix(test_matrix_transpose);
     binary_matrix transpose_result_test = transpose_optimized_matrix(test_matrix_transpose);
     optimized_print_matrix(transpose_result_test);
@@ -647,13 +551,14 @@ void test_transpose_matrix()
 
 void test_multiplication_matrix()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     printf("----------@RUNNING TEST : multiplication----------\n");
     binary_matrix test_matrix_multiplication = init_optimized_matrix(39, 36);
-    target_weight_optimized_matrix(test_matrix_multiplication, 600);
+    target_weight_optimized_matrix(&generator, test_matrix_multiplication, 600);
     printf("Matrix 1 :\n");
     optimized_print_matrix(test_matrix_multiplication);
     binary_matrix test_matrix_multiplication2 = init_optimized_matrix(36, 5);
-    target_weight_optimized_matrix(test_matrix_multiplication2, 100);
+    target_weight_optimized_matrix(&generator, test_matrix_multiplication2, 100);
     printf("Matrix 2 :\n");
     optimized_print_matrix(test_matrix_multiplication2);
     binary_matrix multipliee = multiply_optimized_matrix(test_matrix_multiplication, test_matrix_multiplication2);
@@ -667,6 +572,7 @@ void test_multiplication_matrix()
 
 void test_inversion_matrix()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     printf("----------@RUNNING TEST : Inversion----------\n");
     int *inversion_found = malloc(sizeof(int));
     *(inversion_found) = 0;
@@ -677,7 +583,7 @@ void test_inversion_matrix()
     {
         matrix_inversible = init_optimized_matrix(40, 40);
 
-        target_weight_optimized_matrix(matrix_inversible, 600);
+        target_weight_optimized_matrix(&generator, matrix_inversible, 600);
 
         inverted_matrix = inversion_optimized_matrix(matrix_inversible, inversion_found);
     }
@@ -694,11 +600,12 @@ void test_inversion_matrix()
 
 void test_sample_random()
 {
+    drbg generator = init_drbg(time(NULL), 0);
     printf("----------@RUNNING TEST : sample_random----------\n");
     binary_matrix test_matrix_sample_random = init_optimized_matrix(20, 40);
-    target_weight_optimized_matrix(test_matrix_sample_random, 400);
+    target_weight_optimized_matrix(&generator, test_matrix_sample_random, 400);
     optimized_print_matrix(test_matrix_sample_random);
-    binary_matrix sample_random_result_test = optimized_sample_random(test_matrix_sample_random, 20);
+    binary_matrix sample_random_result_test = optimized_sample_random(&generator, test_matrix_sample_random, 20);
     optimized_print_matrix(sample_random_result_test);
     free_optimized_matrix(test_matrix_sample_random);
     free_optimized_matrix(sample_random_result_test);
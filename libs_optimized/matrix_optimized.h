@@ -6,6 +6,7 @@
 #include <assert.h>
 #include <time.h>
 #include "math.h"
+#include "../libs/drbg.h"
 
 #define INT_SIZE (sizeof(unsigned int) * 8)
 #define INT_MAX 4294967295
@@ -33,9 +34,9 @@ void optimized_print_matrix(binary_matrix matrix);
 // Operations on binary Matrix
 
 binary_matrix copy_optimized_matrix(binary_matrix matrix);
-void target_weight_optimized_matrix(binary_matrix matrix, unsigned int weight);
+void target_weight_optimized_matrix(drbg *generator, binary_matrix matrix, unsigned int weight);
 void randomize_optimized_matrix(binary_matrix matrix);
-binary_matrix optimized_sample_random(binary_matrix matrix, int sample_size);
+binary_matrix optimized_sample_random(drbg *generator, binary_matrix matrix, int sample_size);
 
 void add_optimized_matrix(binary_matrix matrix1, binary_matrix matrix2, unsigned int start);
 binary_matrix transpose_optimized_matrix(binary_matrix matrix);
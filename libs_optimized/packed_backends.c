@@ -0,0 +1,277 @@
+#include "packed_backends.h"
+
+// Vector of SIMD_WORDS words, the compiler uses the widest registers of the target
+typedef uint64_t simd_vector __attribute__((vector_size(SIMD_WORDS * sizeof(uint64_t))));
+
+// Packed 32 bit backend : the rows of binary_matrix
+
+static unsigned int packed32_nb_words(unsigned int nb_columns)
+{
+    return (nb_columns + INT_SIZE - 1) / INT_SIZE;
+}
+
+// Bits are stored from the most significant one, the last word being right aligned
+static unsigned int packed32_shift(unsigned int nb_columns, unsigned int j)
+{
+    return min(INT_SIZE, nb_columns - j / INT_SIZE * INT_SIZE) - 1 - j % INT_SIZE;
+}
+
+static void *packed32_init_row(unsigned int nb_columns)
+{
+    return calloc(packed32_nb_words(nb_columns), sizeof(unsigned int));
+}
+
+static void packed_free_row(void *row)
+{
+    free(row);
+}
+
+static unsigned int packed32_get_bit(const void *row, unsigned int nb_columns, unsigned int j)
+{
+    return (((const unsigned int *)row)[j / INT_SIZE] >> packed32_shift(nb_columns, j)) & 1;
+}
+
+static void packed32_set_bit(void *row, unsigned int nb_columns, unsigned int j, unsigned int value)
+{
+    unsigned int *word = (unsigned int *)row + j / INT_SIZE;
+    unsigned int shift = packed32_shift(nb_columns, j);
+    *word = (*word & ~(1u << shift)) | ((value & 1) << shift);
+}
+
+static void packed32_add_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    optimized_add_line((unsigned int *)row1, (unsigned int *)row2, nb_columns);
+}
+
+static void packed32_copy_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    memcpy(row1, row2, sizeof(unsigned int) * packed32_nb_words(nb_columns));
+}
+
+static unsigned int packed32_row_weight(const void *row, unsigned int nb_columns)
+{
+    unsigned int weight = 0;
+    for (unsigned int w = 0; w < packed32_nb_words(nb_columns); w++)
+        weight += __builtin_popcount(((const unsigned int *)row)[w]);
+    return weight;
+}
+
+static void packed32_row_support(const void *row, unsigned int nb_columns, int *support)
+{
+    unsigned int size = 0;
+    for (unsigned int w = 0; w < packed32_nb_words(nb_columns); w++)
+    {
+        unsigned int width = min(INT_SIZE, nb_columns - w * INT_SIZE);
+        // The most significant bit is the first column of the word
+        for (unsigned int word = ((const unsigned int *)row)[w]; word != 0;)
+        {
+            unsigned int shift = INT_SIZE - 1 - __builtin_clz(word);
+            support[size++] = w * INT_SIZE + width - 1 - shift;
+            word ^= 1u << shift;
+        }
+    }
+}
+
+static void packed32_pack_row(const void *row, unsigned int nb_columns, uint64_t *words)
+{
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        words[i] = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+        words[j / WORD_SIZE] |= (uint64_t)packed32_get_bit(row, nb_columns, j) << (j % WORD_SIZE);
+}
+
+static void packed32_unpack_row(void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    unsigned int *line = (unsigned int *)row;
+    for (unsigned int w = 0; w < packed32_nb_words(nb_columns); w++)
+        line[w] = 0;
+    for (unsigned int j = 0; j < nb_columns; j++)
+        line[j / INT_SIZE] |= (unsigned int)((words[j / WORD_SIZE] >> (j % WORD_SIZE)) & 1) << packed32_shift(nb_columns, j);
+}
+
+// Bits of a word in the reverse order, the columns of a packed32 word are from the most significant bit
+static unsigned int packed32_reverse(unsigned int word)
+{
+    word = ((word >> 1) & 0x55555555u) | ((word & 0x55555555u) << 1);
+    word = ((word >> 2) & 0x33333333u) | ((word & 0x33333333u) << 2);
+    word = ((word >> 4) & 0x0F0F0F0Fu) | ((word & 0x0F0F0F0Fu) << 4);
+    return __builtin_bswap32(word);
+}
+
+static unsigned int packed32_row_dot(const void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    unsigned int parity = 0;
+    for (unsigned int w = 0; w < packed32_nb_words(nb_columns); w++)
+    {
+        // Columns w * INT_SIZE to w * INT_SIZE + width - 1 of the words, put in the order of the row
+        unsigned int width = min(INT_SIZE, nb_columns - w * INT_SIZE);
+        unsigned int bits = (unsigned int)(words[w * INT_SIZE / WORD_SIZE] >> (w * INT_SIZE % WORD_SIZE));
+        parity ^= ((const unsigned int *)row)[w] & (packed32_reverse(bits) >> (INT_SIZE - width));
+    }
+    return __builtin_parity(parity);
+}
+
+static void packed32_gather_column(void *const *rows, unsigned int nb_rows, unsigned int nb_columns, unsigned int j, uint64_t *words)
+{
+    unsigned int shift = packed32_shift(nb_columns, j);
+    for (unsigned int i = 0; i < NB_WORDS(nb_rows); i++)
+        words[i] = 0;
+    for (unsigned int i = 0; i < nb_rows; i++)
+        words[i / WORD_SIZE] |= (uint64_t)((((const unsigned int *)rows[i])[j / INT_SIZE] >> shift) & 1) << (i % WORD_SIZE);
+}
+
+const matrix_backend packed32_backend = {
+    "packed32",
+    packed32_init_row,
+    packed_free_row,
+    packed32_get_bit,
+    packed32_set_bit,
+    packed32_add_row,
+    packed32_copy_row,
+    packed32_row_weight,
+    packed32_row_support,
+    packed32_pack_row,
+    packed32_unpack_row,
+    packed32_row_dot,
+    packed32_gather_column,
+};
+
+// Packed 64 bit backend : the rows are already in the exchange format
+
+static void *packed64_init_row(unsigned int nb_columns)
+{
+    return calloc(NB_WORDS(nb_columns), sizeof(uint64_t));
+}
+
+static unsigned int packed64_get_bit(const void *row, unsigned int nb_columns, unsigned int j)
+{
+    (void)nb_columns;
+    return (((const uint64_t *)row)[j / WORD_SIZE] >> (j % WORD_SIZE)) & 1;
+}
+
+static void packed64_set_bit(void *row, unsigned int nb_columns, unsigned int j, unsigned int value)
+{
+    (void)nb_columns;
+    uint64_t *word = (uint64_t *)row + j / WORD_SIZE;
+    *word = (*word & ~((uint64_t)1 << (j % WORD_SIZE))) | ((uint64_t)(value & 1) << (j % WORD_SIZE));
+}
+
+static void packed64_add_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        ((uint64_t *)row1)[i] ^= ((const uint64_t *)row2)[i];
+}
+
+static void packed64_copy_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    memcpy(row1, row2, sizeof(uint64_t) * NB_WORDS(nb_columns));
+}
+
+static unsigned int packed64_row_weight(const void *row, unsigned int nb_columns)
+{
+    unsigned int weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        weight += __builtin_popcountll(((const uint64_t *)row)[i]);
+    return weight;
+}
+
+static void packed64_row_support(const void *row, unsigned int nb_columns, int *support)
+{
+    unsigned int size = 0;
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+    {
+        for (uint64_t word = ((const uint64_t *)row)[i]; word != 0; word &= word - 1)
+            support[size++] = i * WORD_SIZE + __builtin_ctzll(word);
+    }
+}
+
+static void packed64_pack_row(const void *row, unsigned int nb_columns, uint64_t *words)
+{
+    memcpy(words, row, sizeof(uint64_t) * NB_WORDS(nb_columns));
+}
+
+// The bits after nb_columns are cleared, the weight counts whole words
+static void packed64_unpack_row(void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    memcpy(row, words, sizeof(uint64_t) * NB_WORDS(nb_columns));
+    if (nb_columns % WORD_SIZE != 0)
+        ((uint64_t *)row)[nb_columns / WORD_SIZE] &= ((uint64_t)1 << (nb_columns % WORD_SIZE)) - 1;
+}
+
+static unsigned int packed64_row_dot(const void *row, unsigned int nb_columns, const uint64_t *words)
+{
+    uint64_t parity = 0;
+    for (unsigned int i = 0; i < NB_WORDS(nb_columns); i++)
+        parity ^= ((const uint64_t *)row)[i] & words[i];
+    return __builtin_parityll(parity);
+}
+
+static void packed64_gather_column(void *const *rows, unsigned int nb_rows, unsigned int nb_columns, unsigned int j, uint64_t *words)
+{
+    (void)nb_columns;
+    for (unsigned int i = 0; i < NB_WORDS(nb_rows); i++)
+        words[i] = 0;
+    for (unsigned int i = 0; i < nb_rows; i++)
+        words[i / WORD_SIZE] |= ((((const uint64_t *)rows[i])[j / WORD_SIZE] >> (j % WORD_SIZE)) & 1) << (i % WORD_SIZE);
+}
+
+const matrix_backend packed64_backend = {
+    "packed64",
+    packed64_init_row,
+    packed_free_row,
+    packed64_get_bit,
+    packed64_set_bit,
+    packed64_add_row,
+    packed64_copy_row,
+    packed64_row_weight,
+    packed64_row_support,
+    packed64_pack_row,
+    packed64_unpack_row,
+    packed64_row_dot,
+    packed64_gather_column,
+};
+
+// SIMD backend : rows of packed64 padded to whole vectors, the padding stays null
+
+static unsigned int simd_nb_vectors(unsigned int nb_columns)
+{
+    return (NB_WORDS(nb_columns) + SIMD_WORDS - 1) / SIMD_WORDS;
+}
+
+static void *simd_init_row(unsigned int nb_columns)
+{
+    size_t size = sizeof(simd_vector) * simd_nb_vectors(nb_columns);
+    // aligned_alloc needs a non null size
+    void *row = aligned_alloc(sizeof(simd_vector), size > 0 ? size : sizeof(simd_vector));
+    memset(row, 0, size);
+    return row;
+}
+
+static void simd_add_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    simd_vector *vectors1 = (simd_vector *)row1;
+    const simd_vector *vectors2 = (const simd_vector *)row2;
+    for (unsigned int i = 0; i < simd_nb_vectors(nb_columns); i++)
+        vectors1[i] ^= vectors2[i];
+}
+
+static void simd_copy_row(void *row1, const void *row2, unsigned int nb_columns)
+{
+    memcpy(row1, row2, sizeof(simd_vector) * simd_nb_vectors(nb_columns));
+}
+
+const matrix_backend simd_backend = {
+    "simd",
+    simd_init_row,
+    packed_free_row,
+    packed64_get_bit,
+    packed64_set_bit,
+    simd_add_row,
+    simd_copy_row,
+    packed64_row_weight,
+    packed64_row_support,
+    packed64_pack_row,
+    packed64_unpack_row,
+    packed64_row_dot,
+    packed64_gather_column,
+};
@@ -0,0 +1,21 @@
+#ifndef PACKED_BACKENDS_H
+#define PACKED_BACKENDS_H
+
+#include "../libs/matrix_backend.h"
+#include "matrix_optimized.h"
+
+/**
+ * Backends storing the rows in machine words :
+ * - packed32 : unsigned int words in the layout of binary_matrix (first bit in the most significant one),
+ * - packed64 : uint64_t words in the layout of ring.h (bit j in bit j % WORD_SIZE of word j / WORD_SIZE),
+ * - simd : the layout of packed64 padded to SIMD_WORDS words, the rows are added by vectors.
+ */
+
+// Words added by one vector operation of the simd backend (256 bits)
+#define SIMD_WORDS 4
+
+extern const matrix_backend packed32_backend;
+extern const matrix_backend packed64_backend;
+extern const matrix_backend simd_backend;
+
+#endif
\ No newline at end of file
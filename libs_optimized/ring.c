@@ -0,0 +1,318 @@
+#include "ring.h"
+
+/**
+ * Copy of a polynomial followed by the same shifted by n : for i < 2 n, bit i of doubled is the
+ * coefficient i % n, so the n bits starting at any offset up to n are a rotation of the polynomial.
+ *
+ * @param a packed polynomial
+ * @param n size of the ring
+ * @param doubled result, DOUBLED_WORDS(n) words
+ */
+static inline __attribute__((always_inline)) void double_ring(const uint64_t *a, unsigned int n, uint64_t *doubled)
+{
+    unsigned int words = n / WORD_SIZE;
+    unsigned int bits = n % WORD_SIZE;
+    for (unsigned int i = 0; i < DOUBLED_WORDS(n); i++)
+        doubled[i] = 0;
+    for (unsigned int i = 0; i < NB_WORDS(n); i++)
+    {
+        doubled[i] |= a[i];
+        doubled[i + words] |= a[i] << bits;
+        doubled[i + words + 1] |= (a[i] >> 1) >> (WORD_SIZE - 1 - bits);
+    }
+}
+
+/**
+ * Copy (or add if is_added) the nb_words words of doubled starting at bit offset in result.
+ * The shift is the same for every word, so the loop is vectorized.
+ */
+static inline __attribute__((always_inline)) void window_ring(const uint64_t *doubled, unsigned int offset, unsigned int nb_words, uint64_t *result, int is_added)
+{
+    const uint64_t *source = doubled + offset / WORD_SIZE;
+    unsigned int bits = offset % WORD_SIZE;
+    for (unsigned int i = 0; i < nb_words; i++)
+    {
+        // Two shifts, a shift by WORD_SIZE is undefined
+        uint64_t word = (source[i] >> bits) | ((source[i + 1] << 1) << (WORD_SIZE - 1 - bits));
+        result[i] = is_added ? result[i] ^ word : word;
+    }
+}
+
+/**
+ * Clear the bits after the coefficient n - 1.
+ */
+static inline __attribute__((always_inline)) void mask_ring(uint64_t *a, unsigned int n)
+{
+    if (n % WORD_SIZE)
+        a[NB_WORDS(n) - 1] &= ((uint64_t)1 << (n % WORD_SIZE)) - 1;
+}
+
+/**
+ * result = a * X^shift : the words of result are windows of the doubled polynomial.
+ * The kernels get their buffer doubled of DOUBLED_WORDS(n) words from the caller.
+ */
+static inline __attribute__((always_inline)) void rotate_ring_kernel(const uint64_t *a, unsigned int shift, unsigned int n, uint64_t *result, uint64_t *doubled)
+{
+    double_ring(a, n, doubled);
+    // Coefficient j of result is the coefficient j - shift of a, bit j + n - shift of doubled
+    window_ring(doubled, n - shift % n, NB_WORDS(n), result, 0);
+    mask_ring(result, n);
+}
+
+/**
+ * result[j] = a * X^j for every j < n, each rotation in NB_WORDS(n) words.
+ */
+static inline __attribute__((always_inline)) void rotations_ring_kernel(const uint64_t *a, unsigned int n, uint64_t *result, uint64_t *doubled)
+{
+    double_ring(a, n, doubled);
+    for (unsigned int j = 0; j < n; j++)
+    {
+        uint64_t *rotation = result + (size_t)j * NB_WORDS(n);
+        window_ring(doubled, n - j, NB_WORDS(n), rotation, 0);
+        mask_ring(rotation, n);
+    }
+}
+
+/**
+ * result = a * b, the sum of the rotations of a by each index of b.
+ */
+static inline __attribute__((always_inline)) void multiply_sparse_ring_kernel(const uint64_t *a, polynome b, unsigned int n, uint64_t *result, uint64_t *doubled)
+{
+    double_ring(a, n, doubled);
+    for (unsigned int i = 0; i < NB_WORDS(n); i++)
+        result[i] = 0;
+    for (int k = 0; k < b.size; k++)
+        window_ring(doubled, n - b.liste_indice[k], NB_WORDS(n), result, 1);
+    mask_ring(result, n);
+}
+
+/**
+ * Degree of a packed polynomial.
+ *
+ * @param p packed polynomial
+ * @param from index of the highest word which can be non zero
+ * @return the degree, -1 for the null polynomial
+ */
+static int degree(const uint64_t *p, int from)
+{
+    for (int i = from; i >= 0; i--)
+    {
+        if (p[i])
+            return i * WORD_SIZE + 63 - __builtin_clzll(p[i]);
+    }
+    return -1;
+}
+
+/**
+ * destination += source * X^shift, the bits after nb_words words are dropped.
+ */
+static inline __attribute__((always_inline)) void add_shifted(uint64_t *destination, const uint64_t *source, unsigned int shift, unsigned int nb_words)
+{
+    unsigned int words = shift / WORD_SIZE;
+    unsigned int bits = shift % WORD_SIZE;
+    for (int i = nb_words - 1; i >= (int)words; i--)
+    {
+        uint64_t value = source[i - words] << bits;
+        if (bits && i - (int)words - 1 >= 0)
+            value |= source[i - words - 1] >> (WORD_SIZE - bits);
+        destination[i] ^= value;
+    }
+}
+
+/**
+ * Inverse of a packed polynomial modulo X^n - 1, by the extended Euclidean algorithm.
+ */
+static inline __attribute__((always_inline)) int inverse_ring_kernel(const uint64_t *a, unsigned int n, uint64_t *result)
+{
+    // X^n - 1 has n + 1 coefficients
+    unsigned int nb_words = NB_WORDS(n + 1);
+    uint64_t *u = (uint64_t *)calloc(nb_words, sizeof(uint64_t));
+    uint64_t *v = (uint64_t *)calloc(nb_words, sizeof(uint64_t));
+    uint64_t *g1 = (uint64_t *)calloc(nb_words, sizeof(uint64_t));
+    uint64_t *g2 = (uint64_t *)calloc(nb_words, sizeof(uint64_t));
+    for (unsigned int i = 0; i < NB_WORDS(n); i++)
+        u[i] = a[i];
+    v[0] = 1;
+    v[n / WORD_SIZE] |= (uint64_t)1 << (n % WORD_SIZE);
+    g1[0] = 1;
+
+    // Invariant : g1 * a = u and g2 * a = v modulo X^n - 1
+    int degree_u = degree(u, nb_words - 1);
+    int degree_v = n;
+    while (degree_u > 0)
+    {
+        int gap = degree_u - degree_v;
+        if (gap < 0)
+        {
+            uint64_t *swap = u;
+            u = v;
+            v = swap;
+            swap = g1;
+            g1 = g2;
+            g2 = swap;
+            int swap_degree = degree_u;
+            degree_u = degree_v;
+            degree_v = swap_degree;
+            gap = -gap;
+        }
+        add_shifted(u, v, gap, nb_words);
+        add_shifted(g1, g2, gap, nb_words);
+        degree_u = degree(u, degree_u / WORD_SIZE);
+    }
+
+    int invertible = degree_u == 0;
+    for (unsigned int i = 0; i < NB_WORDS(n); i++)
+        result[i] = g1[i];
+    // g1 can have the coefficient n, X^n = 1
+    if ((g1[n / WORD_SIZE] >> (n % WORD_SIZE)) & 1)
+    {
+        result[0] ^= 1;
+        if (n % WORD_SIZE)
+            result[n / WORD_SIZE] &= ((uint64_t)1 << (n % WORD_SIZE)) - 1;
+    }
+
+    free(u);
+    free(v);
+    free(g1);
+    free(g2);
+    return invertible;
+}
+
+// One copy of each kernel per size of parameter_sets.h, where n and the buffers sizes are constants
+
+#define RING_SPECIALIZATION(identifier, name, size, w, t)                                          \
+    static void rotate_ring_##identifier(const uint64_t *a, unsigned int shift, uint64_t *result)  \
+    {                                                                                              \
+        uint64_t doubled[DOUBLED_WORDS(size)];                                                     \
+        rotate_ring_kernel(a, shift, size, result, doubled);                                       \
+    }                                                                                              \
+    static void rotations_ring_##identifier(const uint64_t *a, uint64_t *result)                   \
+    {                                                                                              \
+        uint64_t doubled[DOUBLED_WORDS(size)];                                                     \
+        rotations_ring_kernel(a, size, result, doubled);                                           \
+    }                                                                                              \
+    static void multiply_sparse_ring_##identifier(const uint64_t *a, polynome b, uint64_t *result) \
+    {                                                                                              \
+        uint64_t doubled[DOUBLED_WORDS(size)];                                                     \
+        multiply_sparse_ring_kernel(a, b, size, result, doubled);                                  \
+    }                                                                                              \
+    static int inverse_ring_##identifier(const uint64_t *a, uint64_t *result)                      \
+    {                                                                                              \
+        return inverse_ring_kernel(a, size, result);                                               \
+    }
+
+PARAMETER_SETS(RING_SPECIALIZATION)
+
+/**
+ * Rotation of a packed polynomial : result = a * X^shift.
+ *
+ * @param a packed polynomial
+ * @param shift exponent of the monomial
+ * @param n size of the ring
+ * @param result packed rotation, must not be a
+ */
+void rotate_ring(const uint64_t *a, unsigned int shift, unsigned int n, uint64_t *result)
+{
+#define RING_CASE(identifier, name, size, w, t)     \
+    if (n == size)                                  \
+    {                                               \
+        rotate_ring_##identifier(a, shift, result); \
+        return;                                     \
+    }
+    PARAMETER_SETS(RING_CASE)
+#undef RING_CASE
+    uint64_t *doubled = (uint64_t *)malloc(sizeof(uint64_t) * DOUBLED_WORDS(n));
+    rotate_ring_kernel(a, shift, n, result, doubled);
+    free(doubled);
+}
+
+/**
+ * Doubled copy of a packed polynomial, to compute many of its rotations with rotate_doubled_ring.
+ *
+ * @param a packed polynomial
+ * @param n size of the ring
+ * @param doubled result, DOUBLED_WORDS(n) words
+ */
+void init_doubled_ring(const uint64_t *a, unsigned int n, uint64_t *doubled)
+{
+    double_ring(a, n, doubled);
+}
+
+/**
+ * Rotation of a polynomial from its doubled copy : result = a * X^shift, one window of doubled.
+ *
+ * @param doubled doubled copy of a (init_doubled_ring)
+ * @param shift exponent of the monomial
+ * @param n size of the ring
+ * @param result packed rotation, NB_WORDS(n) words
+ */
+void rotate_doubled_ring(const uint64_t *doubled, unsigned int shift, unsigned int n, uint64_t *result)
+{
+    window_ring(doubled, n - shift % n, NB_WORDS(n), result, 0);
+    mask_ring(result, n);
+}
+
+/**
+ * Every rotation of a packed polynomial, the columns of a circulant matrix.
+ *
+ * @param a packed polynomial
+ * @param n size of the ring
+ * @param result n x NB_WORDS(n) words, rotation j = a * X^j starts at word j * NB_WORDS(n)
+ */
+void rotations_ring(const uint64_t *a, unsigned int n, uint64_t *result)
+{
+#define RING_CASE(identifier, name, size, w, t) \
+    if (n == size)                              \
+    {                                           \
+        rotations_ring_##identifier(a, result); \
+        return;                                 \
+    }
+    PARAMETER_SETS(RING_CASE)
+#undef RING_CASE
+    uint64_t *doubled = (uint64_t *)malloc(sizeof(uint64_t) * DOUBLED_WORDS(n));
+    rotations_ring_kernel(a, n, result, doubled);
+    free(doubled);
+}
+
+/**
+ * Product of a packed polynomial by a sparse one : the XOR of a rotated by each index of b.
+ *
+ * @param a packed polynomial
+ * @param b support of the sparse polynomial, indices < n
+ * @param n size of the ring
+ * @param result packed product, must not be a
+ */
+void multiply_sparse_ring(const uint64_t *a, polynome b, unsigned int n, uint64_t *result)
+{
+#define RING_CASE(identifier, name, size, w, t)         \
+    if (n == size)                                      \
+    {                                                   \
+        multiply_sparse_ring_##identifier(a, b, result); \
+        return;                                         \
+    }
+    PARAMETER_SETS(RING_CASE)
+#undef RING_CASE
+    uint64_t *doubled = (uint64_t *)malloc(sizeof(uint64_t) * DOUBLED_WORDS(n));
+    multiply_sparse_ring_kernel(a, b, n, result, doubled);
+    free(doubled);
+}
+
+/**
+ * Inverse of a packed polynomial modulo X^n - 1.
+ * For a prime n where 2 is primitive (the MDPC and BIKE sizes), the polynomials of odd weight
+ * are invertible.
+ *
+ * @param a packed polynomial to invert
+ * @param n size of the ring
+ * @param result packed inverse
+ * @return 1 if a is invertible, 0 else (result is then undefined)
+ */
+int inverse_ring(const uint64_t *a, unsigned int n, uint64_t *result)
+{
+#define RING_CASE(identifier, name, size, w, t) \
+    if (n == size)                              \
+        return inverse_ring_##identifier(a, result);
+    PARAMETER_SETS(RING_CASE)
+#undef RING_CASE
+    return inverse_ring_kernel(a, n, result);
+}
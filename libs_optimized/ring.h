@@ -0,0 +1,28 @@
+#ifndef RING_H
+#define RING_H
+
+#include "bitslice.h"
+#include "../libs/parameter_sets.h"
+
+/**
+ * Binary polynomials modulo X^n - 1, packed in NB_WORDS(n) words :
+ * coefficient j is bit j % WORD_SIZE of word j / WORD_SIZE, the bits after n are zero.
+ * Each function has a copy for every size of parameter_sets.h, chosen at runtime from n.
+ */
+
+// Words of a polynomial followed by its copy shifted by n, with one more word for the last window
+#define DOUBLED_WORDS(n) (NB_WORDS(2 * (n)) + 1)
+
+// Operations in GF(2)[X] / (X^n - 1)
+
+void rotate_ring(const uint64_t *a, unsigned int shift, unsigned int n, uint64_t *result);
+void rotations_ring(const uint64_t *a, unsigned int n, uint64_t *result);
+void multiply_sparse_ring(const uint64_t *a, polynome b, unsigned int n, uint64_t *result);
+int inverse_ring(const uint64_t *a, unsigned int n, uint64_t *result);
+
+// Rotations from a doubled copy in a buffer of the caller
+
+void init_doubled_ring(const uint64_t *a, unsigned int n, uint64_t *doubled);
+void rotate_doubled_ring(const uint64_t *doubled, unsigned int shift, unsigned int n, uint64_t *result);
+
+#endif
\ No newline at end of file
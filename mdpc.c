@@ -17,16 +17,15 @@ void print_hash(uint8 *buff)
 /**
  * Generation of the hash
  *
- * @param matrix matrix used for the hash
- * @param nb_rows rows of the matrix
+ * @param vector line matrix (1 x n) used for the hash
  * @return hash of the matrix
  */
-void hash(bit **matrix, unsigned int nb_rows)
+void hash(backend_matrix vector)
 {
-    char *my_hash = (char *)malloc(sizeof(char) * nb_rows);
-    for (int i = 0; i < nb_rows; i++)
+    char *my_hash = (char *)malloc(sizeof(char) * vector.nb_columns);
+    for (unsigned int j = 0; j < vector.nb_columns; j++)
     {
-        my_hash[i] = matrix[i][0].value;
+        my_hash[j] = get_backend_bit(vector, 0, j);
     }
     uint8 buff[MD5_HASH_BYTES];
     calcul_md5(my_hash, MD5_HASH_BYTES, buff);
@@ -36,163 +35,91 @@ void hash(bit **matrix, unsigned int nb_rows)
 }
 
 /**
- * Generation of the private key
- * @param h0 first part of the private key
- * @param h1 second part of the private key
- * @param nb_rows number of rows of the private key
- * @param nb_columns number of columns of the private key
+ * Check that a packed error found by decapsulation is (e0 | e1).
  *
+ * @param error packed error, NB_WORDS(2 * n) words
+ * @param e0 support of the first part of the error
+ * @param e1 support of the second part of the error
+ * @param n size of each part
+ * @return 1 if the error is (e0 | e1), 0 else
  */
-void privkey_generation(bit **h0, bit **h1, unsigned int nb_rows, unsigned int nb_columns, unsigned int weight, clock_t *start, clock_t *end)
+static int is_packed_error(uint64_t *error, polynome e0, polynome e1, unsigned int n)
 {
-    *start = clock();
-    bit **first_line_h0 = init_matrix(1, nb_columns);
-    bit **first_line_h1 = init_matrix(1, nb_columns);
-    // Create the first line of each matrix that will be used for the permutation
-    target_weight_matrix(first_line_h0, 1, nb_columns, weight);
-    target_weight_matrix(first_line_h1, 1, nb_columns, weight);
-
-    unsigned int random_shift = rand() % nb_columns;
-    // Permutation of each line using the initialisation
-    for (int i = 0; i < nb_rows; i++)
+    int weight = 0;
+    for (unsigned int i = 0; i < NB_WORDS(2 * n); i++)
+        weight += __builtin_popcountll(error[i]);
+    if (weight != e0.size + e1.size)
+        return 0;
+    for (int k = 0; k < e0.size + e1.size; k++)
     {
-        shift_line(h0[i], first_line_h0[0], nb_columns, (i + 1) * random_shift);
-        shift_line(h1[i], first_line_h1[0], nb_columns, (i + 1) * random_shift);
+        unsigned int position = k < e0.size ? (unsigned int)e0.liste_indice[k] : n + e1.liste_indice[k - e0.size];
+        if (!((error[position / WORD_SIZE] >> (position % WORD_SIZE)) & 1))
+            return 0;
     }
-
-    *end = clock();
-    free_matrix(first_line_h0, 1);
-    free_matrix(first_line_h1, 1);
+    return 1;
 }
 
 /**
- * Generate public key from the private key
+ * Encapsulate then decapsulate a batch of random errors with the same keys.
+ * The public key is expanded and the decoder is built once for the whole batch.
  *
- * @param h0 the first part of the private key
- * @param h1 the second part of the private key
- * @param nb_rows number of rows of the private key
- * @param nb_columns number of columns of the private key
- * @return the multiplication of both (a polynomial matrix)
+ * @param pubkey public key
+ * @param context decoder of the private key
+ * @param n size of matrix
+ * @param e total weight of the error
+ * @param T treshold for flipped bits
+ * @param decoder decoder used by Alice
+ * @param batch_size number of messages
+ * @param generator random generator
  */
-polynome *pubkey_generation(bit **h0, bit **h1, unsigned int nb_rows, unsigned int nb_columns, clock_t *start, clock_t *end)
+void mdpc_batch(polynome *pubkey, decoder_context *context, unsigned int n, unsigned int e, unsigned int T, decoder_type decoder, unsigned int batch_size, drbg *generator)
 {
-    *start = clock();
-    bit **inversion_h0 = inversion_matrix(h0, nb_rows, nb_columns);
-    // Switching h0^-1 and h1 to polynome for the multiplication
-    polynome *polynome_matrix_A = init_polynomial_matrix(inversion_h0, nb_rows, nb_columns);
-    polynome *polynome_matrix_B = init_polynomial_matrix(h1, nb_rows, nb_columns);
-    // Private key
-    polynome *h = multiplication_polynomial_matrix(polynome_matrix_A, polynome_matrix_B, nb_rows, nb_columns);
-
-    *end = clock();
-    free_matrix(inversion_h0, nb_rows);
-    free_polynomial_matrix(polynome_matrix_A, nb_rows);
-    free_polynomial_matrix(polynome_matrix_B, nb_rows);
-
-    return h;
-}
-
-// https://eprint.iacr.org/2019/1423.pdf
-int bitflip(int n, bit **e0, bit **e1, bit **h0, bit **h1, bit **c, int T, int t, bit **e0_output, bit **e1_output)
-{
-    // Initialisation of all parameters needed
-    bit **s = multiply_matrix(h0, c, n, n, n, 1);
-
-    bit **u = init_matrix(1, n);
-    bit **v = init_matrix(1, n);
-
-    bit **transpose_h0 = transpose_matrix(h0, n, n);
-    bit **transpose_h1 = transpose_matrix(h1, n, n);
-    bit **H = concatenation_matrix(rotation_matrix(transpose_h0, n, n, 1, RIGHT), rotation_matrix(transpose_h1, n, n, 1, RIGHT), n, n, n, n);
-    bit **syndrome = copy_matrix(s, n, 1);
-    bit **flipped_positions;
-    int **sum;
+    uint64_t start, end;
+    expanded_public_key key = expand_public_key(pubkey, n);
 
-    while ((hamming_weight(u, 1, n) != t || hamming_weight(v, 1, n) != t) && (hamming_weight(syndrome, n, 1) != 0))
+    polynome *e0 = (polynome *)malloc(sizeof(polynome) * batch_size);
+    polynome *e1 = (polynome *)malloc(sizeof(polynome) * batch_size);
+    for (unsigned int m = 0; m < batch_size; m++)
     {
-        sum = multiply_non_binary_matrix(transpose_matrix(syndrome, n, 1), H, 1, n, n, 2 * n);
-
-        flipped_positions = init_matrix(1, 2 * n);
-        for (int j = 0; j < 2 * n; j++)
-        {
-            if (sum[0][j] >= T)
-            {
-                flipped_positions[0][j].value = 1;
-            }
-        }
-        printf("|u|| : %d ||v|| : %d  ||syndrome|| : %d  \n", hamming_weight(u, 1, n), hamming_weight(v, 1, n), hamming_weight(syndrome, n, 1));
-        // XOR between flipped positions and <u,v>
-        add_matrix(u, flipped_positions, 1, n, 0);
-        add_matrix(v, flipped_positions, 1, n, n);
-        // New value of syndrome based on flipped position
-        add_matrix(syndrome, multiply_matrix(H, transpose_matrix(flipped_positions, 1, 2 * n), n, 2 * n, 2 * n, 1), n, 1, 0);
+        e0[m].size = e / 2;
+        e1[m].size = e / 2;
+        e0[m].liste_indice = (int *)malloc(sizeof(int) * e0[m].size);
+        e1[m].liste_indice = (int *)malloc(sizeof(int) * e1[m].size);
+        sample_support(generator, e0[m].liste_indice, e0[m].size, n);
+        sample_support(generator, e1[m].liste_indice, e1[m].size, n);
     }
-    // Verification that result is correct
-    bit **matrix_to_sub = multiply_matrix(H, transpose_matrix(concatenation_matrix(u, v, 1, n, 1, n), 1, 2 * n), n, 2 * n, 2 * n, 1);
-    add_matrix(matrix_to_sub, s, n, 1, 0);
+    uint64_t *cyphers = (uint64_t *)malloc(sizeof(uint64_t) * batch_size * key.nb_words);
+    uint64_t *errors = (uint64_t *)malloc(sizeof(uint64_t) * batch_size * NB_WORDS(2 * n));
+    int *decoded = (int *)malloc(sizeof(int) * batch_size);
 
-    int matrix_null = !is_matrix_null(matrix_to_sub, n, 1);
-    // Store the result in e0_output and e1_output if result is correct
-    if (matrix_null)
-    {
-        e0_output = NULL;
-        e1_output = NULL;
-    }
-    else
-    {
-        e0_output = transpose_matrix(u, 1, n);
-        e1_output = transpose_matrix(v, 1, n);
-    }
+    // Bob
+    start = monotonic_ns();
+    encapsulate_batch(key, e0, e1, batch_size, cyphers);
+    end = monotonic_ns();
+    printf("Time for cypher of %u messages : %.3f ms (%.1f us per message)\n", batch_size, (end - start) / 1e6, (end - start) / 1e3 / batch_size);
 
-    free_matrix(transpose_h0, n);
-    free_matrix(transpose_h1, n);
-    free_matrix(syndrome, n);
-    free_matrix(H, n);
-    free_matrix(u, n);
-    free_matrix(v, n);
-    return matrix_null;
-}
+    // Alice
+    start = monotonic_ns();
+    decapsulate_batch(context, decoder, cyphers, batch_size, T, e / 2, errors, decoded);
+    end = monotonic_ns();
+    printf("Time for decoding of %u messages : %.3f ms (%.1f us per message)\n", batch_size, (end - start) / 1e6, (end - start) / 1e3 / batch_size);
 
-/**
- * Cypher the error generated by the public key
- * @param e0 first error generated
- * @param e1 first error generated
- * @param h0 first part of private key
- * @param h1 first part of second key
- * @param pubkey public key
- * @param n size of matrix
- * @param e weight of the error
- *
- * @return the cypher matrix
- */
+    unsigned int nb_found = 0;
+    for (unsigned int m = 0; m < batch_size; m++)
+        nb_found += decoded[m] && is_packed_error(errors + (size_t)m * NB_WORDS(2 * n), e0[m], e1[m], n);
+    printf("Alice a decode %u messages sur %u\n", nb_found, batch_size);
 
-bit **cypher(bit **e0, bit **e1, bit **h0, bit **h1, polynome *pubkey, int n, int e, clock_t *start, clock_t *end)
-{
-    *start = clock();
-    // Creating the two errors of weight w = e/2
-    target_weight_matrix(e0, n, 1, e / 2);
-    target_weight_matrix(e1, n, 1, e / 2);
-
-    // Changing matrix to polynome
-    polynome *polynome_e0 = init_polynomial_matrix(e0, n, 1);
-    polynome *polynome_e1 = init_polynomial_matrix(e1, n, 1);
-    polynome *polynome_h0 = init_polynomial_matrix(h0, n, n);
-    polynome *polynome_h1 = init_polynomial_matrix(h1, n, n);
-
-    // Creating the cypher matrix
-    polynome *tmp = multiplication_polynomial_matrix(pubkey, polynome_e1, n, 1);
-    polynome *c1 = add_polymonial_matrix(polynome_e0, tmp, n, 1, 0);
-    bit **c = conversion_polynome_to_binary(c1, n, 1);
-    *end = clock();
-
-    hash(e0, n);
-    hash(e1, n);
-
-    free_polynomial_matrix(polynome_e0, 1);
-    free_polynomial_matrix(polynome_e1, 1);
-    free_polynomial_matrix(polynome_h0, n);
-    free_polynomial_matrix(polynome_h1, n);
-    return c;
+    for (unsigned int m = 0; m < batch_size; m++)
+    {
+        free(e0[m].liste_indice);
+        free(e1[m].liste_indice);
+    }
+    free(e0);
+    free(e1);
+    free(cyphers);
+    free(errors);
+    free(decoded);
+    free_expanded_public_key(key);
 }
 
 /**
@@ -201,40 +128,67 @@ bit **cypher(bit **e0, bit **e1, bit **h0, bit **h1, polynome *pubkey, int n, in
  * @param n size of matrix
  * @param e total weight of the error
  * @param T treshold for flipped bits
+ * @param decoder decoder used by Alice
+ * @param batch_size number of messages of the batch run after the single message, 0 for none
+ * @param backend storage of the matrices
+ * @param profiler profiler of the phases, NULL if not profiled
+ * @param counters hardware counters, NULL if not measured
  * 
 */
 
-void mdpc(unsigned int w, unsigned int n, unsigned int e, unsigned int T)
+void mdpc(unsigned int w, unsigned int n, unsigned int e, unsigned int T, decoder_type decoder, unsigned int batch_size, const matrix_backend *backend, phase_profiler *profiler, perf_counters *counters)
 {
-    clock_t start, end;
+    uint64_t duration;
     // Alice
-    bit **h0 = init_matrix(n, n);
-    bit **h1 = init_matrix(n, n);
+    backend_matrix h0 = init_backend_matrix(backend, n, n);
+    backend_matrix h1 = init_backend_matrix(backend, n, n);
 
     // Generation of keys
-    privkey_generation(h0, h1, n, n, w, &start, &end);
-    printf("Time for generating private key : %ld ms \n", (end - start) / 1000);
-    polynome *pubkey = pubkey_generation(h0, h1, n, n, &start, &end);
-    printf("Time for generating public key : %ld ms \n", (end - start) / 1000);
+    drbg generator = init_drbg(time(NULL), 0);
+    privkey_generation(h0, h1, w, &generator, profiler, &duration);
+    printf("Time for generating private key : %.3f ms \n", duration / 1e6);
+    polynome *pubkey = pubkey_generation(h0, h1, profiler, counters, &duration);
+    printf("Time for generating public key : %.3f ms \n", duration / 1e6);
+    if (pubkey == NULL)
+    {
+        printf("h0 is not invertible\n");
+        free_backend_matrix(h0);
+        free_backend_matrix(h1);
+        return;
+    }
+    // Decoder built once for the private key
+    decoder_context context = init_decoder_context_from_matrices(h0, h1, e);
+    context.profiler = profiler;
+    context.perf = counters;
 
-    bit **e0 = init_matrix(n, 1);
-    bit **e1 = init_matrix(n, 1);
+    backend_matrix e0 = init_backend_matrix(backend, 1, n);
+    backend_matrix e1 = init_backend_matrix(backend, 1, n);
     // Bob
-    bit **c = cypher(e0, e1, h0, h1, pubkey, n, e, &start, &end);
-    printf("Time for cypher  : %ld ms \n", (end - start) / 1000);
+    backend_matrix c = cypher(e0, e1, pubkey, e, &generator, profiler, &duration);
+    hash(e0);
+    hash(e1);
+    printf("Time for cypher  : %.3f ms \n", duration / 1e6);
 
-    bit **e0_alice;
-    bit **e1_alice;
+    backend_matrix e0_alice = init_backend_matrix(backend, 1, n);
+    backend_matrix e1_alice = init_backend_matrix(backend, 1, n);
 
-    if (bitflip(n, e0, e1, h0, h1, c, T, w, e0_alice, e1_alice))
+    if (decode_matrix_cypher(&context, decoder, c, T, e / 2, e0_alice, e1_alice))
     {
         printf("Alice a reussi a decode e0 et e1\n");
     }
+    printf("Decoding iterations : %u\n", context.nb_iterations);
 
-    free_matrix(h0, n);
-    free_matrix(h1, n);
-    free_matrix(e0, 1);
-    free_matrix(e1, 1);
+    if (batch_size > 0)
+        mdpc_batch(pubkey, &context, n, e, T, decoder, batch_size, &generator);
+
+    free_backend_matrix(h0);
+    free_backend_matrix(h1);
+    free_backend_matrix(e0);
+    free_backend_matrix(e1);
+    free_backend_matrix(e0_alice);
+    free_backend_matrix(e1_alice);
+    free_backend_matrix(c);
+    free_decoder_context(context);
 
     free_polynomial_matrix(pubkey, n);
 }
@@ -242,10 +196,50 @@ void mdpc(unsigned int w, unsigned int n, unsigned int e, unsigned int T)
 int main(int argc, char **argv)
 {
     srand(time(NULL));
-    int w = 39;
-    int n = 4813;
-    int e = 78;
+    // Sizes of the test set of parameter_sets.h, whose ring kernels are specialized
+    const parameter_set *set = find_parameter_set("test");
+    int w = set->w;
+    int n = set->n;
+    int e = set->t;
     int T = 26;
-    printf("Launch of MPDC for w = %d, n = %d, e = %d, T = %d\n", w, n, e, T);
-    mdpc(w, n, e, T);
+    decoder_type decoder = argc > 1 ? parse_decoder(argv[1]) : DECODER_BITFLIP;
+    unsigned int batch_size = argc > 2 ? atoi(argv[2]) : 0;
+    // Phases and hardware counters written in JSON if files are given
+    const char *profile_name = argc > 3 ? argv[3] : NULL;
+    const char *perf_name = argc > 4 ? argv[4] : NULL;
+    const matrix_backend *backend = argc > 5 ? parse_matrix_backend(argv[5]) : default_matrix_backend();
+    phase_profiler *profiler = profile_name != NULL ? init_profiler() : NULL;
+    perf_counters *counters = perf_name != NULL ? init_perf_counters() : NULL;
+    if (counters != NULL && nb_perf_events_available(counters) == 0)
+        fprintf(stderr, "Hardware counters not available (perf_event_open refused)\n");
+    printf("Launch of MPDC for w = %d, n = %d, e = %d, T = %d on the %s backend\n", w, n, e, T, backend->name);
+    mdpc(w, n, e, T, decoder, batch_size, backend, profiler, counters);
+
+    if (profile_name != NULL)
+    {
+        FILE *output = fopen(profile_name, "w");
+        if (output == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", profile_name);
+            return 1;
+        }
+        write_profiler_report(profiler, output);
+        fclose(output);
+        printf("Profile written in %s\n", profile_name);
+        free_profiler(profiler);
+    }
+    if (perf_name != NULL)
+    {
+        FILE *output = fopen(perf_name, "w");
+        if (output == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", perf_name);
+            return 1;
+        }
+        write_perf_report(counters, output);
+        fclose(output);
+        printf("Hardware counters written in %s\n", perf_name);
+        free_perf_counters(counters);
+    }
+    return 0;
 }